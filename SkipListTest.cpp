@@ -0,0 +1,1342 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "SkipListTest.h"
+#include "concurrent_skiplist.h"
+#include "lazy_skiplist.h"
+#include "unrolled_skiplist.h"
+#include "skiplist.h"
+#include "ThreadPool.h"
+#include "logMod.h"
+
+namespace {
+
+//  记录一条检查结果，失败时输出原因
+bool check(bool condition, const std::string &message)
+{
+    if (!condition)
+    {
+        LOG_ERROR << "Check failed: " << message;
+        std::cerr << "Error: Check failed: " << message << std::endl;
+    }
+    return condition;
+}
+
+//  输出一项测试的结论，与 test_load_save_interface 的格式一致
+bool report(const std::string &name, bool passed)
+{
+    if (passed)
+    {
+        LOG_INFO << "Test PASSED: " << name;
+        std::cout << "Test PASSED: " << name << "\n";
+    }
+    else
+    {
+        LOG_ERROR << "Test FAILED: " << name;
+        std::cout << "Test FAILED: " << name << "\n";
+    }
+    return passed;
+}
+
+//  为一项测试准备空的临时目录
+std::filesystem::path fresh_directory(const std::string &name)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "kvengine_skiplist_test" / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+//  翻转文件中 offset 处(从文件尾倒数时为负)的一个字节
+bool flip_byte(const std::string &file_name, long long offset)
+{
+    std::fstream file(file_name, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    long long size = static_cast<long long>(file.tellg());
+    long long position = offset < 0 ? size + offset : offset;
+    if (position < 0 || position >= size)
+    {
+        return false;
+    }
+    char byte;
+    file.seekg(position);
+    file.read(&byte, 1);
+    byte = static_cast<char>(byte ^ 0x5a);
+    file.seekp(position);
+    file.write(&byte, 1);
+    return static_cast<bool>(file);
+}
+
+//  从文件尾截掉 bytes 个字节
+bool truncate_tail(const std::string &file_name, uintmax_t bytes)
+{
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(file_name, error);
+    if (error || size < bytes)
+    {
+        return false;
+    }
+    std::filesystem::resize_file(file_name, size - bytes, error);
+    return !error;
+}
+
+//  对源跳表做一轮随机修改：插入、修改、删除与区间删除
+void mutate(SkipList<int, std::string> &list, std::mt19937 &rng)
+{
+    for (int i = 0; i < 500; i++)
+    {
+        int key = static_cast<int>(rng() % 6000);
+        switch (rng() % 4)
+        {
+            case 0:
+                list.insert_element(key, "inserted-" + std::to_string(rng()));
+                break;
+            case 1:
+                list.update_element(key, "updated-" + std::to_string(rng()));
+                break;
+            case 2:
+                list.delete_element(key);
+                break;
+            default:
+                list.delete_range(key, key + static_cast<int>(rng() % 20));
+                break;
+        }
+    }
+}
+
+//  按文件名列出 directory 中以 prefix 开头的文件
+std::vector<std::string> files_with_prefix(const std::string &directory, const std::string &prefix)
+{
+    std::vector<std::string> files;
+    for (auto &entry : std::filesystem::directory_iterator(directory))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) == 0)
+        {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+template<typename Features>
+using TestSkipList = SkipList<int, std::string, MutexLock, DefaultNodeAllocator, std::less<>, std::hash<int>, Features>;
+
+//  比较跳表与参照 map 的全部内容
+template<typename Features>
+bool matches_map(TestSkipList<Features> &list, const std::map<int, std::string> &expected, std::mt19937 &rng)
+{
+    bool ok = check(list.size() == static_cast<int>(expected.size()), "size matches std::map");
+
+    auto it = expected.begin();
+    bool same = true;
+    for (auto node = list.begin(); node != list.end(); ++node, ++it)
+    {
+        if (it == expected.end() || node->get_key() != it->first || node->get_value() != it->second)
+        {
+            same = false;
+            break;
+        }
+    }
+    ok = check(same && it == expected.end(), "iteration visits the std::map contents in order") && ok;
+
+    for (int round = 0; round < 20; round++)
+    {
+        int lo = static_cast<int>(rng() % 2200) - 100;
+        int hi = lo + static_cast<int>(rng() % 300);
+
+        auto expected_lower = expected.lower_bound(lo);
+        auto lower = list.lower_bound(lo);
+        ok = check(expected_lower == expected.end() ? lower == list.end()
+                                                    : lower != list.end() && lower->get_key() == expected_lower->first,
+                   "lower_bound(" + std::to_string(lo) + ")") && ok;
+
+        std::vector<std::pair<int, std::string>> visited;
+        int count = list.range(lo, hi, [&](const int &key, const std::string &value) { visited.emplace_back(key, value); });
+        std::vector<std::pair<int, std::string>> wanted(expected_lower, expected.lower_bound(std::max(lo, hi)));
+        ok = check(count == static_cast<int>(wanted.size()) && visited == wanted,
+                   "range(" + std::to_string(lo) + ", " + std::to_string(hi) + ")") && ok;
+
+        size_t limit = rng() % 40;
+        std::vector<std::pair<int, std::string>> page = list.scan(lo, limit);
+        std::vector<std::pair<int, std::string>> wanted_page;
+        for (auto p = expected_lower; p != expected.end() && wanted_page.size() < limit; ++p)
+        {
+            wanted_page.emplace_back(*p);
+        }
+        ok = check(page == wanted_page, "scan(" + std::to_string(lo) + ", " + std::to_string(limit) + ")") && ok;
+
+        if constexpr (Features::kRank)
+        {
+            int rank = static_cast<int>(std::distance(expected.begin(), expected_lower));
+            ok = check(list.rank(lo) == rank, "rank(" + std::to_string(lo) + ")") && ok;
+            ok = check(list.count_range(lo, hi) == static_cast<int>(wanted.size()),
+                       "count_range(" + std::to_string(lo) + ", " + std::to_string(hi) + ")") && ok;
+            if (!expected.empty())
+            {
+                int index = static_cast<int>(rng() % expected.size());
+                auto selected = list.select(index);
+                ok = check(selected != list.end() && selected->get_key() == std::next(expected.begin(), index)->first,
+                           "select(" + std::to_string(index) + ")") && ok;
+
+                double p = static_cast<double>(rng() % 101) / 100.0;
+                int target = std::max(static_cast<int>(std::ceil(p * expected.size())), 1) - 1;
+                auto at = list.percentile(p);
+                ok = check(at != list.end() && at->get_key() == std::next(expected.begin(), target)->first,
+                           "percentile(" + std::to_string(p) + ")") && ok;
+            }
+        }
+    }
+    return ok;
+}
+
+//  对一种跳表执行随机操作序列，每 500 次操作与 std::map 比较一次
+template<typename Features>
+bool differential_run(unsigned seed)
+{
+    std::mt19937 rng(seed);
+    TestSkipList<Features> list(12);
+    std::map<int, std::string> expected;
+    bool ok = true;
+
+    for (int step = 1; step <= 10000; step++)
+    {
+        int key = static_cast<int>(rng() % 2000);
+        std::string value = "value-" + std::to_string(rng()) + std::string(rng() % 24, 'v');
+        switch (rng() % 12)
+        {
+            case 0: case 1: case 2: case 3:
+                ok = check(list.insert_element(key, value) == (expected.count(key) ? 1 : 0), "insert_element result") && ok;
+                expected.emplace(key, value);
+                break;
+            case 4: case 5:
+                ok = check(list.update_element(key, value) == (expected.count(key) > 0), "update_element result") && ok;
+                if (expected.count(key))
+                {
+                    expected[key] = value;
+                }
+                break;
+            case 6:
+                list.delete_element(key);
+                expected.erase(key);
+                break;
+            case 7:
+            {
+                int hi = key + static_cast<int>(rng() % 80);
+                auto first = expected.lower_bound(key);
+                auto last = expected.lower_bound(hi);
+                int removed = static_cast<int>(std::distance(first, last));
+                expected.erase(first, last);
+                ok = check(list.delete_range(key, hi) == removed, "delete_range result") && ok;
+                break;
+            }
+            case 8:
+            {
+                std::vector<std::pair<int, std::string>> batch;
+                for (int i = 0; i < 16; i++)
+                {
+                    batch.emplace_back(static_cast<int>(rng() % 2000), value);
+                }
+                list.insert_batch(batch.begin(), batch.end());
+                for (auto &entry : batch)
+                {
+                    expected.emplace(entry);
+                }
+                break;
+            }
+            default:
+            {
+                auto found = expected.find(key);
+                std::string *actual = list.search_element_value(key);
+                ok = check(list.search_element(key) == (found != expected.end()), "search_element result") && ok;
+                ok = check(found == expected.end() ? actual == nullptr : actual != nullptr && *actual == found->second,
+                           "search_element_value(" + std::to_string(key) + ")") && ok;
+                break;
+            }
+        }
+
+        if (step % 500 == 0)
+        {
+            ok = matches_map(list, expected, rng) && ok;
+        }
+        if (!ok)
+        {
+            LOG_ERROR << "Differential run diverged at step " << step << " with seed " << seed;
+            return false;
+        }
+    }
+
+    list.clear();
+    expected.clear();
+    return matches_map(list, expected, rng) && ok;
+}
+
+//  对并发跳表(ConcurrentSkipList、LazySkipList)单线程执行随机操作序列，逐次与 std::map 比较；
+//  中途清空一次，清空后层级回到 0，之后的查找从新的当前层级开始
+template<typename List>
+bool concurrent_list_run(unsigned seed)
+{
+    std::mt19937 rng(seed);
+    List list(12);
+    std::map<int, std::string> expected;
+    bool ok = true;
+
+    for (int step = 1; step <= 50000; step++)
+    {
+        int key = static_cast<int>(rng() % 1024);
+        std::string value = "value-" + std::to_string(rng());
+        switch (rng() % 8)
+        {
+            case 0: case 1: case 2:
+                ok = check(list.insert_element(key, value) == (expected.count(key) ? 1 : 0), "insert_element result") && ok;
+                expected.emplace(key, value);
+                break;
+            case 3:
+                ok = check(list.update_element(key, value) == (expected.count(key) > 0), "update_element result") && ok;
+                if (expected.count(key))
+                {
+                    expected[key] = value;
+                }
+                break;
+            case 4: case 5:
+                ok = check(list.delete_element(key) == (expected.erase(key) == 1), "delete_element result") && ok;
+                break;
+            default:
+            {
+                auto found = expected.find(key);
+                std::string actual;
+                bool present = list.search_element_value(key, actual);
+                ok = check(list.search_element(key) == (found != expected.end()), "search_element result") && ok;
+                ok = check(found == expected.end() ? !present : present && actual == found->second,
+                           "search_element_value(" + std::to_string(key) + ")") && ok;
+                break;
+            }
+        }
+
+        if (step % 1000 == 0)
+        {
+            ok = check(list.size() == static_cast<int>(expected.size()), "size matches std::map") && ok;
+        }
+        if (step == 25000)
+        {
+            list.clear();
+            expected.clear();
+        }
+        if (!ok)
+        {
+            LOG_ERROR << "Concurrent skiplist run diverged at step " << step << " with seed " << seed;
+            return false;
+        }
+    }
+
+    for (int key = 0; key < 1024; key++)
+    {
+        auto found = expected.find(key);
+        std::string actual;
+        bool present = list.search_element_value(key, actual);
+        ok = check(found == expected.end() ? !present : present && actual == found->second,
+                   "final contents match std::map at key " + std::to_string(key)) && ok;
+    }
+    return ok;
+}
+
+//  并发跳表的多线程压力：每个线程独占一组交错的键(key % kThreads)，结果必须与线程自己的 std::map 完全一致；
+//  另有 shared_keys 个键 [kOwnedKeys, kOwnedKeys + shared_keys) 由所有线程争用插入和删除，
+//  结束时成功插入数减成功删除数必须等于留在跳表中的键数
+template<typename List>
+bool concurrent_list_stress(unsigned seed, int shared_keys)
+{
+    constexpr int kThreads = 4;
+    constexpr int kOwnedKeys = 4096;
+    constexpr int kOpsPerThread = 20000;
+
+    List list(12);
+    std::vector<std::map<int, std::string>> owned(kThreads);
+    std::atomic<long long> wrong(0), shared_inserted(0), shared_deleted(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(seed + t);
+            std::map<int, std::string> &expected = owned[t];
+            for (int i = 0; i < kOpsPerThread; i++)
+            {
+                if (rng() % 4 == 0)
+                {
+                    int key = kOwnedKeys + static_cast<int>(rng() % shared_keys);
+                    std::string actual;
+                    switch (rng() % 3)
+                    {
+                        case 0:
+                            shared_inserted += list.insert_element(key, "shared-" + std::to_string(key)) == 0 ? 1 : 0;
+                            break;
+                        case 1:
+                            shared_deleted += list.delete_element(key) ? 1 : 0;
+                            break;
+                        default:
+                            if (list.search_element_value(key, actual) && actual != "shared-" + std::to_string(key))
+                            {
+                                wrong++;
+                            }
+                            break;
+                    }
+                }
+                else
+                {
+                    //  相邻的键属于不同线程，写操作在同一批前驱节点上竞争
+                    int key = static_cast<int>(rng() % (kOwnedKeys / kThreads)) * kThreads + t;
+                    std::string value = "key-" + std::to_string(key) + "-" + std::to_string(rng());
+                    std::string actual;
+                    auto found = expected.find(key);
+                    bool correct = true;
+                    switch (rng() % 4)
+                    {
+                        case 0:
+                            correct = list.insert_element(key, value) == (found != expected.end() ? 1 : 0);
+                            expected.emplace(key, value);
+                            break;
+                        case 1:
+                            correct = list.update_element(key, value) == (found != expected.end());
+                            if (found != expected.end())
+                            {
+                                found->second = value;
+                            }
+                            break;
+                        case 2:
+                            correct = list.delete_element(key) == (found != expected.end());
+                            expected.erase(key);
+                            break;
+                        default:
+                            correct = list.search_element(key) == (found != expected.end())
+                                      && (found == expected.end() ? !list.search_element_value(key, actual)
+                                                                  : list.search_element_value(key, actual) && actual == found->second);
+                            break;
+                    }
+                    wrong += correct ? 0 : 1;
+                }
+                if (i % 16 == 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    bool ok = check(wrong == 0, "operations on owned keys match each thread's std::map (" + std::to_string(wrong.load()) + " wrong)");
+    int expected_size = 0;
+    int mismatched = 0;
+    for (auto &expected : owned)
+    {
+        expected_size += static_cast<int>(expected.size());
+        for (auto &entry : expected)
+        {
+            std::string actual;
+            mismatched += list.search_element_value(entry.first, actual) && actual == entry.second ? 0 : 1;
+        }
+    }
+    int shared_present = 0;
+    for (int key = kOwnedKeys; key < kOwnedKeys + shared_keys; key++)
+    {
+        shared_present += list.search_element(key) ? 1 : 0;
+    }
+    ok = check(mismatched == 0, "owned keys hold their last written values") && ok;
+    ok = check(shared_present == shared_inserted - shared_deleted, "contended inserts and deletes balance ("
+               + std::to_string(shared_inserted.load()) + " inserted, " + std::to_string(shared_deleted.load())
+               + " deleted, " + std::to_string(shared_present) + " present)") && ok;
+    ok = check(list.size() == expected_size + shared_present, "size matches the final contents") && ok;
+    return ok;
+}
+
+//  对展开跳表执行随机操作序列。键取自 [-kKeyRange / 2, kKeyRange / 2) 的小区间，节点反复分裂与合并，
+//  小于所有元素的键不断落到第一个节点的开头，负键覆盖 SIMD 有符号比较；每 1000 次操作完整比较一次
+template<typename K, int Capacity>
+bool unrolled_run(unsigned seed)
+{
+    constexpr int kKeyRange = 1024;
+    std::mt19937 rng(seed);
+    UnrolledSkipList<K, std::string, SharedMutexLock, Capacity> list(12);
+    std::map<K, std::string> expected;
+    bool ok = true;
+
+    for (int step = 1; step <= 100000; step++)
+    {
+        //  每 20000 次操作把键区间右移一次，第一个节点被逐渐删空，后面的节点成为新的第一个节点
+        K key = static_cast<K>(static_cast<int>(rng() % kKeyRange) - kKeyRange / 2 + step / 20000 * 64);
+        std::string value = "value-" + std::to_string(rng());
+        switch (rng() % 6)
+        {
+            case 0: case 1:
+                ok = check(list.insert_element(key, value) == (expected.count(key) ? 1 : 0), "insert_element result") && ok;
+                expected.emplace(key, value);
+                break;
+            case 2:
+                ok = check(list.update_element(key, value) == (expected.count(key) > 0), "update_element result") && ok;
+                if (expected.count(key))
+                {
+                    expected[key] = value;
+                }
+                break;
+            case 3: case 4:
+                list.delete_element(key);
+                expected.erase(key);
+                break;
+            default:
+            {
+                auto found = expected.find(key);
+                std::string *actual = list.search_element_value(key);
+                ok = check(list.search_element(key) == (found != expected.end()), "search_element result") && ok;
+                ok = check(found == expected.end() ? actual == nullptr : actual != nullptr && *actual == found->second,
+                           "search_element_value(" + std::to_string(key) + ")") && ok;
+                break;
+            }
+        }
+
+        if (step % 1000 == 0)
+        {
+            auto next = expected.begin();
+            bool same = true;
+            size_t visited = list.for_each([&](const K &k, const std::string &v) {
+                same = same && next != expected.end() && next->first == k && next->second == v;
+                if (next != expected.end())
+                {
+                    ++next;
+                }
+            });
+            ok = check(same && visited == expected.size(), "for_each matches std::map") && ok;
+            ok = check(list.size() == static_cast<int>(expected.size()), "size matches std::map") && ok;
+            //  节点不会空着留在跳表中，也不会比必要的数量多出太多
+            int nodes = list.node_count();
+            ok = check(nodes * Capacity >= list.size() && (list.size() == 0 || nodes > 0) && nodes <= list.size(),
+                       "node count stays between size / Capacity and size (" + std::to_string(nodes) + " nodes)") && ok;
+        }
+        if (!ok)
+        {
+            LOG_ERROR << "Unrolled skiplist run diverged at step " << step << " with seed " << seed;
+            return false;
+        }
+    }
+
+    list.clear();
+    return check(list.size() == 0 && list.node_count() == 0 && !list.search_element(0), "clear empties the list") && ok;
+}
+
+} // namespace
+
+bool test_differential_against_map()
+{
+    LOG_INFO << "Testing SkipList against std::map with random operations.";
+    bool ok = differential_run<FullNodeFeatures>(20240501);
+    ok = differential_run<PlainNodeFeatures>(20240502) && ok;
+    return report("SkipList matches std::map under random operations", ok);
+}
+
+bool test_snapshot_round_trips()
+{
+    LOG_INFO << "Testing SkipList snapshot round trips and corruption handling.";
+    const std::string directory = fresh_directory("snapshot").string();
+    std::mt19937 rng(20240503);
+    bool ok = true;
+
+    SkipList<int, std::string> source(12);
+    source.enable_bloom_filter();
+    for (int i = 0; i < 5000; i++)
+    {
+        source.insert_element(static_cast<int>(rng() % 6000), "value-" + std::to_string(i) + std::string(rng() % 40, 's'));
+    }
+    mutate(source, rng);
+
+    //  单文件快照：往返一致；记录区被截断或翻转字节后加载失败，目标跳表保持为空；
+    //  记录区之后的过滤器段损坏时只丢弃过滤器，加载照常成功
+    const std::string snapshot_file = directory + "/single.snap";
+    ok = check(source.save_snapshot(snapshot_file), "save_snapshot") && ok;
+    {
+        SkipList<int, std::string> loaded(12);
+        ok = check(loaded.load_snapshot(snapshot_file) && loaded.skiplist_equals(source), "snapshot round trip") && ok;
+    }
+    {
+        const std::string damaged = directory + "/filter.snap";
+        std::filesystem::copy_file(snapshot_file, damaged);
+        SkipList<int, std::string> loaded(12);
+        ok = check(flip_byte(damaged, -3) && loaded.load_snapshot(damaged) && loaded.skiplist_equals(source),
+                   "corrupt filter section is ignored") && ok;
+    }
+    {
+        const std::string truncated = directory + "/truncated.snap";
+        std::filesystem::copy_file(snapshot_file, truncated);
+        SkipList<int, std::string> loaded(12);
+        ok = check(truncate_tail(truncated, std::filesystem::file_size(truncated) / 2) && !loaded.load_snapshot(truncated)
+                   && loaded.size() == 0, "truncated snapshot is rejected") && ok;
+    }
+    {
+        SkipList<int, std::string> loaded(12);
+        ok = check(flip_byte(snapshot_file, sizeof(SnapshotHeader) + 100) && !loaded.load_snapshot(snapshot_file)
+                   && loaded.size() == 0, "corrupt snapshot is rejected") && ok;
+    }
+
+    //  分区快照：两代快照各自往返一致；损坏当前代的一个段后整个加载失败
+    ThreadPool pool(4);
+    const std::string manifest_file = directory + "/partitioned.manifest";
+    ok = check(source.save_partitioned_snapshot(manifest_file, pool, 4), "save_partitioned_snapshot generation 1") && ok;
+    {
+        SkipList<int, std::string> loaded(12);
+        ok = check(loaded.load_partitioned_snapshot(manifest_file, pool) && loaded.skiplist_equals(source),
+                   "partitioned snapshot round trip") && ok;
+    }
+    mutate(source, rng);
+    ok = check(source.save_partitioned_snapshot(manifest_file, pool, 3), "save_partitioned_snapshot generation 2") && ok;
+    {
+        SkipList<int, std::string> loaded(12);
+        ok = check(loaded.load_partitioned_snapshot(manifest_file, pool) && loaded.skiplist_equals(source),
+                   "partitioned snapshot round trip after modification") && ok;
+    }
+    {
+        std::string segment = snapshot_segment_path(manifest_file, snapshot_segment_name(manifest_file, 2, 1));
+        SkipList<int, std::string> loaded(12);
+        ok = check(flip_byte(segment, -10) && !loaded.load_partitioned_snapshot(manifest_file, pool) && loaded.size() == 0,
+                   "corrupt partition segment is rejected") && ok;
+    }
+
+    //  增量快照：基准加两个增量往返一致；损坏最新的增量后加载失败，不留下只应用了一部分的内容
+    const std::string incremental_file = directory + "/incremental.snap";
+    ok = check(source.save_incremental_snapshot(incremental_file), "save_incremental_snapshot base") && ok;
+    for (int round = 0; round < 2; round++)
+    {
+        mutate(source, rng);
+        ok = check(source.save_incremental_snapshot(incremental_file), "save_incremental_snapshot delta") && ok;
+    }
+    {
+        SkipList<int, std::string> loaded(12);
+        ok = check(loaded.load_incremental_snapshot(incremental_file) && loaded.skiplist_equals(source),
+                   "incremental snapshot round trip") && ok;
+    }
+    {
+        SkipList<int, std::string> loaded(12);
+        ok = check(flip_byte(delta_file_path(incremental_file, 1, 2), -3) && !loaded.load_incremental_snapshot(incremental_file)
+                   && loaded.size() == 0, "corrupt delta is rejected") && ok;
+    }
+
+    std::filesystem::remove_all(directory);
+    return report("SkipList snapshots round trip and reject corrupt files", ok);
+}
+
+bool test_wal_recovery()
+{
+    LOG_INFO << "Testing SkipList recovery from the write-ahead log.";
+    const std::string directory = fresh_directory("wal").string();
+    const std::string wal_path = directory + "/kv.wal";
+    const std::string snapshot_file = directory + "/kv.snap";
+    std::mt19937 rng(20240504);
+    bool ok = true;
+
+    //  第一次启动：没有快照也没有日志，之后的写操作全部记入日志
+    SkipList<int, std::string> source(12);
+    {
+        WriteAheadLog<int, std::string> wal(wal_path, WalSyncPolicy::OsManaged);
+        ok = check(source.recover(snapshot_file, wal) && source.size() == 0, "recover with nothing on disk") && ok;
+        mutate(source, rng);
+        source.clear();
+        for (int round = 0; round < 2; round++)
+        {
+            mutate(source, rng);
+        }
+        source.attach_wal(nullptr);
+    }
+    {
+        SkipList<int, std::string> recovered(12);
+        WriteAheadLog<int, std::string> wal(wal_path, WalSyncPolicy::OsManaged);
+        ok = check(recovered.recover(snapshot_file, wal) && recovered.skiplist_equals(source), "recover replays the log") && ok;
+        recovered.attach_wal(nullptr);
+    }
+
+    //  检查点之后只保留新段，恢复从快照开始重放新段
+    {
+        WriteAheadLog<int, std::string> wal(wal_path, WalSyncPolicy::OsManaged);
+        SkipList<int, std::string> restarted(12);
+        ok = check(restarted.recover(snapshot_file, wal), "recover before checkpoint") && ok;
+        mutate(restarted, rng);
+        size_t before = files_with_prefix(directory, "kv.wal.").size();
+        ok = check(restarted.checkpoint(snapshot_file), "checkpoint") && ok;
+        ok = check(files_with_prefix(directory, "kv.wal.").size() < before, "checkpoint removes old log segments") && ok;
+        mutate(restarted, rng);
+        restarted.attach_wal(nullptr);
+        wal.close();
+
+        SkipList<int, std::string> recovered(12);
+        WriteAheadLog<int, std::string> next(wal_path, WalSyncPolicy::OsManaged);
+        ok = check(recovered.recover(snapshot_file, next) && recovered.skiplist_equals(restarted),
+                   "recover from checkpoint and newer segments") && ok;
+
+        //  最后一条记录写到一半时崩溃：截断段尾，恢复时丢弃这条残缺的记录
+        recovered.insert_element(100000, "torn");
+        recovered.attach_wal(nullptr);
+        next.close();
+        recovered.delete_element(100000);
+
+        std::vector<std::string> segments = files_with_prefix(directory, "kv.wal.");
+        SkipList<int, std::string> torn(12);
+        WriteAheadLog<int, std::string> last(wal_path, WalSyncPolicy::OsManaged);
+        ok = check(!segments.empty() && truncate_tail(segments.back(), 3) && torn.recover(snapshot_file, last)
+                   && torn.skiplist_equals(recovered), "torn tail record is dropped") && ok;
+        torn.attach_wal(nullptr);
+    }
+
+    //  日志关闭后写出失败并拒绝之后的追加，写操作仍在内存中生效，并以 WalCommitError 通知调用者
+    {
+        SkipList<int, std::string> list(12);
+        WriteAheadLog<int, std::string> wal(wal_path, WalSyncPolicy::OsManaged);
+        ok = check(wal.open(), "open a log for the failure check") && ok;
+        list.attach_wal(&wal);
+        ok = check(list.insert_element(1, "durable") == 0, "writes commit while the log is healthy") && ok;
+        wal.close();
+        auto rejected = [](auto write) {
+            try
+            {
+                write();
+            }
+            catch (const WalCommitError &)
+            {
+                return true;
+            }
+            return false;
+        };
+        ok = check(rejected([&] { list.insert_element(2, "unlogged"); }) && list.search_element(2),
+                   "insert_element reports the failed write") && ok;
+        ok = check(rejected([&] { list.update_element(1, "unlogged"); }) && *list.search_element_value(1) == "unlogged",
+                   "update_element reports the rejected record") && ok;
+        ok = check(rejected([&] { list.delete_element(2); }) && !list.search_element(2),
+                   "delete_element reports the rejected record") && ok;
+        ok = check(rejected([&] { list.clear(); }) && list.size() == 0, "clear reports the rejected record") && ok;
+        list.attach_wal(nullptr);
+    }
+
+    std::filesystem::remove_all(directory);
+    return report("SkipList recovers from snapshot and write-ahead log", ok);
+}
+
+bool test_lock_free_read_stress()
+{
+    LOG_INFO << "Testing lock-free SkipList reads against concurrent writers.";
+    constexpr int kStableKeys = 500;        //  [0, 500) 常驻，只修改值
+    constexpr int kChurnKeys = 2000;        //  [500, 2500) 反复插入和删除
+    constexpr int kWriters = 2;
+    constexpr int kReaders = 4;
+    constexpr int kWritesPerWriter = 20000;
+
+    SkipList<int, std::string> list(12);
+    auto value_of = [](int key, unsigned generation) {
+        return "key-" + std::to_string(key) + "-" + std::to_string(generation) + std::string(generation % 32, 'g');
+    };
+    auto belongs_to = [](int key, const std::string &value) {
+        std::string prefix = "key-" + std::to_string(key) + "-";
+        return value.compare(0, prefix.size(), prefix) == 0;
+    };
+    for (int key = 0; key < kStableKeys; key++)
+    {
+        list.insert_element(key, value_of(key, 0));
+    }
+
+    std::atomic<int> writers_running(kWriters);
+    std::atomic<long long> missing(0), foreign(0), unordered(0), reads(0);
+
+    //  读写双方都定期让出时间片：核数少的机器上写者不会在一个调度周期内写完，
+    //  delete_range 等待读者离开时也不必等满一个调度周期
+    std::vector<std::thread> threads;
+    for (int w = 0; w < kWriters; w++)
+    {
+        threads.emplace_back([&, w]() {
+            std::mt19937 rng(20240505 + w);
+            for (int i = 0; i < kWritesPerWriter; i++)
+            {
+                int stable = static_cast<int>(rng() % kStableKeys);
+                int churn = kStableKeys + static_cast<int>(rng() % kChurnKeys);
+                switch (rng() % 5)
+                {
+                    case 0:
+                        list.update_element(stable, value_of(stable, rng()));
+                        break;
+                    case 1:
+                        list.insert_element(churn, value_of(churn, rng()));
+                        break;
+                    case 2:
+                        list.update_element(churn, value_of(churn, rng()));
+                        break;
+                    case 3:
+                        list.delete_element(churn);
+                        break;
+                    default:
+                        list.delete_range(churn, std::min(churn + static_cast<int>(rng() % 16), kStableKeys + kChurnKeys));
+                        break;
+                }
+                if (i % 16 == 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            writers_running--;
+        });
+    }
+    for (int r = 0; r < kReaders; r++)
+    {
+        threads.emplace_back([&, r]() {
+            std::mt19937 rng(20240515 + r);
+            while (writers_running.load() > 0)
+            {
+                int stable = static_cast<int>(rng() % kStableKeys);
+                int churn = kStableKeys + static_cast<int>(rng() % kChurnKeys);
+                if (!list.search_element(stable))
+                {
+                    missing++;
+                }
+                {
+                    //  守卫存活期间返回的值不会被释放，也不会被原地改写
+                    auto guard = list.read_guard();
+                    const std::string *value = list.search_element_value(stable);
+                    if (value == nullptr)
+                    {
+                        missing++;
+                    }
+                    else if (!belongs_to(stable, *value))
+                    {
+                        foreign++;
+                    }
+                    value = list.search_element_value(churn);
+                    if (value != nullptr && !belongs_to(churn, *value))
+                    {
+                        foreign++;
+                    }
+                }
+                if (rng() % 64 == 0)
+                {
+                    auto guard = list.read_guard();
+                    int previous = -1;
+                    int stable_seen = 0;
+                    for (auto node = list.begin(); node != list.end(); ++node)
+                    {
+                        if (node->get_key() <= previous)
+                        {
+                            unordered++;
+                        }
+                        if (!belongs_to(node->get_key(), node->get_value()))
+                        {
+                            foreign++;
+                        }
+                        previous = node->get_key();
+                        stable_seen += previous < kStableKeys ? 1 : 0;
+                    }
+                    if (stable_seen != kStableKeys)
+                    {
+                        missing++;
+                    }
+                }
+                reads++;
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    bool ok = check(missing == 0, "readers always find the resident keys (" + std::to_string(missing.load()) + " misses)");
+    ok = check(foreign == 0, "readers only see values written for the key (" + std::to_string(foreign.load()) + " mismatches)") && ok;
+    ok = check(unordered == 0, "guarded iteration stays ordered") && ok;
+    ok = check(reads > 0, "readers ran alongside the writers") && ok;
+    int counted = 0;
+    for (auto node = list.begin(); node != list.end(); ++node)
+    {
+        counted++;
+    }
+    ok = check(counted == list.size(), "size matches the final contents") && ok;
+    return report("Lock-free SkipList reads stay consistent under concurrent writes", ok);
+}
+
+bool test_arena_cross_thread_reuse()
+{
+    LOG_INFO << "Testing ArenaNodeAllocator reuse of nodes freed on another thread.";
+    constexpr int kKeys = 10000;
+    constexpr int kRounds = 10;
+
+    SkipList<int, std::string, MutexLock, ArenaNodeAllocator> list(12);
+    bool ok = true;
+    size_t warmed_up = 0;
+    for (int round = 0; round < kRounds; round++)
+    {
+        for (int key = 0; key < kKeys; key++)
+        {
+            list.insert_element(key, "value");
+        }
+        std::thread deleter([&]() { list.delete_range(0, kKeys); });
+        deleter.join();
+        ok = check(list.size() == 0, "round " + std::to_string(round) + " leaves the list empty") && ok;
+
+        //  纪元回收可能把上一轮的节点推迟到下一轮才释放，前两轮用来预热
+        if (round == 1)
+        {
+            warmed_up = list.get_allocator().reserved_bytes();
+        }
+    }
+    size_t reserved = list.get_allocator().reserved_bytes();
+    ok = check(reserved <= 2 * warmed_up, "reserved bytes stay bounded (" + std::to_string(reserved) + " after warm-up "
+               + std::to_string(warmed_up) + ")") && ok;
+
+    //  没有并发的读者和写者时 clear() 整块归还内存，之后的插入重新切分
+    for (int key = 0; key < kKeys; key++)
+    {
+        list.insert_element(key, "value");
+    }
+    list.clear();
+    ok = check(list.get_allocator().reserved_bytes() == 0, "clear() releases every arena block") && ok;
+    list.insert_element(1, "after clear");
+    ok = check(list.size() == 1 && list.search_element(1), "list is usable after a bulk release") && ok;
+    return report("ArenaNodeAllocator reuses nodes freed on another thread and clear() releases its blocks", ok);
+}
+
+bool test_memory_budget_eviction()
+{
+    LOG_INFO << "Testing SkipList memory accounting and CLOCK eviction.";
+    using BudgetList = TestSkipList<FullNodeFeatures>;
+    auto recount = [](BudgetList &list) {
+        size_t bytes = 0;
+        for (auto node = list.begin(); node != list.end(); ++node)
+        {
+            bytes += Node<int, std::string, FullNodeFeatures>::storage_size(node->node_level)
+                + HeapUsage<std::string>::bytes(node->get_value());
+        }
+        return bytes;
+    };
+    bool ok = true;
+
+    //  计费：每种写操作之后与重新统计的结果一致
+    BudgetList list(12);
+    for (int key = 0; key < 1000; key++)
+    {
+        list.insert_element(key, std::string(key % 3 == 0 ? 100 : 5, 'v'));
+    }
+    ok = check(list.memory_usage() == recount(list), "usage after inserts") && ok;
+    list.update_element(5, std::string(500, 'u'));
+    ok = check(list.memory_usage() == recount(list), "usage after update") && ok;
+    list.delete_element(7);
+    list.delete_range(100, 200);
+    ok = check(list.memory_usage() == recount(list), "usage after deletes") && ok;
+    std::vector<std::pair<int, std::string>> batch;
+    for (int key = 2000; key < 2100; key++)
+    {
+        batch.emplace_back(key, std::string(40, 'b'));
+    }
+    list.insert_batch(batch.begin(), batch.end());
+    ok = check(list.memory_usage() == recount(list), "usage after insert_batch") && ok;
+    size_t budget = list.memory_usage() / 2;
+    list.set_memory_budget(budget);
+    ok = check(list.memory_usage() <= budget && list.memory_usage() == recount(list), "usage fits the budget") && ok;
+    list.clear();
+    ok = check(list.memory_usage() == 0, "clear resets usage") && ok;
+
+    //  淘汰顺序：访问过的 [0, 10) 得到第二次机会，从 10 开始连续淘汰
+    BudgetList clock(12);
+    for (int key = 0; key < 100; key++)
+    {
+        clock.insert_element(key, std::string(64, 'c'));
+    }
+    for (int key = 0; key < 10; key++)
+    {
+        clock.search_element(key);
+    }
+    budget = clock.memory_usage() - clock.memory_usage() / 10;
+    clock.set_memory_budget(budget);
+    int first_kept = 10;
+    while (first_kept < 100 && !clock.search_element(first_kept))
+    {
+        first_kept++;
+    }
+    bool hot_kept = true;
+    for (int key = 0; key < 10; key++)
+    {
+        hot_kept = clock.search_element(key) && hot_kept;
+    }
+    ok = check(clock.memory_usage() <= budget, "eviction fits the budget") && ok;
+    ok = check(hot_kept, "recently read keys get a second chance") && ok;
+    ok = check(first_kept > 10 && clock.size() == 100 - (first_kept - 10), "unreferenced keys are evicted in clock order from the head") && ok;
+
+    //  上面的查找重新置位了 [0, 10) 与 first_kept 的访问位；再次收紧时指针从上次停下的位置继续
+    budget = clock.memory_usage() - clock.memory_usage() / 10;
+    clock.set_memory_budget(budget);
+    bool continued = clock.search_element(0) && clock.search_element(9) && !clock.search_element(first_kept + 1);
+    ok = check(clock.memory_usage() <= budget && continued, "the clock hand resumes where the previous eviction stopped") && ok;
+    return report("SkipList memory budget accounting and CLOCK eviction", ok);
+}
+
+bool test_rank_queries_under_concurrency()
+{
+    LOG_INFO << "Testing SkipList rank queries against concurrent writers.";
+    bool ok = true;
+
+    //  读守卫持有共享锁时，排名查询不能再去加独占锁
+    {
+        SkipList<int, std::string, SharedMutexLock, DefaultNodeAllocator, std::less<>, std::hash<int>, FullNodeFeatures> shared(12);
+        for (int key = 0; key < 100; key++)
+        {
+            shared.insert_element(key, "value");
+        }
+        auto guard = shared.read_guard();
+        auto selected = shared.select(3);
+        auto median = shared.percentile(0.5);
+        ok = check(selected != shared.end() && selected->get_key() == 3 && shared.rank(40) == 40
+                   && shared.count_range(10, 20) == 10 && median != shared.end() && median->get_key() == 49,
+                   "rank queries under a shared read guard") && ok;
+    }
+
+    //  常驻键 [3000, 3500) 只修改值，写者在它们之前的 [0, 2000) 插入和删除：常驻键的排名随之变化，
+    //  但同一次查询读到的跨度一致时，常驻区间内的计数与最大元素始终不变
+    constexpr int kFirstResident = 3000;
+    constexpr int kResident = 500;
+    TestSkipList<FullNodeFeatures> list(12);
+    for (int key = kFirstResident; key < kFirstResident + kResident; key++)
+    {
+        list.insert_element(key, "resident");
+    }
+    std::atomic<bool> writing(true);
+    std::atomic<long long> wrong(0), queries(0);
+    std::thread writer([&]() {
+        std::mt19937 rng(20240506);
+        for (int i = 0; i < 20000; i++)
+        {
+            int churn = static_cast<int>(rng() % 2000);
+            switch (rng() % 4)
+            {
+                case 0:
+                    list.insert_element(churn, "churn");
+                    break;
+                case 1:
+                    list.delete_element(churn);
+                    break;
+                case 2:
+                    list.delete_range(churn, churn + static_cast<int>(rng() % 16));
+                    break;
+                default:
+                    list.update_element(kFirstResident + static_cast<int>(rng() % kResident), "updated");
+                    break;
+            }
+            if (i % 16 == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        writing = false;
+    });
+    std::thread reader([&]() {
+        std::mt19937 rng(20240507);
+        while (writing.load())
+        {
+            int offset = static_cast<int>(rng() % kResident);
+            auto guard = list.read_guard();
+            auto highest = list.percentile(1.0);
+            if (list.count_range(kFirstResident, kFirstResident + kResident) != kResident
+                || list.count_range(kFirstResident + offset, kFirstResident + kResident) != kResident - offset
+                || highest == list.end() || highest->get_key() != kFirstResident + kResident - 1)
+            {
+                wrong++;
+            }
+            queries++;
+            std::this_thread::yield();
+        }
+    });
+    writer.join();
+    reader.join();
+    ok = check(wrong == 0, "rank queries stay exact under concurrent writes (" + std::to_string(wrong.load()) + " wrong)") && ok;
+    ok = check(queries > 0, "rank queries ran alongside the writer") && ok;
+    return report("SkipList rank queries do not deadlock and stay exact under concurrent writes", ok);
+}
+
+bool test_concurrent_skiplist_against_map()
+{
+    LOG_INFO << "Testing ConcurrentSkipList against std::map with random operations.";
+    bool ok = concurrent_list_run<ConcurrentSkipList<int, std::string>>(20240508);
+    return report("ConcurrentSkipList matches std::map under random operations", ok);
+}
+
+bool test_concurrent_skiplist_stress()
+{
+    LOG_INFO << "Testing ConcurrentSkipList with concurrent inserts, deletes and searches.";
+    bool ok = concurrent_list_stress<ConcurrentSkipList<int, std::string>>(20240509, 64);
+    return report("ConcurrentSkipList stays consistent under concurrent inserts, deletes and searches", ok);
+}
+
+bool test_lazy_skiplist_against_map()
+{
+    LOG_INFO << "Testing LazySkipList against std::map with random operations.";
+    bool ok = concurrent_list_run<LazySkipList<int, std::string>>(20240510);
+    return report("LazySkipList matches std::map under random operations", ok);
+}
+
+bool test_lazy_skiplist_stress()
+{
+    LOG_INFO << "Testing LazySkipList with concurrent inserts, deletes and searches.";
+    //  64 个争用键上前驱各不相同的写操作并行；只有 4 个争用键时几乎每次都要锁同一批前驱，
+    //  校验经常因前驱被标记或改指而失败，删除者持有 victim 的锁重新查找前驱
+    bool ok = concurrent_list_stress<LazySkipList<int, std::string>>(20240511, 64);
+    ok = concurrent_list_stress<LazySkipList<int, std::string>>(20240512, 4) && ok;
+    ok = concurrent_list_stress<LazySkipList<int, std::string, MutexLock>>(20240513, 4) && ok;
+    return report("LazySkipList stays consistent under concurrent inserts, deletes and searches", ok);
+}
+
+bool test_unrolled_skiplist_against_map()
+{
+    LOG_INFO << "Testing UnrolledSkipList against std::map with random operations.";
+    bool ok = unrolled_run<int, 16>(20240514);
+    ok = unrolled_run<int, 8>(20240515) && ok;
+    ok = unrolled_run<int, 32>(20240516) && ok;
+    ok = unrolled_run<int64_t, 8>(20240517) && ok;
+    return report("UnrolledSkipList matches std::map through node splits and merges", ok);
+}
+
+bool test_ttl_expiry()
+{
+    LOG_INFO << "Testing SkipList TTL expiry.";
+    using TtlList = TestSkipList<NodeFeatures<false, false, true, false>>;
+    using std::chrono::milliseconds;
+    const milliseconds kShort(100);
+    const milliseconds kPastShort(250);
+    bool ok = true;
+
+    //  过期的键在被删除之前对查询不可见，不能修改或续期，但可以重新插入
+    {
+        TtlList list(12);
+        ok = check(list.insert_element(1, "short", kShort) == 0 && list.insert_element(2, "long", std::chrono::hours(1)) == 0,
+                   "insert with ttl") && ok;
+        ok = check(list.search_element(1) && list.insert_element(1, "again", kShort) == 1,
+                   "a key is visible and present before its deadline") && ok;
+        std::this_thread::sleep_for(kPastShort);
+        ok = check(!list.search_element(1) && list.search_element_value(1) == nullptr && list.search_element(2),
+                   "an expired key is hidden from reads before it is removed") && ok;
+        ok = check(!list.update_element(1, "updated") && !list.expire(1, std::chrono::hours(1)) && !list.persist(1),
+                   "an expired key cannot be updated, extended or persisted") && ok;
+        ok = check(list.insert_element(1, "fresh") == 0 && list.search_element_value(1) != nullptr
+                   && *list.search_element_value(1) == "fresh", "an expired key can be inserted again") && ok;
+        ok = check(list.expire_due() == 0 && list.search_element(1),
+                   "the stale wheel entry of a reinserted key is ignored") && ok;
+    }
+
+    //  时间轮到期时删除键；expire() 延期与 persist() 取消之后，原来的条目不再删除键
+    {
+        constexpr int kKeys = 200;
+        TtlList list(12);
+        for (int key = 0; key < kKeys; key++)
+        {
+            list.insert_element(key, "value", kShort);
+        }
+        list.insert_element(kKeys, "no ttl");
+        int extended = 0, persisted = 0;
+        for (int key = 0; key < kKeys; key += 10)
+        {
+            extended += list.expire(key, std::chrono::hours(1)) ? 1 : 0;
+            persisted += list.persist(key + 1) ? 1 : 0;
+        }
+        ok = check(extended == kKeys / 10 && persisted == kKeys / 10, "expire() and persist() on live keys") && ok;
+        ok = check(list.expire(kKeys, kShort), "expire() schedules a key inserted without ttl") && ok;
+        ok = check(list.expire_due() == 0 && list.size() == kKeys + 1, "nothing is removed before the deadline") && ok;
+        std::this_thread::sleep_for(kPastShort);
+        size_t removed = list.expire_due();
+        int survivors = kKeys / 10 * 2;
+        ok = check(removed == static_cast<size_t>(kKeys - survivors + 1), "expire_due() removes exactly the due keys ("
+                   + std::to_string(removed) + " removed)") && ok;
+        ok = check(list.size() == survivors, "size drops to the extended and persisted keys") && ok;
+        bool kept = true;
+        for (int key = 0; key < kKeys; key += 10)
+        {
+            kept = kept && list.search_element(key) && list.search_element(key + 1) && !list.search_element(key + 2);
+        }
+        ok = check(kept && !list.search_element(kKeys), "extended and persisted keys survive their old deadline") && ok;
+        ok = check(list.expire_due() == 0, "a second pass finds nothing due") && ok;
+    }
+
+    //  过期服务在线程池中周期性删除到期的键
+    {
+        constexpr int kKeys = 500;
+        ThreadPool pool(1);
+        TtlList list(12);
+        list.start_expiry_service(pool, milliseconds(5));
+        for (int key = 0; key < kKeys; key++)
+        {
+            list.insert_element(key, "value", key % 2 == 0 ? kShort : std::chrono::hours(1));
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (list.size() != kKeys / 2 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(milliseconds(5));
+        }
+        list.stop_expiry_service();
+        ok = check(list.size() == kKeys / 2, "the expiry service removes due keys in the background") && ok;
+        ok = check(!list.search_element(0) && list.search_element(1), "only keys with a passed deadline are removed") && ok;
+    }
+
+    return report("SkipList TTL keys expire lazily, through the timing wheel and through the expiry service", ok);
+}
+
+bool test_hash_index_consistency()
+{
+    LOG_INFO << "Testing SkipList hash index consistency.";
+    constexpr int kKeyRange = 4000;
+    std::mt19937 rng(20240518);
+    //  默认的无锁读模式下，修改值以新节点替换旧节点，索引中的登记随之替换
+    SkipList<int, std::string> list(12);
+    std::map<int, std::string> expected;
+    bool ok = true;
+
+    //  索引查找与迭代器遍历都必须与 std::map 一致，查找走索引，遍历走跳表本身
+    auto index_matches = [&](const std::string &stage) {
+        bool same = list.size() == static_cast<int>(expected.size());
+        for (int key = 0; key < kKeyRange && same; key++)
+        {
+            auto found = expected.find(key);
+            const std::string *actual = list.search_element_value(key);
+            same = list.search_element(key) == (found != expected.end())
+                   && (found == expected.end() ? actual == nullptr : actual != nullptr && *actual == found->second);
+        }
+        auto next = expected.begin();
+        for (auto node = list.begin(); node != list.end() && same; ++node, ++next)
+        {
+            same = next != expected.end() && node->get_key() == next->first && node->get_value() == next->second;
+        }
+        return check(same && next == expected.end(), "hash index matches std::map after " + stage);
+    };
+
+    for (int key = 0; key < kKeyRange; key += 4)
+    {
+        list.insert_element(key, "initial");
+        expected.emplace(key, "initial");
+    }
+    list.enable_hash_index();
+    ok = check(list.has_hash_index(), "enable_hash_index() builds an index") && ok;
+    ok = index_matches("building over existing keys") && ok;
+
+    //  键区间远大于初始容量，索引多次扩容；删除留下的墓碑在重建时清除
+    for (int step = 1; step <= 20000; step++)
+    {
+        int key = static_cast<int>(rng() % kKeyRange);
+        std::string value = "value-" + std::to_string(rng());
+        switch (rng() % 6)
+        {
+            case 0: case 1:
+                list.insert_element(key, value);
+                expected.emplace(key, value);
+                break;
+            case 2:
+                ok = check(list.update_element(key, value) == (expected.count(key) > 0), "update_element result") && ok;
+                if (expected.count(key))
+                {
+                    expected[key] = value;
+                }
+                break;
+            case 3:
+                list.delete_element(key);
+                expected.erase(key);
+                break;
+            case 4:
+            {
+                int hi = key + static_cast<int>(rng() % 40);
+                list.delete_range(key, hi);
+                expected.erase(expected.lower_bound(key), expected.lower_bound(hi));
+                break;
+            }
+            default:
+            {
+                std::vector<std::pair<int, std::string>> batch;
+                for (int i = 0; i < 8; i++)
+                {
+                    batch.emplace_back(static_cast<int>(rng() % kKeyRange), value);
+                }
+                list.insert_batch(batch.begin(), batch.end());
+                for (auto &entry : batch)
+                {
+                    expected.emplace(entry);
+                }
+                break;
+            }
+        }
+        if (step % 2000 == 0)
+        {
+            ok = index_matches("step " + std::to_string(step)) && ok;
+        }
+    }
+
+    //  关闭期间的修改不进入索引，重新开启时按当前内容重建
+    list.disable_hash_index();
+    for (int key = 1; key < kKeyRange; key += 2)
+    {
+        if (expected.count(key))
+        {
+            list.delete_element(key);
+            expected.erase(key);
+        }
+        else
+        {
+            list.insert_element(key, "while disabled");
+            expected.emplace(key, "while disabled");
+        }
+    }
+    list.enable_hash_index();
+    ok = index_matches("disable, modify and re-enable") && ok;
+
+    list.clear();
+    expected.clear();
+    ok = check(list.has_hash_index(), "clear() keeps the index enabled") && ok;
+    ok = index_matches("clear()") && ok;
+    for (int key = 0; key < 100; key++)
+    {
+        list.insert_element(key, "after clear");
+        expected.emplace(key, "after clear");
+    }
+    ok = index_matches("inserting after clear()") && ok;
+    return report("SkipList hash index stays consistent through inserts, deletes, replacement, rebuild and clear()", ok);
+}
+
+bool run_skiplist_tests()
+{
+    LOG_INFO << "Running SkipList behaviour tests.";
+    int failed = 0;
+    failed += test_differential_against_map() ? 0 : 1;
+    failed += test_snapshot_round_trips() ? 0 : 1;
+    failed += test_wal_recovery() ? 0 : 1;
+    failed += test_lock_free_read_stress() ? 0 : 1;
+    failed += test_arena_cross_thread_reuse() ? 0 : 1;
+    failed += test_memory_budget_eviction() ? 0 : 1;
+    failed += test_rank_queries_under_concurrency() ? 0 : 1;
+    failed += test_ttl_expiry() ? 0 : 1;
+    failed += test_hash_index_consistency() ? 0 : 1;
+    failed += test_concurrent_skiplist_against_map() ? 0 : 1;
+    failed += test_concurrent_skiplist_stress() ? 0 : 1;
+    failed += test_lazy_skiplist_against_map() ? 0 : 1;
+    failed += test_lazy_skiplist_stress() ? 0 : 1;
+    failed += test_unrolled_skiplist_against_map() ? 0 : 1;
+
+    if (failed == 0)
+    {
+        std::cout << "All SkipList behaviour tests passed.\n";
+    }
+    else
+    {
+        std::cout << failed << " SkipList behaviour test(s) failed.\n";
+    }
+    return failed == 0;
+}
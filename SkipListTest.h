@@ -0,0 +1,177 @@
+#ifndef SKIPLIST_TEST_H
+#define SKIPLIST_TEST_H
+
+/**
+ * @brief 以 std::map 为参照，对跳表做随机操作的差分测试。
+ *
+ * @details
+ * 对 FullNodeFeatures 与默认的 PlainNodeFeatures 两种跳表分别执行同一串随机的插入、修改、删除、区间删除、查询与批量插入，
+ * 对 std::map 执行相同的操作。每隔一段操作比较两者的元素个数、迭代器遍历、lower_bound、range、scan，
+ * 开启排名时还比较 rank、select、count_range 与 percentile。
+ *
+ * @return 所有比较一致时返回 true。
+ */
+bool test_differential_against_map();
+
+/**
+ * @brief 测试二进制快照、分区快照与增量快照的保存与加载，以及损坏文件的处理。
+ *
+ * @details
+ * 每种格式先保存再加载到新的跳表，并用 skiplist_equals 比较；分区快照与增量快照在两次保存之间修改源跳表。
+ * 随后翻转快照、段文件或增量文件中的一个字节，或截断文件，加载必须失败，且目标跳表保持为空。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_snapshot_round_trips();
+
+/**
+ * @brief 测试预写日志的恢复。
+ *
+ * @details
+ * 挂接日志后执行插入、修改、删除、区间删除与清空，用新跳表 recover 后必须与源跳表一致；
+ * checkpoint 之后旧日志段被删除，恢复从快照加日志新段得到相同内容；
+ * 截断最后一个段的尾部记录后，恢复只丢失这一条记录。
+ * 日志关闭后写出失败并拒绝之后的追加，写操作仍然生效，但抛出 WalCommitError。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_wal_recovery();
+
+/**
+ * @brief 无锁读与并发写的压力测试。
+ *
+ * @details
+ * 写线程持续修改一组常驻键的值，并在另一段键上插入、删除和区间删除；读线程不加锁地查找与遍历。
+ * 读者必须总能找到常驻键，读到的值必须属于对应的键，持有守卫遍历时键严格递增。
+ * 使用 AddressSanitizer 或 ThreadSanitizer 构建时，还能发现读者访问已释放节点的问题。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_lock_free_read_stress();
+
+/**
+ * @brief 测试 ArenaNodeAllocator 复用其他线程释放的节点，以及 clear() 整块归还内存。
+ *
+ * @details
+ * 每一轮在主线程插入一批键，再在另一个线程把它们全部删除。删除线程释放的节点应回到切出它们的主线程，
+ * 之后的插入复用这些节点，因此预留内存在前几轮之后不再增长。没有并发操作时 clear() 整块归还全部内存块。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_arena_cross_thread_reuse();
+
+/**
+ * @brief 测试内存预算的计费与 CLOCK 淘汰。
+ *
+ * @details
+ * 插入、修改、删除、区间删除与批量插入之后，memory_usage() 必须等于逐节点重新统计的结果；
+ * 设置预算后占用不超过预算。淘汰从时钟指针开始，跳过并清除最近访问过的节点，删除未被访问的节点，
+ * 下一次淘汰从上次停下的位置继续。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_memory_budget_eviction();
+
+/**
+ * @brief 测试排名查询与并发写操作。
+ *
+ * @details
+ * 使用 SharedMutexLock 时，持有 read_guard() 的线程调用 select 等排名查询不能死锁。
+ * 写线程在常驻键之前的区间插入、删除和区间删除，并修改常驻键的值；查询线程不加写锁地调用
+ * count_range 与 percentile，常驻区间内的计数与最大元素必须始终精确。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_rank_queries_under_concurrency();
+
+/**
+ * @brief 测试 TTL 键的过期。
+ *
+ * @details
+ * 过期之后尚未删除的键对查询不可见，不能修改、续期或取消过期，但可以重新插入，重新插入的键不被旧的时间轮条目删除；
+ * expire_due() 只删除到期的键，被 expire() 延期或被 persist() 取消过期的键保留；
+ * 线程池中的过期服务在后台删除到期的键。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_ttl_expiry();
+
+/**
+ * @brief 测试哈希索引与跳表内容的一致性。
+ *
+ * @details
+ * 在已有数据上开启索引，之后执行随机的插入、修改、删除、区间删除与批量插入，键区间远大于索引的初始容量，
+ * 索引多次扩容并清除墓碑；修改在无锁读模式下以新节点替换旧节点，索引登记随之替换。
+ * 关闭索引期间修改跳表，重新开启后索引按当前内容重建；clear() 之后索引为空，重新插入的键可以查到。
+ * 每个阶段都用走索引的查找和走跳表的遍历分别与 std::map 比较。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_hash_index_consistency();
+
+/**
+ * @brief 以 std::map 为参照，对 ConcurrentSkipList 做随机操作的差分测试。
+ *
+ * @details
+ * 单线程执行随机的插入、修改、删除与查找，每次操作的返回值与查到的值都必须与 std::map 一致；
+ * 中途清空一次，之后的操作在层级重新增长的跳表上继续比较。
+ *
+ * @return 所有比较一致时返回 true。
+ */
+bool test_concurrent_skiplist_against_map();
+
+/**
+ * @brief ConcurrentSkipList 的多线程插入、删除与查找压力测试。
+ *
+ * @details
+ * 每个线程独占一组交错的键，对它们的操作结果必须与线程自己的 std::map 一致；相邻的键属于不同线程，
+ * 写操作在同一批前驱节点上竞争 CAS。另有一小段键由所有线程同时插入和删除，结束时成功插入数减去
+ * 成功删除数必须等于留下的键数，size() 必须与最终内容一致。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_concurrent_skiplist_stress();
+
+/**
+ * @brief 以 std::map 为参照，对 LazySkipList 做随机操作的差分测试。
+ *
+ * @details
+ * 与 test_concurrent_skiplist_against_map 相同的操作序列：每次操作的返回值与查到的值都必须与 std::map 一致，
+ * 中途清空一次。
+ *
+ * @return 所有比较一致时返回 true。
+ */
+bool test_lazy_skiplist_against_map();
+
+/**
+ * @brief LazySkipList 的多线程插入、删除与查找压力测试。
+ *
+ * @details
+ * 与 test_concurrent_skiplist_stress 相同的检查，另外把争用键缩小到 4 个，并分别使用 SpinLock 与 MutexLock 节点锁：
+ * 写者自底向上锁住同一批前驱，锁顺序错误会死锁；前驱被标记或改指时校验失败并重试，
+ * 删除者在持有 victim 锁的情况下重新查找前驱，victim 必须恰好被删除一次。
+ *
+ * @return 所有检查通过时返回 true。
+ */
+bool test_lazy_skiplist_stress();
+
+/**
+ * @brief 以 std::map 为参照，对 UnrolledSkipList 做随机操作的差分测试。
+ *
+ * @details
+ * 在约一千个键的小区间内执行 10 万次随机插入、修改、删除与查找，节点反复对半分裂与合并；
+ * 包含负键和小于所有元素的键，覆盖按 keys[0] 下降的边界与 lower_bound_keys 的 SIMD 有符号比较。
+ * 分别使用 int 键的 8、16、32 容量与 int64_t 键，每隔一段操作比较 for_each、size 与节点数。
+ *
+ * @return 所有比较一致时返回 true。
+ */
+bool test_unrolled_skiplist_against_map();
+
+/**
+ * @brief 依次执行所有跳表行为测试，并输出汇总结果。
+ *
+ * @return 全部测试通过时返回 true。
+ */
+bool run_skiplist_tests();
+
+#endif // SKIPLIST_TEST_H
@@ -9,6 +9,10 @@
 #include <condition_variable>
 
 #include "skiplist.h"
+#include "concurrent_skiplist.h"
+#include "lazy_skiplist.h"
+#include "sharded_skiplist.h"
+#include "unrolled_skiplist.h"
 #include "ThreadPool.h"
 #include "benchmark.h"
 #include "ctpl_stl.h"
@@ -18,7 +22,6 @@
 #include "document.h"
 #include "logMod.h"
 
-std::mutex mtx;     // 互斥锁，保护临界区资源
 std::string delimiter = ":";    //  键值对之间的分隔符
 
 int THREAD_NUM;      // 线程数量
@@ -123,7 +126,8 @@ void printTestModeSelection()
     std::cout << "请输入选项: ";
 }
 
-void prepareSkipListForBenchmark(std::unique_ptr<SkipList<int, std::string>>& skipList)
+template<typename SkipListType>
+void prepareSkipListForBenchmark(std::unique_ptr<SkipListType>& skipList)
 {
     if (skipList->size() > 0)
     {
@@ -158,30 +162,106 @@ std::unique_ptr<SkipList<int, std::string>> init_benchmark_data()
     return std::make_unique<SkipList<int, std::string>>(MAX_LEVEL);
 }
 
-void skiplist_benchmark()
+void printImplementationSelection()
 {
-    LOG_INFO << "Starting skip list benchmark.";
-    std::unique_ptr<SkipList<int, std::string>> skipList = init_benchmark_data();
+    std::cout << "\n=============================\n";
+    std::cout << "  请选择跳表实现:\n";
+    std::cout << "  1. SkipList (互斥锁)\n";
+    std::cout << "  2. ConcurrentSkipList (无锁)\n";
+    std::cout << "  3. 两者对比\n";
+    std::cout << "  4. ShardedSkipList (分片，每片独立写锁)\n";
+    std::cout << "  5. SkipList (读写锁)\n";
+    std::cout << "  6. SkipList (TTAS 自旋锁)\n";
+    std::cout << "  7. 锁策略对比 (互斥锁、读写锁、自旋锁、节点锁、无锁)\n";
+    std::cout << "  8. UnrolledSkipList (胖节点，SIMD 节点内查找)\n";
+    std::cout << "  9. LazySkipList (细粒度节点锁)\n";
+    std::cout << "=============================\n";
+    std::cout << "请输入选项: ";
+}
 
-    int testMode = 0;
+// 读取 [min_option, max_option] 范围内的菜单选项，输入无效时要求重新输入
+static int readMenuOption(void (*printMenu)(), int min_option, int max_option)
+{
+    int option = 0;
     while (true)
     {
-        printTestModeSelection();
-        std::cin >> testMode;
-        if (std::cin.fail() || (testMode < 1 || testMode > 3))  // 更新有效选项范围
+        printMenu();
+        std::cin >> option;
+        if (std::cin.fail() || (option < min_option || option > max_option))
         {
             std::cout << "无效选项，请重新输入。\n";
             std::cin.clear();
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
             continue;
         }
-        else
-        {
-            break;
-        }
+        return option;
     }
+}
+
+void skiplist_benchmark()
+{
+    LOG_INFO << "Starting skip list benchmark.";
+    std::unique_ptr<SkipList<int, std::string>> skipList = init_benchmark_data();
+
+    int implementation = readMenuOption(printImplementationSelection, 1, 9);
+    int testMode = readMenuOption(printTestModeSelection, 1, 3);
 
+    if (implementation == 1 || implementation == 3 || implementation == 7)
+    {
+        std::cout << "---------- SkipList ----------" << std::endl;
+        run_benchmark_mode(testMode, skipList);
+    }
+    if (implementation == 5 || implementation == 7)
+    {
+        skipList.reset();
+        std::cout << "---------- SkipList<SharedMutexLock> ----------" << std::endl;
+        auto sharedLockSkipList = std::make_unique<SkipList<int, std::string, SharedMutexLock>>(MAX_LEVEL);
+        run_benchmark_mode(testMode, sharedLockSkipList);
+    }
+    if (implementation == 6 || implementation == 7)
+    {
+        skipList.reset();
+        std::cout << "---------- SkipList<SpinLock> ----------" << std::endl;
+        auto spinLockSkipList = std::make_unique<SkipList<int, std::string, SpinLock>>(MAX_LEVEL);
+        run_benchmark_mode(testMode, spinLockSkipList);
+    }
+    if (implementation == 9 || implementation == 7)
+    {
+        skipList.reset();
+        std::cout << "---------- LazySkipList ----------" << std::endl;
+        auto lazySkipList = std::make_unique<LazySkipList<int, std::string>>(MAX_LEVEL);
+        run_benchmark_mode(testMode, lazySkipList);
+    }
+    if (implementation == 2 || implementation == 3 || implementation == 7)
+    {
+        skipList.reset();   // 释放上一轮的数据，避免两份数据同时占用内存
+        std::cout << "---------- ConcurrentSkipList ----------" << std::endl;
+        auto concurrentSkipList = std::make_unique<ConcurrentSkipList<int, std::string>>(MAX_LEVEL);
+        run_benchmark_mode(testMode, concurrentSkipList);
+    }
+    if (implementation == 4)
+    {
+        skipList.reset();
+        // 分片数量与写线程数一致，每个线程的写入大概率落在不同分片上
+        int shardCount = THREAD_NUM > 0 ? THREAD_NUM : 1;
+        std::cout << "---------- ShardedSkipList (" << shardCount << " shards) ----------" << std::endl;
+        auto shardedSkipList = std::make_unique<ShardedSkipList<int, std::string>>(shardCount, MAX_LEVEL);
+        run_benchmark_mode(testMode, shardedSkipList);
+    }
+    if (implementation == 8)
+    {
+        skipList.reset();
+        std::cout << "---------- UnrolledSkipList ----------" << std::endl;
+        auto unrolledSkipList = std::make_unique<UnrolledSkipList<int, std::string>>(MAX_LEVEL);
+        run_benchmark_mode(testMode, unrolledSkipList);
+    }
+}
+
+template<typename SkipListType>
+void run_benchmark_mode(int testMode, std::unique_ptr<SkipListType> &skipList)
+{
     prepareSkipListForBenchmark(skipList);
+    completedTasks = 0; // 重置计数器
 
     switch (testMode)
     {
@@ -213,7 +293,8 @@ void skiplist_benchmark()
     }
 }
 
-void insertElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int tid)
+template<typename SkipListType>
+void insertElement(std::unique_ptr<SkipListType> &skipList, int tid)
 {
     bool useRandRNG = true;    // 默认使用rand随机数生成器
     if (!ReadUseRandRNG(useRandRNG))
@@ -255,7 +336,8 @@ void insertElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int ti
     }
 }
 
-void getElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int tid)
+template<typename SkipListType>
+void getElement(std::unique_ptr<SkipListType> &skipList, int tid)
 {
     bool useRandRNG = true;    // 默认使用rand随机数生成器
     if (!ReadUseRandRNG(useRandRNG))
@@ -297,7 +379,8 @@ void getElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int tid)
     }
 }
 
-void insert_test_threadpool(std::unique_ptr<SkipList<int, std::string>>& skipList)
+template<typename SkipListType>
+void insert_test_threadpool(std::unique_ptr<SkipListType>& skipList)
 {
     bool useProgressBar = false;    // 默认不显示进度条
     if (!ReadProgressBar(useProgressBar))
@@ -317,7 +400,7 @@ void insert_test_threadpool(std::unique_ptr<SkipList<int, std::string>>& skipLis
         if(!useProgressBar)
         {   /* 在无进度条模式下将任务交给线程池的方法 */
             // 提交插入任务给线程池
-            pool.enqueue(insertElement, std::ref(skipList), i);
+            pool.enqueue(insertElement<SkipListType>, std::ref(skipList), i);
         }
         else
         {   /* 基于progress bar库的进度条*/
@@ -344,7 +427,8 @@ void insert_test_threadpool(std::unique_ptr<SkipList<int, std::string>>& skipLis
     std::cout << std::endl; // 在输出耗时后添加换行
 }
 
-void insert_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipList)
+template<typename SkipListType>
+void insert_test_multithread(std::unique_ptr<SkipListType>& skipList)
 {
     bool useProgressBar = false;    // 默认不显示进度条
     if (!ReadProgressBar(useProgressBar))
@@ -362,7 +446,7 @@ void insert_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipLi
     {
         if(!useProgressBar)
         {   /* 无进度条模式 */
-            threads.emplace_back(insertElement, std::ref(skipList), i);
+            threads.emplace_back(insertElement<SkipListType>, std::ref(skipList), i);
         }
         else
         {   /* 基于progress bar库的进度条*/
@@ -388,7 +472,8 @@ void insert_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipLi
     std::cout << std::endl; // 在输出耗时后添加换行
 }
 
-void insert_test_ctpl(std::unique_ptr<SkipList<int, std::string>>& skipList)
+template<typename SkipListType>
+void insert_test_ctpl(std::unique_ptr<SkipListType>& skipList)
 {
     bool useProgressBar = false;    // 默认不显示进度条
     if (!ReadProgressBar(useProgressBar))
@@ -444,7 +529,8 @@ void insert_test_ctpl(std::unique_ptr<SkipList<int, std::string>>& skipList)
     std::cout << std::endl; // 在输出耗时后添加换行
 }
 
-void search_test_threadpool(std::unique_ptr<SkipList<int, std::string>>& skipList)
+template<typename SkipListType>
+void search_test_threadpool(std::unique_ptr<SkipListType>& skipList)
 {
     bool useProgressBar = false;    // 默认不显示进度条
     if (!ReadProgressBar(useProgressBar))
@@ -463,7 +549,7 @@ void search_test_threadpool(std::unique_ptr<SkipList<int, std::string>>& skipLis
         if(!useProgressBar)
         {   /* 无进度条模式 */
             // 提交搜索任务给线程池
-            pool.enqueue(getElement, std::ref(skipList), i);
+            pool.enqueue(getElement<SkipListType>, std::ref(skipList), i);
         }
         else
         {   /* 基于progress bar库的进度条*/
@@ -489,7 +575,8 @@ void search_test_threadpool(std::unique_ptr<SkipList<int, std::string>>& skipLis
     std::cout << std::endl; // 在输出耗时后添加换行
 }
 
-void search_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipList)
+template<typename SkipListType>
+void search_test_multithread(std::unique_ptr<SkipListType>& skipList)
 {
     bool useProgressBar = false;    // 默认不显示进度条
     if (!ReadProgressBar(useProgressBar))
@@ -507,7 +594,7 @@ void search_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipLi
     {
         if(!useProgressBar)
         {   /* 无进度条模式 */
-            threads.emplace_back(getElement, std::ref(skipList), i);
+            threads.emplace_back(getElement<SkipListType>, std::ref(skipList), i);
         }
         else
         {   /* 基于progress bar库的进度条*/
@@ -533,7 +620,8 @@ void search_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipLi
     std::cout << std::endl; // 在输出耗时后添加换行
 }
 
-void search_test_ctpl(std::unique_ptr<SkipList<int, std::string>>& skipList)
+template<typename SkipListType>
+void search_test_ctpl(std::unique_ptr<SkipListType>& skipList)
 {
     bool useProgressBar = false;    // 默认不显示进度条
     if (!ReadProgressBar(useProgressBar))
@@ -668,4 +756,13 @@ void skiplist_usual_use()
     {
         std::cerr << "An exception occurred: " << e.what() << std::endl;
     }
-}
\ No newline at end of file
+}
+
+// 显式实例化 benchmark 支持的跳表实现
+template void run_benchmark_mode(int, std::unique_ptr<SkipList<int, std::string>> &);
+template void run_benchmark_mode(int, std::unique_ptr<SkipList<int, std::string, SharedMutexLock>> &);
+template void run_benchmark_mode(int, std::unique_ptr<SkipList<int, std::string, SpinLock>> &);
+template void run_benchmark_mode(int, std::unique_ptr<ConcurrentSkipList<int, std::string>> &);
+template void run_benchmark_mode(int, std::unique_ptr<LazySkipList<int, std::string>> &);
+template void run_benchmark_mode(int, std::unique_ptr<ShardedSkipList<int, std::string>> &);
+template void run_benchmark_mode(int, std::unique_ptr<UnrolledSkipList<int, std::string>> &);
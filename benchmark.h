@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <limits>
 
+#include "level_generator.h"
+
 #define MULTI_NUM_FOR_INPUT (1000000)   //  用户输入数据量的乘数,简化用户操作
 
 /**
@@ -51,50 +53,6 @@ bool ReadProgressBar(bool &useProgressBar);
  */
 bool ReadUseRandRNG(bool &useRandRNG);
 
-/**
- * @brief Xorshift64 伪随机数生成器类
- * 
- */
-class Xorshift64
-{
-private:
-    uint64_t state;
-
-public:
-    /**
-     * @brief 构造一个 Xorshift64 对象
-     * 
-     * @param seed 随机数种子，默认使用随机设备生成
-     */
-    Xorshift64(uint64_t seed = std::random_device{}()) : state(seed) {}
-
-    /**
-     * @brief 生成下一个伪随机数
-     * 
-     * @return uint64_t 返回下一个伪随机数
-     */
-    uint64_t next()
-    {
-        state ^= state >> 12;
-        state ^= state << 25;
-        state ^= state >> 27;
-        return state * 0x2545F4914F6CDD1D;
-    }
-
-    /**
-     * @brief 生成一个在指定范围内的伪随机数
-     * 
-     * @param min 最小值
-     * @param max 最大值
-     * @return uint32_t 返回在指定范围内的伪随机数
-     */
-    uint32_t nextInRange(uint32_t min, uint32_t max)
-    {
-        uint64_t range = max - min + 1;
-        return min + static_cast<uint32_t>(next() % range);
-    }
-};
-
 /**
  * @brief 获取一个线程安全的随机种子
  * 
@@ -125,11 +83,23 @@ std::mt19937& getThreadLocalMt19937();
  */
 void printTestModeSelection();
 
+/**
+ * @brief 打印跳表实现选择菜单
+ * 
+ * 提供互斥锁的 SkipList、无锁的 ConcurrentSkipList、两者对比、每片独立写锁的 ShardedSkipList、
+ * 读写锁与 TTAS 自旋锁的 SkipList、所有锁策略的依次对比、胖节点的 UnrolledSkipList，
+ * 以及每个节点一把锁的 LazySkipList。
+ * 
+ * @note 本函数不会处理用户输入，只负责打印菜单。
+ */
+void printImplementationSelection();
+
 /**
  * @brief 准备跳表用于基准测试
  * 
  * 此函数用于准备跳表以进行基准测试。如果跳表中已存在数据，则清除数据；否则，直接开始新的基准测试。
  * 
+ * @tparam SkipListType 跳表类型
  * @param skipList 跳表对象的智能指针
  * 
  * @note 
@@ -137,7 +107,8 @@ void printTestModeSelection();
  * - 如果跳表中已存在数据，则清除所有数据并打印清除信息。
  * - 如果跳表为空，则直接打印开始新的基准测试信息。
  */
-void prepareSkipListForBenchmark(std::unique_ptr<SkipList<int, std::string>> &skipList);
+template<typename SkipListType>
+void prepareSkipListForBenchmark(std::unique_ptr<SkipListType> &skipList);
 
 /**
  * @brief 执行跳表基准测试
@@ -154,6 +125,18 @@ void prepareSkipListForBenchmark(std::unique_ptr<SkipList<int, std::string>> &sk
  */
 void skiplist_benchmark();
 
+/**
+ * @brief 按指定测试模式对一个跳表执行插入和搜索测试
+ * 
+ * @tparam SkipListType 被测跳表类型，任一锁策略的 SkipList、ConcurrentSkipList、LazySkipList、ShardedSkipList 或 UnrolledSkipList。
+ * @param testMode 测试模式，1:ThreadPool 2:Multi-thread 3:CTPL
+ * @param skipList 要测试的跳表的智能指针。
+ * 
+ * @note 开始前会清空跳表并重置完成任务的计数器，因此可以对不同实现依次调用以并排比较。
+ */
+template<typename SkipListType>
+void run_benchmark_mode(int testMode, std::unique_ptr<SkipListType> &skipList);
+
 /**
  * @brief 初始化基准测试数据。
  * 
@@ -170,6 +153,7 @@ std::unique_ptr<SkipList<int, std::string>> init_benchmark_data();
  * 
  * 该函数负责在多线程环境下向跳表中插入一系列随机生成的整数键和固定字符串值的键值对。
  * 
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 引用传递的智能指针，指向要操作的跳表。
  * @param tid 线程ID，用于计算该线程应该插入的元素范围。
  * 
@@ -183,13 +167,15 @@ std::unique_ptr<SkipList<int, std::string>> init_benchmark_data();
  * - 函数内部使用了一个静态全局计数器completedTasks来追踪完成的任务数。
  * - 使用条件变量cv和互斥锁mtx_task来同步线程完成的通知。
  */
-void insertElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int tid);
+template<typename SkipListType>
+void insertElement(std::unique_ptr<SkipListType> &skipList, int tid);
 
 /**
  * @brief 从跳表中搜索元素的函数。
  * 
  * 该函数负责在多线程环境下从跳表中搜索一系列随机生成的整数键。
  * 
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 引用传递的智能指针，指向要操作的跳表。
  * @param tid 线程ID，用于计算该线程应该搜索的元素范围。
  * 
@@ -203,11 +189,13 @@ void insertElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int ti
  * - 函数内部使用了一个静态全局计数器completedTasks来追踪完成的任务数。
  * - 使用条件变量cv和互斥锁mtx_task来同步线程完成的通知。
  */
-void getElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int tid);
+template<typename SkipListType>
+void getElement(std::unique_ptr<SkipListType> &skipList, int tid);
 
 /**
  * @brief 使用线程池进行跳表的并发插入性能测试。
  * 
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 要测试的跳表的智能指针。
  * @details
  * 本函数使用ThreadPool类来管理并发插入任务，测试跳表的插入性能。
@@ -231,11 +219,13 @@ void getElement(std::unique_ptr<SkipList<int, std::string>> &skipList, int tid);
  * - 如果读取配置失败或配置项缺失，函数将不执行测试并输出错误信息。
  * - 函数结束前会打印出总耗时和每秒插入次数（QPS）。
  */
-void insert_test_threadpool(std::unique_ptr<SkipList<int, std::string>> &skipList);
+template<typename SkipListType>
+void insert_test_threadpool(std::unique_ptr<SkipListType> &skipList);
 
 /**
  * @brief 使用标准库多线程进行跳表的并发插入性能测试。
  * 
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 要测试的跳表的智能指针。
  * @details
  * 本函数使用std::thread进行跳表的并发插入测试，以评估插入操作的性能。
@@ -258,11 +248,13 @@ void insert_test_threadpool(std::unique_ptr<SkipList<int, std::string>> &skipLis
  * - 如果读取配置失败或配置项缺失，函数将不执行测试并输出错误信息。
  * - 函数结束前会打印出总耗时和每秒插入次数（QPS）。
  */
-void insert_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipList);
+template<typename SkipListType>
+void insert_test_multithread(std::unique_ptr<SkipListType> &skipList);
 
 /**
  * @brief 使用CTPL线程池库进行跳表插入性能测试。
  * 
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 要测试的跳表的智能指针。
  * @details
  * 本函数旨在通过CTPL线程池并发地向跳表中插入元素，以评估插入操作的性能。
@@ -285,11 +277,13 @@ void insert_test_multithread(std::unique_ptr<SkipList<int, std::string>>& skipLi
  * - 如果读取配置失败或配置项缺失，函数将不执行测试并输出错误信息。
  * - 函数结束前会打印出总耗时和每秒插入次数（QPS）。
  */
-void insert_test_ctpl(std::unique_ptr<SkipList<int, std::string>> &skipList);
+template<typename SkipListType>
+void insert_test_ctpl(std::unique_ptr<SkipListType> &skipList);
 
 /**
  * @brief 使用线程池进行跳表的并发搜索性能测试。
  *
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 要测试的跳表的智能指针。
  * @details
  * 本函数使用自定义的ThreadPool类来管理并发搜索任务，测试跳表的搜索性能。
@@ -313,11 +307,13 @@ void insert_test_ctpl(std::unique_ptr<SkipList<int, std::string>> &skipList);
  * - 使用std::condition_variable等待所有线程池任务完成。
  * - 函数执行结束前，会输出总耗时和每秒查询次数（QPS）。
  */
-void search_test_threadpool(std::unique_ptr<SkipList<int, std::string>> &skipList);
+template<typename SkipListType>
+void search_test_threadpool(std::unique_ptr<SkipListType> &skipList);
 
 /**
  * @brief 使用多线程进行跳表搜索性能测试。
  *
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 要进行测试的跳表智能指针引用。
  * @details
  * 本函数使用标准库中的多线程进行跳表的并发搜索测试，并可选地使用进度条显示搜索进度。
@@ -340,11 +336,13 @@ void search_test_threadpool(std::unique_ptr<SkipList<int, std::string>> &skipLis
  * - 函数结束前会输出所有任务的执行时间和性能指标。
  * - THREAD_NUM和TEST_DATANUM需要在外部定义，并确保它们有合理的值。
  */
-void search_test_multithread(std::unique_ptr<SkipList<int, std::string>> &skipList);
+template<typename SkipListType>
+void search_test_multithread(std::unique_ptr<SkipListType> &skipList);
 
 /**
  * @brief 使用CTPL线程池进行跳表搜索性能测试。
  *
+ * @tparam SkipListType 被测跳表类型，SkipList 或 ConcurrentSkipList。
  * @param skipList 要进行测试的跳表智能指针引用。
  * @details
  * 本函数使用CTPL线程池库对跳表进行并发搜索测试，并可选地使用进度条显示搜索进度。
@@ -366,7 +364,8 @@ void search_test_multithread(std::unique_ptr<SkipList<int, std::string>> &skipLi
  * - 使用std::mutex确保进度条更新操作的线程安全。
  * - 函数结束前会输出所有任务的执行时间和性能指标。
  */
-void search_test_ctpl(std::unique_ptr<SkipList<int, std::string>> &skipList);
+template<typename SkipListType>
+void search_test_ctpl(std::unique_ptr<SkipListType> &skipList);
 
 /**
  * @brief 演示跳表的常规使用方法。
@@ -0,0 +1,371 @@
+#ifndef KVENGINE_BLOOM_FILTER_H
+#define KVENGINE_BLOOM_FILTER_H
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+/**
+ * @file bloom_filter.h
+ * @brief 按缓存行分块的计数布隆过滤器，用于在下降之前排除不存在的键。
+ *
+ * 过滤器由若干 64 字节的块组成，每块 128 个 4 位计数器。一个键只落在一个块内：
+ * 哈希值的高位选块，低位给出块内的 k 个计数器，因此一次判定只访问一条缓存行。
+ * 计数器代替位，删除键时把计数器减一，不需要重建过滤器；计数器加到 15 后不再变化，
+ * 只会多出假阳性，不会产生假阴性。
+ *
+ * 并发约定与哈希索引一致：
+ * - 加入、删除与清空只在跳表的写锁内进行，同一时刻只有一个写者；
+ * - 判定不加锁，计数器按 64 位字原子读写，写者以 release 语义发布，读者以 acquire 语义读取；
+ * - 写者先加入键再把节点链入跳表，先摘除节点再删除键，读者能找到的键一定能通过过滤器。
+ */
+
+/**
+ * @brief 过滤器的统计信息
+ *
+ * 只统计不存在的键：命中的查询不更新任何计数器，过滤器对命中路径没有额外开销。
+ */
+struct BloomFilterStats
+{
+    uint64_t negatives = 0;         // 过滤器判定不存在、跳过下降的查询数
+    uint64_t false_positives = 0;   // 过滤器判定可能存在、下降后未找到的查询数
+    size_t memory_bytes = 0;        // 计数器占用的字节数
+    int hash_count = 0;             // 每个键的计数器数
+
+    /**
+     * @brief 实测假阳性率：不存在的键中未被过滤器排除的比例
+     */
+    double false_positive_rate() const
+    {
+        uint64_t absent = negatives + false_positives;
+        return absent == 0 ? 0.0 : static_cast<double>(false_positives) / static_cast<double>(absent);
+    }
+};
+
+/**
+ * @brief 按缓存行分块的计数布隆过滤器
+ *
+ * 过滤器只接受 64 位哈希值，键的哈希由调用者计算，过滤器本身与键的类型无关。
+ */
+class CountingBloomFilter
+{
+public:
+    static constexpr size_t kBlockBytes = 64;                           // 每块字节数，一条缓存行
+    static constexpr size_t kWordsPerBlock = kBlockBytes / 8;           // 每块的 64 位字数
+    static constexpr size_t kCountersPerBlock = kBlockBytes * 8 / 4;    // 每块计数器数
+    static constexpr int kMaxHashCount = 8;                             // 64 位哈希最多给出 8 个 7 位的块内下标
+
+    /**
+     * @param block_count 块数，至少为 1
+     * @param hash_count 每个键的计数器数，取值 [1, kMaxHashCount]
+     */
+    CountingBloomFilter(size_t block_count, int hash_count);
+
+    CountingBloomFilter(const CountingBloomFilter &) = delete;
+    CountingBloomFilter &operator=(const CountingBloomFilter &) = delete;
+
+    /**
+     * @brief 按预期键数计算块数
+     *
+     * @param expected_keys 预期键数
+     * @param counters_per_key 每个键分摊的计数器数，10 个时假阳性率约 1%
+     */
+    static size_t blocks_for(size_t expected_keys, size_t counters_per_key);
+
+    /**
+     * @brief 按每个键分摊的计数器数计算最优的计数器数 k = counters_per_key * ln2
+     */
+    static int hashes_for(size_t counters_per_key);
+
+    /**
+     * @brief 判断哈希值对应的键是否可能存在，可与写者并发
+     *
+     * @return false 时键一定不存在
+     */
+    bool may_contain(uint64_t hash) const;
+
+    /**
+     * @brief 加入一个键
+     */
+    void add(uint64_t hash);
+
+    /**
+     * @brief 删除一个键，调用者保证它之前被加入过
+     */
+    void remove(uint64_t hash);
+
+    /**
+     * @brief 清空所有计数器，块数不变
+     */
+    void clear();
+
+    /**
+     * @brief 记录一次被过滤器排除的查询
+     */
+    void record_negative();
+
+    /**
+     * @brief 记录一次假阳性：过滤器判定可能存在，但键不存在
+     */
+    void record_false_positive();
+
+    /**
+     * @brief 获取统计信息
+     */
+    BloomFilterStats stats() const;
+
+    size_t block_count() const;
+    int hash_count() const;
+
+    /**
+     * @brief 将计数器编码追加到 out，格式为 [u32 计数器数 k][u32 保留][u64 块数][块数据]
+     */
+    void encode(std::string &out) const;
+
+    /**
+     * @brief 从 encode 写出的字节恢复过滤器
+     *
+     * @return 格式不合法时返回空指针
+     */
+    static std::unique_ptr<CountingBloomFilter> decode(const char *data, size_t size);
+
+private:
+    struct alignas(kBlockBytes) Block
+    {
+        std::atomic<uint64_t> words[kWordsPerBlock];
+    };
+
+    // 统计计数器按线程分散到不同缓存行，并发查询不争用同一行
+    static constexpr size_t kStatStripes = 16;
+    struct alignas(kBlockBytes) StatStripe
+    {
+        std::atomic<uint64_t> negatives{0};
+        std::atomic<uint64_t> false_positives{0};
+    };
+    static size_t stripe_index();
+
+    // 打散调用者的哈希值，整数键的恒等哈希也能均匀地选块和选计数器
+    static uint64_t mix(uint64_t hash);
+
+    // 哈希值对应的块
+    const Block &block_of(uint64_t mixed) const;
+    Block &block_of(uint64_t mixed);
+
+    // 第 i 个计数器的块内下标
+    static size_t counter_index(uint64_t mixed, int i);
+
+    std::unique_ptr<Block[]> _blocks;
+    size_t _block_count;
+    int _hash_count;
+    StatStripe _stats[kStatStripes];
+};
+
+inline CountingBloomFilter::CountingBloomFilter(size_t block_count, int hash_count)
+    : _block_count(block_count == 0 ? 1 : block_count)
+{
+    _hash_count = hash_count < 1 ? 1 : (hash_count > kMaxHashCount ? kMaxHashCount : hash_count);
+    _blocks.reset(new Block[_block_count]);
+    clear();
+}
+
+inline size_t CountingBloomFilter::blocks_for(size_t expected_keys, size_t counters_per_key)
+{
+    if (counters_per_key == 0)
+    {
+        counters_per_key = 1;
+    }
+    return (expected_keys * counters_per_key + kCountersPerBlock - 1) / kCountersPerBlock;
+}
+
+inline int CountingBloomFilter::hashes_for(size_t counters_per_key)
+{
+    int k = static_cast<int>(std::lround(static_cast<double>(counters_per_key) * 0.6931471805599453));
+    return k < 1 ? 1 : (k > kMaxHashCount ? kMaxHashCount : k);
+}
+
+//  同一个字可能被读取多次，块已在缓存中，重复读取的开销可以忽略
+inline bool CountingBloomFilter::may_contain(uint64_t hash) const
+{
+    uint64_t mixed = mix(hash);
+    const Block &block = block_of(mixed);
+    for (int i = 0; i < _hash_count; i++)
+    {
+        size_t c = counter_index(mixed, i);
+        uint64_t word = block.words[c / 16].load(std::memory_order_acquire);
+        if (((word >> ((c % 16) * 4)) & 0xF) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//  只有一个写者，读-改-写不需要原子指令；已饱和的计数器不再加一
+inline void CountingBloomFilter::add(uint64_t hash)
+{
+    uint64_t mixed = mix(hash);
+    Block &block = block_of(mixed);
+    for (int i = 0; i < _hash_count; i++)
+    {
+        size_t c = counter_index(mixed, i);
+        std::atomic<uint64_t> &slot = block.words[c / 16];
+        uint64_t word = slot.load(std::memory_order_relaxed);
+        int shift = static_cast<int>(c % 16) * 4;
+        if (((word >> shift) & 0xF) != 0xF)
+        {
+            slot.store(word + (1ULL << shift), std::memory_order_release);
+        }
+    }
+}
+
+//  饱和的计数器不知道真实的次数，保持不变，避免减到 0 造成假阴性
+inline void CountingBloomFilter::remove(uint64_t hash)
+{
+    uint64_t mixed = mix(hash);
+    Block &block = block_of(mixed);
+    for (int i = 0; i < _hash_count; i++)
+    {
+        size_t c = counter_index(mixed, i);
+        std::atomic<uint64_t> &slot = block.words[c / 16];
+        uint64_t word = slot.load(std::memory_order_relaxed);
+        int shift = static_cast<int>(c % 16) * 4;
+        uint64_t counter = (word >> shift) & 0xF;
+        if (counter != 0 && counter != 0xF)
+        {
+            slot.store(word - (1ULL << shift), std::memory_order_release);
+        }
+    }
+}
+
+inline void CountingBloomFilter::clear()
+{
+    for (size_t b = 0; b < _block_count; b++)
+    {
+        for (auto &word : _blocks[b].words)
+        {
+            word.store(0, std::memory_order_release);
+        }
+    }
+}
+
+inline void CountingBloomFilter::record_negative()
+{
+    _stats[stripe_index()].negatives.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void CountingBloomFilter::record_false_positive()
+{
+    _stats[stripe_index()].false_positives.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline BloomFilterStats CountingBloomFilter::stats() const
+{
+    BloomFilterStats stats;
+    for (const StatStripe &stripe : _stats)
+    {
+        stats.negatives += stripe.negatives.load(std::memory_order_relaxed);
+        stats.false_positives += stripe.false_positives.load(std::memory_order_relaxed);
+    }
+    stats.memory_bytes = _block_count * kBlockBytes;
+    stats.hash_count = _hash_count;
+    return stats;
+}
+
+inline size_t CountingBloomFilter::block_count() const
+{
+    return _block_count;
+}
+
+inline int CountingBloomFilter::hash_count() const
+{
+    return _hash_count;
+}
+
+inline void CountingBloomFilter::encode(std::string &out) const
+{
+    uint32_t k = static_cast<uint32_t>(_hash_count);
+    uint32_t reserved = 0;
+    uint64_t blocks = _block_count;
+    out.append(reinterpret_cast<const char *>(&k), sizeof(k));
+    out.append(reinterpret_cast<const char *>(&reserved), sizeof(reserved));
+    out.append(reinterpret_cast<const char *>(&blocks), sizeof(blocks));
+    for (size_t b = 0; b < _block_count; b++)
+    {
+        for (const auto &word : _blocks[b].words)
+        {
+            uint64_t value = word.load(std::memory_order_relaxed);
+            out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+    }
+}
+
+inline std::unique_ptr<CountingBloomFilter> CountingBloomFilter::decode(const char *data, size_t size)
+{
+    uint32_t k;
+    uint64_t blocks;
+    if (size < 16)
+    {
+        return nullptr;
+    }
+    std::memcpy(&k, data, sizeof(k));
+    std::memcpy(&blocks, data + 8, sizeof(blocks));
+    if (k < 1 || k > kMaxHashCount || blocks == 0 || (size - 16) / kBlockBytes != blocks || (size - 16) % kBlockBytes != 0)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<CountingBloomFilter> filter(new CountingBloomFilter(static_cast<size_t>(blocks), static_cast<int>(k)));
+    const char *p = data + 16;
+    for (size_t b = 0; b < filter->_block_count; b++)
+    {
+        for (auto &word : filter->_blocks[b].words)
+        {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            word.store(value, std::memory_order_relaxed);
+            p += sizeof(value);
+        }
+    }
+    return filter;
+}
+
+inline size_t CountingBloomFilter::stripe_index()
+{
+    static std::atomic<size_t> next{0};
+    thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % kStatStripes;
+    return index;
+}
+
+inline uint64_t CountingBloomFilter::mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+//  高 32 位乘以块数取高位选块，块数不必是 2 的幂
+inline const CountingBloomFilter::Block &CountingBloomFilter::block_of(uint64_t mixed) const
+{
+    return _blocks[static_cast<size_t>(((mixed >> 32) * static_cast<uint64_t>(_block_count)) >> 32)];
+}
+
+inline CountingBloomFilter::Block &CountingBloomFilter::block_of(uint64_t mixed)
+{
+    return _blocks[static_cast<size_t>(((mixed >> 32) * static_cast<uint64_t>(_block_count)) >> 32)];
+}
+
+//  选块用掉了高 32 位，块内下标从再次打散的哈希中每次取 7 位
+inline size_t CountingBloomFilter::counter_index(uint64_t mixed, int i)
+{
+    uint64_t h = mixed * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>((h >> (7 * i)) & (kCountersPerBlock - 1));
+}
+
+#endif // KVENGINE_BLOOM_FILTER_H
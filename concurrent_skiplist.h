@@ -0,0 +1,548 @@
+#ifndef KVENGINE_CONCURRENT_SKIPLIST_H
+#define KVENGINE_CONCURRENT_SKIPLIST_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "epoch.h"
+#include "level_generator.h"
+#include "logMod.h"
+
+/**
+ * @brief 无锁跳表节点
+ *
+ * forward 数组中保存的是带删除标记的指针：最低位为 1 表示该层已被逻辑删除。
+ * 值通过原子指针保存，更新时整体替换并延迟回收旧值，保证读者读取到的值始终完整。
+ *
+ * @tparam K 键的类型
+ * @tparam V 值的类型
+ */
+template<typename K, typename V>
+class ConcurrentNode
+{
+public:
+    ConcurrentNode(const K &k, V *v, int level)
+        : key(k), value(v), node_level(level), fully_linked(false)
+    {
+        forward = new std::atomic<uintptr_t>[level + 1];
+        for (int i = 0; i <= level; i++)
+        {
+            forward[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~ConcurrentNode()
+    {
+        delete value.load(std::memory_order_relaxed);
+        delete []forward;
+    }
+
+    // 取出标记指针中的节点地址
+    static ConcurrentNode *pointer_of(uintptr_t word)
+    {
+        return reinterpret_cast<ConcurrentNode *>(word & ~static_cast<uintptr_t>(1));
+    }
+
+    // 判断标记指针是否带删除标记
+    static bool is_marked(uintptr_t word)
+    {
+        return (word & 1) != 0;
+    }
+
+    // 将节点地址与删除标记打包为一个字
+    static uintptr_t pack(ConcurrentNode *node, bool marked)
+    {
+        return reinterpret_cast<uintptr_t>(node) | (marked ? 1 : 0);
+    }
+
+    K key;                              // 节点的键
+    std::atomic<V *> value;             // 节点的值，整体替换
+    int node_level;                     // 节点所在层
+    std::atomic<bool> fully_linked;     // 插入者是否已完成所有层的链接
+    std::atomic<uintptr_t> *forward;    // 带删除标记的后继指针数组
+};
+
+/**
+ * @brief 无锁并发跳表
+ *
+ * 与 SkipList 提供相同的增删改查接口，但不依赖全局互斥锁：
+ * - 各层链接通过 CAS 修改，删除时先在 forward 指针上打逻辑删除标记，再由后续遍历物理摘除；
+ * - 被摘除的节点和被替换的旧值通过 EpochDomain 延迟回收，读者不会访问已释放的内存。
+ *
+ * 写入操作可以随核数扩展，适合与 SkipList 在 benchmark 中对比。
+ *
+ * @tparam K 键的类型，需要支持 < 和 == 比较
+ * @tparam V 值的类型
+ */
+template<typename K, typename V>
+class ConcurrentSkipList
+{
+public:
+    using NodeType = ConcurrentNode<K, V>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param max_level 跳表的最大层级数
+     * @param level_probability 节点晋升到上一层的概率，默认 1/2
+     */
+    explicit ConcurrentSkipList(int max_level, double level_probability = LevelGenerator::kHalf);
+
+    /**
+     * @brief 析构函数，释放所有节点以及挂起的退休对象
+     *
+     * @note 析构时不能有其他线程仍在访问该跳表。
+     */
+    ~ConcurrentSkipList();
+
+    ConcurrentSkipList(const ConcurrentSkipList &) = delete;
+    ConcurrentSkipList &operator=(const ConcurrentSkipList &) = delete;
+
+    /**
+     * @brief 插入键值对
+     *
+     * @param key 要插入的键
+     * @param value 要插入的值
+     * @return 插入成功返回 0；键已存在返回 1
+     */
+    int insert_element(K key, V value);
+
+    /**
+     * @brief 修改指定键的值
+     *
+     * 新值整体替换旧值，旧值延迟回收，并发读者要么看到旧值要么看到新值。
+     *
+     * @return 键存在且修改成功返回 true，否则返回 false
+     */
+    bool update_element(K key, V value);
+
+    /**
+     * @brief 搜索指定键是否存在
+     */
+    bool search_element(K key);
+
+    /**
+     * @brief 查找元素并拷贝出它的值
+     *
+     * 与 SkipList::search_element_value 不同，这里不返回指向节点内部的指针：
+     * 并发删除可能随时回收节点，返回指针无法保证有效，因此在临界区内把值拷贝给调用者。
+     *
+     * @param key 要查找的键
+     * @param value 找到时写入对应的值
+     * @return 找到返回 true，否则返回 false
+     */
+    bool search_element_value(K key, V &value);
+
+    /**
+     * @brief 删除指定键
+     *
+     * @return 本线程成功删除该键返回 true；键不存在或已被其他线程删除返回 false
+     */
+    bool delete_element(K key);
+
+    /**
+     * @brief 打印每一层的键值对
+     *
+     * @note 仅用于调试，并发修改时输出可能不是某一时刻的快照。
+     */
+    void display_list();
+
+    /**
+     * @brief 返回跳表中元素的数量
+     */
+    int size();
+
+    /**
+     * @brief 清空跳表
+     *
+     * @note 调用期间不能有其他线程访问该跳表。
+     */
+    void clear();
+
+    /**
+     * @brief 获取随机层级
+     */
+    int get_random_level();
+
+private:
+    // 查找 key 在每一层的前驱和后继，顺带摘除沿途已被标记删除的节点；当前层级之上的层前驱为头节点、后继为空
+    bool find(const K &key, NodeType **preds, NodeType **succs);
+
+    // 在所有层摘除键不大于 key 的已标记节点，保证删除者退休节点时节点已不可达
+    void unlink_marked(const K &key);
+
+    // 退休回调：释放节点
+    static void free_node(void *node, void *);
+
+    // 退休回调：释放被替换的旧值
+    static void free_value(void *value, void *);
+
+    int _max_level;                         // 跳表最大层级数
+    LevelGenerator _level_generator;        // 随机层级生成器(线程局部随机源，无需加锁)
+    std::atomic<int> _skip_list_level;      // 跳表当前层级数(只增不减)，插入者先提升层级再链接节点
+    NodeType *_header;                      // 头节点
+    std::atomic<int> _element_count;        // 元素数量
+    EpochDomain _epoch;                     // 延迟回收域
+};
+
+template<typename K, typename V>
+ConcurrentSkipList<K, V>::ConcurrentSkipList(int max_level, double level_probability)
+    : _max_level(max_level), _level_generator(max_level, level_probability),
+      _skip_list_level(0), _element_count(0)
+{
+    _header = new NodeType(K(), nullptr, _max_level);
+}
+
+template<typename K, typename V>
+ConcurrentSkipList<K, V>::~ConcurrentSkipList()
+{
+    LOG_INFO << "Destroying concurrent skiplist";
+    clear();
+    delete _header;
+}
+
+template<typename K, typename V>
+void ConcurrentSkipList<K, V>::free_node(void *node, void *)
+{
+    delete static_cast<NodeType *>(node);
+}
+
+template<typename K, typename V>
+void ConcurrentSkipList<K, V>::free_value(void *value, void *)
+{
+    delete static_cast<V *>(value);
+}
+
+template<typename K, typename V>
+int ConcurrentSkipList<K, V>::get_random_level()
+{
+    return _level_generator.generate();
+}
+
+template<typename K, typename V>
+bool ConcurrentSkipList<K, V>::find(const K &key, NodeType **preds, NodeType **succs)
+{
+retry:
+    NodeType *pred = _header;
+    int top = _skip_list_level.load(std::memory_order_acquire);
+    for (int i = _max_level; i > top; i--)
+    {
+        preds[i] = _header;
+        succs[i] = nullptr;
+    }
+    for (int i = top; i >= 0; i--)
+    {
+        NodeType *curr = NodeType::pointer_of(pred->forward[i].load(std::memory_order_acquire));
+        while (curr != nullptr)
+        {
+            uintptr_t succ_word = curr->forward[i].load(std::memory_order_acquire);
+            // curr 在本层已被标记删除，尝试把它从本层摘除
+            while (NodeType::is_marked(succ_word))
+            {
+                uintptr_t expected = NodeType::pack(curr, false);
+                if (!pred->forward[i].compare_exchange_strong(expected,
+                        NodeType::pack(NodeType::pointer_of(succ_word), false),
+                        std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    goto retry;     // 前驱已变化或自身被标记，从头重来
+                }
+                curr = NodeType::pointer_of(succ_word);
+                if (curr == nullptr)
+                {
+                    break;
+                }
+                succ_word = curr->forward[i].load(std::memory_order_acquire);
+            }
+            if (curr != nullptr && curr->key < key)
+            {
+                pred = curr;
+                curr = NodeType::pointer_of(succ_word);
+            }
+            else
+            {
+                break;
+            }
+        }
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+    return succs[0] != nullptr && succs[0]->key == key;
+}
+
+template<typename K, typename V>
+void ConcurrentSkipList<K, V>::unlink_marked(const K &key)
+{
+retry:
+    NodeType *pred = _header;
+    for (int i = _skip_list_level.load(std::memory_order_acquire); i >= 0; i--)
+    {
+        NodeType *curr = NodeType::pointer_of(pred->forward[i].load(std::memory_order_acquire));
+        // 与 find 不同，这里继续越过等于 key 的节点，确保同键的已删除节点也被摘除
+        while (curr != nullptr && !(key < curr->key))
+        {
+            uintptr_t succ_word = curr->forward[i].load(std::memory_order_acquire);
+            if (NodeType::is_marked(succ_word))
+            {
+                uintptr_t expected = NodeType::pack(curr, false);
+                if (!pred->forward[i].compare_exchange_strong(expected,
+                        NodeType::pack(NodeType::pointer_of(succ_word), false),
+                        std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    goto retry;
+                }
+            }
+            else
+            {
+                pred = curr;
+            }
+            curr = NodeType::pointer_of(succ_word);
+        }
+    }
+}
+
+template<typename K, typename V>
+int ConcurrentSkipList<K, V>::insert_element(K key, V value)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+
+    while (true)
+    {
+        if (find(key, preds, succs))
+        {
+            return 1;   // 元素已在跳表中
+        }
+
+        int top_level = get_random_level();
+        // 先提升跳表层级再链接：遍历从当前层级开始，看到高层链接的线程也必然看到提升后的层级
+        int level = _skip_list_level.load(std::memory_order_relaxed);
+        while (top_level > level && !_skip_list_level.compare_exchange_weak(level, top_level))
+        {
+        }
+
+        NodeType *inserted_node = new NodeType(key, new V(value), top_level);
+        for (int i = 0; i <= top_level; i++)
+        {
+            inserted_node->forward[i].store(NodeType::pack(succs[i], false), std::memory_order_relaxed);
+        }
+
+        // 第 0 层链接成功即视为插入完成(线性化点)
+        uintptr_t expected = NodeType::pack(succs[0], false);
+        if (!preds[0]->forward[0].compare_exchange_strong(expected, NodeType::pack(inserted_node, false),
+                std::memory_order_release, std::memory_order_acquire))
+        {
+            delete inserted_node;   // 尚未发布，可以直接释放
+            continue;
+        }
+        _element_count.fetch_add(1, std::memory_order_relaxed);
+
+        // 逐层向上链接
+        for (int i = 1; i <= top_level; i++)
+        {
+            while (true)
+            {
+                // 先把自身第 i 层指向新的后继；若已被打上删除标记则放弃更高层的链接
+                uintptr_t own = inserted_node->forward[i].load(std::memory_order_acquire);
+                if (NodeType::is_marked(own))
+                {
+                    goto done;
+                }
+                if (NodeType::pointer_of(own) != succs[i] &&
+                    !inserted_node->forward[i].compare_exchange_strong(own, NodeType::pack(succs[i], false),
+                        std::memory_order_release, std::memory_order_acquire))
+                {
+                    goto done;  // CAS 失败只可能是被标记
+                }
+                uintptr_t pred_expected = NodeType::pack(succs[i], false);
+                if (preds[i]->forward[i].compare_exchange_strong(pred_expected, NodeType::pack(inserted_node, false),
+                        std::memory_order_release, std::memory_order_acquire))
+                {
+                    break;
+                }
+                find(key, preds, succs);
+                if (succs[0] != inserted_node)
+                {
+                    goto done;  // 节点已被删除并摘除，不再继续链接
+                }
+            }
+        }
+
+    done:
+        inserted_node->fully_linked.store(true, std::memory_order_release);
+        return 0;
+    }
+}
+
+template<typename K, typename V>
+bool ConcurrentSkipList<K, V>::update_element(K key, V value)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+
+    if (!find(key, preds, succs))
+    {
+        return false;
+    }
+    V *old_value = succs[0]->value.exchange(new V(value), std::memory_order_acq_rel);
+    _epoch.retire(old_value, &ConcurrentSkipList::free_value, nullptr);
+    return true;
+}
+
+template<typename K, typename V>
+bool ConcurrentSkipList<K, V>::search_element(K key)
+{
+    auto guard = _epoch.guard();
+    NodeType *pred = _header;
+    NodeType *curr = nullptr;
+
+    // 读路径不做摘除，只跳过已标记的节点
+    for (int i = _skip_list_level.load(std::memory_order_acquire); i >= 0; i--)
+    {
+        curr = NodeType::pointer_of(pred->forward[i].load(std::memory_order_acquire));
+        while (curr != nullptr)
+        {
+            uintptr_t succ_word = curr->forward[i].load(std::memory_order_acquire);
+            if (NodeType::is_marked(succ_word))
+            {
+                curr = NodeType::pointer_of(succ_word);
+                continue;
+            }
+            if (curr->key < key)
+            {
+                pred = curr;
+                curr = NodeType::pointer_of(succ_word);
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+    return curr != nullptr && curr->key == key;
+}
+
+template<typename K, typename V>
+bool ConcurrentSkipList<K, V>::search_element_value(K key, V &value)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+
+    if (!find(key, preds, succs))
+    {
+        return false;
+    }
+    value = *succs[0]->value.load(std::memory_order_acquire);
+    return true;
+}
+
+template<typename K, typename V>
+bool ConcurrentSkipList<K, V>::delete_element(K key)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+
+    if (!find(key, preds, succs))
+    {
+        return false;
+    }
+    NodeType *victim = succs[0];
+
+    // 自顶向下为每一层打上删除标记
+    for (int i = victim->node_level; i >= 1; i--)
+    {
+        uintptr_t word = victim->forward[i].load(std::memory_order_acquire);
+        while (!NodeType::is_marked(word))
+        {
+            victim->forward[i].compare_exchange_weak(word, word | 1,
+                    std::memory_order_acq_rel, std::memory_order_acquire);
+        }
+    }
+
+    // 第 0 层的标记决定由哪个线程完成删除
+    uintptr_t word = victim->forward[0].load(std::memory_order_acquire);
+    while (true)
+    {
+        if (NodeType::is_marked(word))
+        {
+            return false;   // 其他线程已经删除
+        }
+        if (victim->forward[0].compare_exchange_weak(word, word | 1,
+                std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            break;
+        }
+    }
+
+    // 等待插入者结束链接，否则它可能在摘除之后又把节点挂回某一层
+    while (!victim->fully_linked.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    unlink_marked(key);
+    _element_count.fetch_sub(1, std::memory_order_relaxed);
+    _epoch.retire(victim, &ConcurrentSkipList::free_node, nullptr);
+    return true;
+}
+
+template<typename K, typename V>
+void ConcurrentSkipList<K, V>::display_list()
+{
+    auto guard = _epoch.guard();
+    std::cout << "***** Concurrent Skip List *****" << '\n';
+    for (int level = _skip_list_level.load(); level >= 0; --level)
+    {
+        std::ostringstream oss;
+        oss << "Level " << level << ": ";
+        uintptr_t word = _header->forward[level].load(std::memory_order_acquire);
+        NodeType *node = NodeType::pointer_of(word);
+        while (node != nullptr)
+        {
+            uintptr_t next = node->forward[level].load(std::memory_order_acquire);
+            if (!NodeType::is_marked(next))
+            {
+                oss << "|" << node->key << ":" << *node->value.load(std::memory_order_acquire) << " ";
+            }
+            node = NodeType::pointer_of(next);
+        }
+        oss << "|";
+        std::cout << oss.str() << '\n';
+    }
+}
+
+template<typename K, typename V>
+int ConcurrentSkipList<K, V>::size()
+{
+    return _element_count.load(std::memory_order_relaxed);
+}
+
+template<typename K, typename V>
+void ConcurrentSkipList<K, V>::clear()
+{
+    LOG_INFO << "Starting ConcurrentSkipList clear operation.";
+    NodeType *current = NodeType::pointer_of(_header->forward[0].load(std::memory_order_acquire));
+    while (current != nullptr)
+    {
+        NodeType *next = NodeType::pointer_of(current->forward[0].load(std::memory_order_relaxed));
+        delete current;
+        current = next;
+    }
+    for (int i = 0; i <= _max_level; i++)
+    {
+        _header->forward[i].store(0, std::memory_order_relaxed);
+    }
+    _skip_list_level.store(0);
+    _element_count.store(0);
+    _epoch.drain();     // 已退休的节点不在链表中，单独回收
+    LOG_INFO << "ConcurrentSkipList cleared successfully.";
+}
+
+#endif // KVENGINE_CONCURRENT_SKIPLIST_H
@@ -0,0 +1,470 @@
+#ifndef KVENGINE_DELTA_SNAPSHOT_H
+#define KVENGINE_DELTA_SNAPSHOT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "logMod.h"
+#include "snapshot.h"
+#include "wal.h"
+
+/**
+ * @file delta_snapshot.h
+ * @brief 增量快照：一个完整的基准快照加上一串只记录变化的增量文件。
+ *
+ * 文件组织(path 为调用者给出的路径)：
+ * - path                               清单，记录当前链的编号，替换清单即提交新链
+ * - path.<链编号>.base                  基准快照，格式与 save_snapshot 相同
+ * - path.<链编号>.<序号>.delta           第 1、2、... 个增量，序号连续
+ *
+ * 增量文件布局(小端序)：
+ * - DeltaHeader                        固定 64 字节的文件头
+ * - 区间墓碑 × ranges                   [起始键字段][结束键字段]，删除闭区间内的所有键
+ * - 单键记录 × entries                  [u8 类型][键字段][值字段(仅更新)]，按键递增排列
+ *
+ * 应用顺序：带有清空标志时先清空，再删除各区间，最后逐键更新或删除。变更日志在记录区间删除时
+ * 已丢弃区间内更早的单键记录，因此留下的单键记录都晚于所有区间墓碑，按这个顺序应用与原操作顺序等价。
+ *
+ * 链编号写在文件名中：压缩(写新的基准)时换一条新链，旧链残留的增量不会被误用到新基准上。
+ */
+
+constexpr char kIncrementalManifestMagic[8] = {'K', 'V', 'I', 'N', 'C', 'R', '0', '1'};
+constexpr char kDeltaMagic[8] = {'K', 'V', 'D', 'E', 'L', 'T', 'A', '1'};
+constexpr uint32_t kDeltaVersion = 1;
+constexpr uint32_t kDeltaCleared = 1;   // DeltaHeader::flags：应用前先清空
+
+/**
+ * @brief 增量快照清单
+ */
+struct IncrementalManifest
+{
+    char magic[8];          // 文件标识 "KVINCR01"
+    uint32_t version;       // 格式版本
+    uint32_t reserved;      // 保留，写 0
+    uint64_t chain;         // 当前链编号，从 1 开始
+    uint64_t checksum;      // 前 24 字节的 FNV-1a 64 位哈希
+};
+
+static_assert(sizeof(IncrementalManifest) == 32, "IncrementalManifest must be packed to 32 bytes");
+
+/**
+ * @brief 增量文件头
+ */
+struct DeltaHeader
+{
+    char magic[8];          // 文件标识 "KVDELTA1"
+    uint32_t version;       // 格式版本
+    uint32_t flags;         // kDeltaCleared
+    uint64_t chain;         // 所属链编号
+    uint64_t sequence;      // 在链中的序号，从 1 开始
+    uint64_t ranges;        // 区间墓碑数
+    uint64_t entries;       // 单键记录数(更新与墓碑)
+    uint64_t payload_bytes; // 记录区总字节数
+    uint64_t checksum;      // 记录区的 FNV-1a 64 位哈希
+};
+
+static_assert(sizeof(DeltaHeader) == 64, "DeltaHeader must be packed to 64 bytes");
+
+/**
+ * @brief 单键记录的类型
+ */
+enum class DeltaEntryType : uint8_t
+{
+    Upsert = 1,     // 插入或更新为记录中的值
+    Tombstone = 2   // 删除
+};
+
+/**
+ * @brief 增量文件的路径
+ */
+inline std::string delta_base_path(const std::string &path, uint64_t chain)
+{
+    return path + "." + std::to_string(chain) + ".base";
+}
+
+inline std::string delta_file_path(const std::string &path, uint64_t chain, uint64_t sequence)
+{
+    return path + "." + std::to_string(chain) + "." + std::to_string(sequence) + ".delta";
+}
+
+/**
+ * @brief 先写入 file_name.tmp 再替换 file_name，写到一半失败不会破坏已有文件
+ */
+inline bool write_file_replacing(const std::string &file_name, const std::string &data)
+{
+    const std::string tmp_file_name = file_name + ".tmp";
+    std::ofstream ofs(tmp_file_name, std::ios::binary | std::ios::trunc);
+    ofs.write(data.data(), data.size());
+    ofs.close();
+    if (!ofs)
+    {
+        LOG_ERROR << "Error: Failed to write " << tmp_file_name;
+        std::cerr << "Error: Failed to write " << tmp_file_name << std::endl;
+        std::remove(tmp_file_name.c_str());
+        return false;
+    }
+
+    //  Windows 下 rename 不能覆盖已有文件，先删除旧文件
+    std::remove(file_name.c_str());
+    if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0)
+    {
+        LOG_ERROR << "Error: Cannot rename " << tmp_file_name << " to " << file_name;
+        std::cerr << "Error: Cannot rename " << tmp_file_name << " to " << file_name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 删除 path 下除 keep_chain 之外所有链的基准与增量文件(包括写到一半的 .tmp)
+ *
+ * 压缩在提交新清单后调用；进程在提交与清理之间退出时留下的旧链也在下一次压缩时一并删除。
+ */
+inline void remove_delta_files(const std::string &path, uint64_t keep_chain)
+{
+    std::filesystem::path base(path);
+    std::filesystem::path dir = base.parent_path().empty() ? std::filesystem::path(".") : base.parent_path();
+    std::string prefix = base.filename().string() + ".";
+    std::vector<std::filesystem::path> obsolete;
+    std::error_code ec;
+    for (auto &entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        //  文件名形如 <prefix><链编号>.base 或 <prefix><链编号>.<序号>.delta，其后可能还有 .tmp
+        std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0)
+        {
+            continue;
+        }
+        std::string suffix = name.substr(prefix.size());
+        size_t dot = suffix.find('.');
+        if (dot == 0 || dot == std::string::npos || suffix.find_first_not_of("0123456789") != dot)
+        {
+            continue;
+        }
+        std::string kind = suffix.substr(dot + 1);
+        size_t kind_dot = kind.find('.');
+        bool is_base = kind.compare(0, 4, "base") == 0 && (kind.size() == 4 || kind.compare(4, std::string::npos, ".tmp") == 0);
+        bool is_delta = kind_dot != 0 && kind_dot != std::string::npos && kind.find_first_not_of("0123456789") == kind_dot
+            && (kind.compare(kind_dot, std::string::npos, ".delta") == 0 || kind.compare(kind_dot, std::string::npos, ".delta.tmp") == 0);
+        if ((is_base || is_delta) && std::stoull(suffix.substr(0, dot)) != keep_chain)
+        {
+            obsolete.push_back(entry.path());
+        }
+    }
+    for (const auto &file : obsolete)
+    {
+        std::filesystem::remove(file, ec);
+    }
+}
+
+/**
+ * @brief 编码清单
+ */
+inline std::string encode_incremental_manifest(uint64_t chain)
+{
+    IncrementalManifest manifest = {};
+    std::memcpy(manifest.magic, kIncrementalManifestMagic, sizeof(manifest.magic));
+    manifest.version = kDeltaVersion;
+    manifest.chain = chain;
+    manifest.checksum = fnv1a64(&manifest, offsetof(IncrementalManifest, checksum));
+    return std::string(reinterpret_cast<const char *>(&manifest), sizeof(manifest));
+}
+
+/**
+ * @brief 解码清单
+ *
+ * @return uint64_t 当前链编号；格式不符或校验失败时返回 0
+ */
+inline uint64_t decode_incremental_manifest(const char *data, size_t size)
+{
+    IncrementalManifest manifest;
+    if (size != sizeof(manifest))
+    {
+        return 0;
+    }
+    std::memcpy(&manifest, data, sizeof(manifest));
+    if (std::memcmp(manifest.magic, kIncrementalManifestMagic, sizeof(manifest.magic)) != 0 || manifest.version != kDeltaVersion
+        || fnv1a64(&manifest, offsetof(IncrementalManifest, checksum)) != manifest.checksum)
+    {
+        return 0;
+    }
+    return manifest.chain;
+}
+
+/**
+ * @brief 一个增量文件解码后的内容
+ */
+template<typename K, typename V>
+struct DeltaContents
+{
+    bool cleared = false;
+    std::vector<std::pair<K, K>> ranges;                    // 区间墓碑，闭区间
+    std::vector<std::pair<K, std::optional<V>>> entries;    // 单键记录，值为空表示墓碑
+};
+
+/**
+ * @brief 解码增量文件
+ *
+ * @param chain 期望的链编号
+ * @param sequence 期望的序号
+ * @return bool 格式不符、校验失败或链编号/序号不一致时返回 false
+ */
+template<typename K, typename V>
+bool decode_delta(const char *data, size_t size, uint64_t chain, uint64_t sequence, DeltaContents<K, V> &contents)
+{
+    DeltaHeader header;
+    if (size < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    const char *cursor = data + sizeof(header);
+    const char *end = data + size;
+    if (std::memcmp(header.magic, kDeltaMagic, sizeof(header.magic)) != 0 || header.version != kDeltaVersion
+        || header.chain != chain || header.sequence != sequence || header.payload_bytes != size - sizeof(header)
+        || fnv1a64(cursor, static_cast<size_t>(header.payload_bytes)) != header.checksum)
+    {
+        return false;
+    }
+
+    contents.cleared = (header.flags & kDeltaCleared) != 0;
+    contents.ranges.clear();
+    contents.entries.clear();
+    for (uint64_t i = 0; i < header.ranges; i++)
+    {
+        std::pair<K, K> range;
+        if (!read_snapshot_field(cursor, end, range.first) || !read_snapshot_field(cursor, end, range.second))
+        {
+            return false;
+        }
+        contents.ranges.push_back(std::move(range));
+    }
+    for (uint64_t i = 0; i < header.entries; i++)
+    {
+        if (cursor == end)
+        {
+            return false;
+        }
+        DeltaEntryType type = static_cast<DeltaEntryType>(*cursor++);
+        std::pair<K, std::optional<V>> entry;
+        if (!read_snapshot_field(cursor, end, entry.first))
+        {
+            return false;
+        }
+        if (type == DeltaEntryType::Upsert)
+        {
+            entry.second.emplace();
+            if (!read_snapshot_field(cursor, end, *entry.second))
+            {
+                return false;
+            }
+        }
+        else if (type != DeltaEntryType::Tombstone)
+        {
+            return false;
+        }
+        contents.entries.push_back(std::move(entry));
+    }
+    return cursor == end;
+}
+
+/**
+ * @brief 变更日志：记录上一次保存之后每个键的最终状态
+ *
+ * 与预写日志不同，同一个键的多次修改只保留最后一次，保存增量时的开销只与被修改的键数有关。
+ * 跳表在写锁内通过 record() 记录每个生效的写操作，保存时在写锁内整体换出。
+ *
+ * @tparam K 键的类型
+ * @tparam V 值的类型
+ * @tparam Compare 键的比较器，与跳表相同
+ */
+template<typename K, typename V, typename Compare = std::less<>>
+class ChangeLog
+{
+public:
+    /**
+     * @brief 记录一个写操作，参数与 WriteAheadLog::append 相同
+     */
+    void record(WalOp op, const K *key, const V *value, const K *end_key);
+
+    /**
+     * @brief 自上次换出以来是否没有任何变化
+     */
+    bool empty() const
+    {
+        return !_cleared && _ranges.empty() && _entries.empty();
+    }
+
+    /**
+     * @brief 单键记录数
+     */
+    size_t size() const
+    {
+        return _entries.size();
+    }
+
+    void clear()
+    {
+        _cleared = false;
+        _ranges.clear();
+        _entries.clear();
+    }
+
+    /**
+     * @brief 编码为一个完整的增量文件(文件头 + 记录区)
+     */
+    void encode(uint64_t chain, uint64_t sequence, std::string &out) const;
+
+    /**
+     * @brief 把记录的变化应用到按键递增的基准记录上，结果按键递增追加到 out
+     *
+     * 记录过清空时忽略基准；落在区间墓碑内或有单键记录的基准记录被丢弃，单键记录中的写入按键归并进结果。
+     * 值从日志中移出，调用后日志被清空。
+     *
+     * @tparam InputIt 元素形如 std::pair<K, V> 的输入迭代器，键严格递增
+     */
+    template<typename InputIt>
+    void apply_to(InputIt first, InputIt last, std::vector<std::pair<K, V>> &out);
+
+private:
+    bool _cleared = false;                          // 期间执行过清空
+    std::vector<std::pair<K, K>> _ranges;           // 区间墓碑，闭区间
+    std::map<K, std::optional<V>, Compare> _entries; // 每个键的最终状态，值为空表示墓碑
+};
+
+template<typename K, typename V, typename Compare>
+void ChangeLog<K, V, Compare>::record(WalOp op, const K *key, const V *value, const K *end_key)
+{
+    switch (op)
+    {
+        case WalOp::Insert:
+        case WalOp::Update:
+            _entries.insert_or_assign(*key, *value);
+            break;
+        case WalOp::Delete:
+            _entries.insert_or_assign(*key, std::nullopt);
+            break;
+        case WalOp::DeleteRange:
+            //  区间内更早的单键记录被这次删除覆盖
+            _entries.erase(_entries.lower_bound(*key), _entries.upper_bound(*end_key));
+            _ranges.emplace_back(*key, *end_key);
+            break;
+        case WalOp::Clear:
+            //  清空之前的变化都不再需要
+            _ranges.clear();
+            _entries.clear();
+            _cleared = true;
+            break;
+    }
+}
+
+template<typename K, typename V, typename Compare>
+void ChangeLog<K, V, Compare>::encode(uint64_t chain, uint64_t sequence, std::string &out) const
+{
+    size_t header_pos = out.size();
+    out.append(sizeof(DeltaHeader), '\0');  //  文件头占位，编码后回填
+
+    for (const auto &range : _ranges)
+    {
+        append_snapshot_field(range.first, out);
+        append_snapshot_field(range.second, out);
+    }
+    for (const auto &entry : _entries)
+    {
+        out.push_back(static_cast<char>(entry.second ? DeltaEntryType::Upsert : DeltaEntryType::Tombstone));
+        append_snapshot_field(entry.first, out);
+        if (entry.second)
+        {
+            append_snapshot_field(*entry.second, out);
+        }
+    }
+
+    DeltaHeader header = {};
+    std::memcpy(header.magic, kDeltaMagic, sizeof(header.magic));
+    header.version = kDeltaVersion;
+    header.flags = _cleared ? kDeltaCleared : 0;
+    header.chain = chain;
+    header.sequence = sequence;
+    header.ranges = _ranges.size();
+    header.entries = _entries.size();
+    header.payload_bytes = out.size() - header_pos - sizeof(header);
+    header.checksum = fnv1a64(out.data() + header_pos + sizeof(header), static_cast<size_t>(header.payload_bytes));
+    std::memcpy(&out[header_pos], &header, sizeof(header));
+}
+
+template<typename K, typename V, typename Compare>
+template<typename InputIt>
+void ChangeLog<K, V, Compare>::apply_to(InputIt first, InputIt last, std::vector<std::pair<K, V>> &out)
+{
+    auto less = _entries.key_comp();
+
+    //  区间按起点排序并合并重叠的部分，基准记录按键递增，顺序扫描即可判断是否落在某个区间内
+    std::sort(_ranges.begin(), _ranges.end(), [&less](const std::pair<K, K> &a, const std::pair<K, K> &b) {
+        return less(a.first, b.first);
+    });
+    std::vector<std::pair<K, K>> ranges;
+    for (auto &range : _ranges)
+    {
+        if (!ranges.empty() && !less(ranges.back().second, range.first))
+        {
+            if (less(ranges.back().second, range.second))
+            {
+                ranges.back().second = std::move(range.second);
+            }
+        }
+        else
+        {
+            ranges.push_back(std::move(range));
+        }
+    }
+
+    auto entry = _entries.begin();
+    size_t r = 0;
+    for (; !_cleared && first != last; ++first)
+    {
+        const K &key = first->first;
+        for (; entry != _entries.end() && less(entry->first, key); ++entry)
+        {
+            if (entry->second)
+            {
+                out.emplace_back(entry->first, std::move(*entry->second));
+            }
+        }
+        if (entry != _entries.end() && !less(key, entry->first))
+        {
+            continue;   //  单键记录覆盖基准，由上面的循环写出
+        }
+        while (r < ranges.size() && less(ranges[r].second, key))
+        {
+            r++;
+        }
+        if (r < ranges.size() && !less(key, ranges[r].first))
+        {
+            continue;
+        }
+        out.emplace_back(first->first, first->second);
+    }
+    for (; entry != _entries.end(); ++entry)
+    {
+        if (entry->second)
+        {
+            out.emplace_back(entry->first, std::move(*entry->second));
+        }
+    }
+    clear();
+}
+
+#endif // KVENGINE_DELTA_SNAPSHOT_H
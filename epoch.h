@@ -0,0 +1,339 @@
+#ifndef KVENGINE_EPOCH_H
+#define KVENGINE_EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @file epoch.h
+ * @brief 基于纪元(Epoch)的内存回收。
+ *
+ * 无锁读路径上，读者可能仍停留在一个刚被写者摘除的节点上，此时不能立即 delete。
+ * EpochDomain 为每个线程维护一个本地纪元，读者进入临界区时登记当前全局纪元，
+ * 写者摘除节点后调用 retire() 将其挂入本线程的待回收列表。只有当全局纪元比退休时的纪元
+ * 前进两次以上，说明所有可能看到该节点的读者都已离开，才真正释放内存。
+ */
+
+namespace epoch_detail {
+
+constexpr int kMaxThreads = 256;    // 同时参与纪元回收的最大线程数
+
+/**
+ * @brief 全局线程编号分配器
+ *
+ * 为每个线程分配一个 [0, kMaxThreads) 内的编号，线程退出时归还编号供新线程复用。
+ * 编号在所有 EpochDomain 之间共享，每个域按编号直接索引自己的槽位。
+ */
+class ThreadIndexRegistry
+{
+public:
+    static ThreadIndexRegistry &instance()
+    {
+        static ThreadIndexRegistry registry;
+        return registry;
+    }
+
+    int acquire()
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        if (!_free.empty())
+        {
+            int index = _free.back();
+            _free.pop_back();
+            return index;
+        }
+        if (_next >= kMaxThreads)
+        {
+            throw std::runtime_error("epoch: too many threads registered");
+        }
+        int index = _next++;
+        _high_water.store(_next, std::memory_order_release);
+        return index;
+    }
+
+    void release(int index)
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _free.push_back(index);
+    }
+
+    // 曾经分配出去的最大编号+1，扫描槽位时只需要扫描到这里
+    int high_water() const
+    {
+        return _high_water.load(std::memory_order_acquire);
+    }
+
+private:
+    std::mutex _mtx;
+    std::vector<int> _free;
+    int _next = 0;
+    std::atomic<int> _high_water{0};
+};
+
+// 线程局部的编号持有者，析构时归还编号
+struct ThreadIndexHolder
+{
+    int index;
+    ThreadIndexHolder() : index(ThreadIndexRegistry::instance().acquire()) {}
+    ~ThreadIndexHolder() { ThreadIndexRegistry::instance().release(index); }
+};
+
+inline int current_thread_index()
+{
+    thread_local ThreadIndexHolder holder;
+    return holder.index;
+}
+
+} // namespace epoch_detail
+
+/**
+ * @brief 纪元回收域
+ *
+ * 每个需要延迟回收的数据结构持有一个 EpochDomain。读者通过 guard() 获得一个 RAII 守卫，
+ * 写者通过 retire() 提交待释放的对象。
+ *
+ * @note
+ * - 守卫可以嵌套，只有最外层守卫会登记/注销纪元。
+ * - retire() 挂入的是当前线程的待回收列表，只有该线程(或持有独占写权的 drain())会释放它们。
+ * - 析构前必须保证没有线程仍持有该域的守卫。
+ */
+class EpochDomain
+{
+public:
+    using Deleter = void (*)(void *object, void *context);
+
+    /**
+     * @brief 读临界区守卫
+     *
+     * 构造时进入临界区，析构时离开。守卫存活期间读到的节点不会被释放。
+     */
+    class Guard
+    {
+    public:
+        explicit Guard(EpochDomain *domain) : _domain(domain)
+        {
+            if (_domain) _domain->enter();
+        }
+        Guard(Guard &&other) noexcept : _domain(other._domain) { other._domain = nullptr; }
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+        Guard &operator=(Guard &&) = delete;
+        ~Guard()
+        {
+            if (_domain) _domain->leave();
+        }
+
+    private:
+        EpochDomain *_domain;
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    ~EpochDomain()
+    {
+        reclaim_all();
+    }
+
+    /**
+     * @brief 进入读临界区
+     *
+     * @return Guard 离开作用域时自动退出临界区
+     */
+    Guard guard()
+    {
+        return Guard(this);
+    }
+
+    /**
+     * @brief 提交一个已从数据结构中摘除的对象，等到安全时再释放
+     *
+     * @param object 待释放的对象
+     * @param deleter 释放函数，回收时以 deleter(object, context) 调用
+     * @param context 传给释放函数的上下文，例如节点所属的分配器
+     */
+    void retire(void *object, Deleter deleter, void *context)
+    {
+        Slot &slot = _slots[epoch_detail::current_thread_index()];
+        slot.limbo.push_back({object, deleter, context, _global_epoch.load(std::memory_order_acquire)});
+        if (slot.limbo.size() % kCollectInterval == 0)
+        {
+            try_advance();
+            collect(slot, _global_epoch.load(std::memory_order_acquire));
+        }
+    }
+
+    /**
+     * @brief 等待当前所有读者离开临界区，并释放本线程已满足条件的退休对象
+     *
+     * @note 调用线程自身不能持有该域的守卫，否则会永远等待。
+     */
+    void synchronize()
+    {
+        wait_for_readers();
+        collect(_slots[epoch_detail::current_thread_index()], _global_epoch.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief 等待调用时刻已在临界区内的读者全部离开，不释放任何退休对象
+     *
+     * 返回后，调用之前摘除的对象不会再被任何读者访问，调用者可以直接释放它们。
+     * 只读写原子变量，可以在不持有写锁时与 retire()/drain() 并发调用。
+     *
+     * @note 调用线程自身不能持有该域的守卫，否则会永远等待。
+     */
+    void wait_for_readers()
+    {
+        uint64_t target = _global_epoch.load(std::memory_order_acquire) + 2;
+        while (_global_epoch.load(std::memory_order_acquire) < target)
+        {
+            if (!try_advance())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * @brief 有限次尝试地等待调用时刻已在临界区内的读者全部离开
+     *
+     * 与 wait_for_readers() 相同，但读者迟迟不离开时放弃而不是一直等待。持有写锁时只能用这个版本：
+     * 持有守卫的线程可能正在等待同一把写锁。
+     *
+     * @param attempts 推进全局纪元的最多尝试次数，每次失败后让出时间片
+     * @return bool 读者都已离开返回 true，放弃时返回 false
+     */
+    bool try_wait_for_readers(int attempts)
+    {
+        uint64_t target = _global_epoch.load(std::memory_order_acquire) + 2;
+        for (int i = 0; _global_epoch.load(std::memory_order_acquire) < target; i++)
+        {
+            if (i == attempts)
+            {
+                return false;
+            }
+            if (!try_advance())
+            {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 当前线程是否持有该域的守卫
+     */
+    bool in_critical_section()
+    {
+        return _slots[epoch_detail::current_thread_index()].nesting > 0;
+    }
+
+    /**
+     * @brief 等待所有读者离开后释放所有线程挂起的退休对象
+     *
+     * 供 clear()/析构等持有独占写权限的路径使用：调用期间不能有其他线程并发 retire()。
+     */
+    void drain()
+    {
+        synchronize();
+        reclaim_all();
+    }
+
+    /**
+     * @brief 无条件释放所有挂起的对象
+     *
+     * @note 仅在确认没有任何读者和写者时调用(例如析构)。
+     */
+    void reclaim_all()
+    {
+        int high = epoch_detail::ThreadIndexRegistry::instance().high_water();
+        for (int i = 0; i < high; ++i)
+        {
+            collect(_slots[i], std::numeric_limits<uint64_t>::max());
+        }
+    }
+
+private:
+    static constexpr uint64_t kIdle = std::numeric_limits<uint64_t>::max(); // 槽位不在临界区
+    static constexpr size_t kCollectInterval = 64;                         // 每退休多少对象尝试回收一次
+
+    struct Retired
+    {
+        void *object;
+        Deleter deleter;
+        void *context;
+        uint64_t epoch;
+    };
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{kIdle};
+        int nesting = 0;
+        std::vector<Retired> limbo;
+    };
+
+    void enter()
+    {
+        Slot &slot = _slots[epoch_detail::current_thread_index()];
+        if (slot.nesting++ == 0)
+        {
+            // seq_cst 写入保证登记对回收者可见之后才会读取共享指针
+            slot.epoch.store(_global_epoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+        }
+    }
+
+    void leave()
+    {
+        Slot &slot = _slots[epoch_detail::current_thread_index()];
+        if (--slot.nesting == 0)
+        {
+            slot.epoch.store(kIdle, std::memory_order_release);
+        }
+    }
+
+    // 所有活跃读者都已观察到当前全局纪元时，将全局纪元加一
+    bool try_advance()
+    {
+        uint64_t current = _global_epoch.load(std::memory_order_seq_cst);
+        int high = epoch_detail::ThreadIndexRegistry::instance().high_water();
+        for (int i = 0; i < high; ++i)
+        {
+            uint64_t e = _slots[i].epoch.load(std::memory_order_seq_cst);
+            if (e != kIdle && e != current)
+            {
+                return false;
+            }
+        }
+        return _global_epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+    }
+
+    // 释放槽位中退休纪元至少落后 global_epoch 两个纪元的对象
+    static void collect(Slot &slot, uint64_t global_epoch)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < slot.limbo.size(); ++i)
+        {
+            Retired &r = slot.limbo[i];
+            if (global_epoch == std::numeric_limits<uint64_t>::max() || r.epoch + 2 <= global_epoch)
+            {
+                r.deleter(r.object, r.context);
+            }
+            else
+            {
+                slot.limbo[kept++] = r;
+            }
+        }
+        slot.limbo.resize(kept);
+    }
+
+    std::atomic<uint64_t> _global_epoch{0};
+    Slot _slots[epoch_detail::kMaxThreads];
+};
+
+#endif // KVENGINE_EPOCH_H
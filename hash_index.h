@@ -0,0 +1,369 @@
+#ifndef KVENGINE_HASH_INDEX_H
+#define KVENGINE_HASH_INDEX_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#include "epoch.h"
+
+/**
+ * @file hash_index.h
+ * @brief 跳表节点的开放寻址哈希索引。
+ *
+ * 索引把键映射到跳表节点指针，跳表仍然是唯一保存数据的有序结构，索引只是旁路：
+ * 精确查找先在索引中线性探测，命中后直接访问节点，不再自顶向下逐层比较。
+ *
+ * 并发约定与跳表一致：
+ * - 插入、删除、替换与扩容只在跳表的写锁内进行，同一时刻只有一个写者；
+ * - 查找不加锁，槽位是原子指针，写者以 release 语义发布，读者以 acquire 语义读取；
+ * - 删除的槽位改为墓碑而不是清空，正在探测的读者不会因此提前结束探测；
+ * - 扩容或清理墓碑时构建新表并原子替换，旧表交给 EpochDomain 延迟释放，仍在旧表上探测的读者不受影响。
+ */
+
+namespace hash_index_detail {
+
+/**
+ * @brief 计算查找键的哈希值
+ *
+ * K 为 std::string 且查找键可以视为 std::string_view 时按 string_view 计算(标准保证两者哈希值相同)，
+ * 查找字面量或 string_view 时不构造临时字符串；哈希函数不接受查找键时先转换为 K。
+ */
+template<typename K, typename Hash, typename Key>
+size_t hash_key(const Hash &hash, const Key &key)
+{
+    if constexpr (std::is_same<Hash, std::hash<std::string>>::value && std::is_convertible<const Key &, std::string_view>::value)
+    {
+        return std::hash<std::string_view>()(std::string_view(key));
+    }
+    else if constexpr (std::is_invocable<const Hash &, const Key &>::value)
+    {
+        return hash(key);
+    }
+    else
+    {
+        return hash(K(key));
+    }
+}
+
+} // namespace hash_index_detail
+
+/**
+ * @brief 跳表节点的开放寻址哈希索引
+ *
+ * @tparam K 键的类型
+ * @tparam NodeT 节点类型，需要提供 const K &get_key() const
+ * @tparam Hash 键的哈希函数
+ */
+template<typename K, typename NodeT, typename Hash = std::hash<K>>
+class NodeHashIndex
+{
+public:
+    /**
+     * @param epoch 旧表的延迟回收域；为空时旧表立即释放，只适用于读写不会并发的场景
+     */
+    explicit NodeHashIndex(EpochDomain *epoch);
+    ~NodeHashIndex();
+
+    NodeHashIndex(const NodeHashIndex &) = delete;
+    NodeHashIndex &operator=(const NodeHashIndex &) = delete;
+
+    /**
+     * @brief 查找键对应的节点，可与写者并发
+     *
+     * @tparam Equal 可调用对象，形如 bool(const NodeT *node, const Key &key)，判断节点的键是否与 key 等价
+     * @return NodeT* 找不到时返回 nullptr
+     *
+     * @note 调用者需要持有回收域的守卫，守卫存活期间返回的节点与探测过的表不会被释放。
+     */
+    template<typename Key, typename Equal>
+    NodeT *find(const Key &key, Equal equal) const;
+
+    /**
+     * @brief 预取键所在的探测起点
+     *
+     * 批量查找时先为一组键发出预取，再逐个探测，使多个缓存未命中同时在途。
+     */
+    template<typename Key>
+    void prefetch(const Key &key) const;
+
+    /**
+     * @brief 登记新节点，调用者保证索引中没有等价的键
+     */
+    void insert(NodeT *node);
+
+    /**
+     * @brief 删除节点的登记
+     */
+    void erase(const NodeT *node);
+
+    /**
+     * @brief 把 old_node 的登记改为 new_node(写时复制替换节点时使用)
+     */
+    void replace(const NodeT *old_node, NodeT *new_node);
+
+    /**
+     * @brief 清空索引，容量不变
+     */
+    void clear();
+
+    /**
+     * @brief 登记的节点数
+     */
+    size_t size() const;
+
+    /**
+     * @brief 槽位数
+     */
+    size_t capacity() const;
+
+private:
+    struct Table
+    {
+        size_t mask;    // 槽位数 - 1，槽位数为 2 的幂
+        int shift;      // 64 - log2(槽位数)，乘法散列取高位
+        std::atomic<NodeT *> *slots;
+    };
+
+    static constexpr size_t kMinCapacity = 16;
+
+    // 墓碑：已删除的槽位，探测时跳过但不终止
+    static NodeT *tombstone()
+    {
+        static char marker;
+        return reinterpret_cast<NodeT *>(&marker);
+    }
+
+    static Table *create_table(size_t capacity);
+    static void free_table(void *table, void *context);
+
+    // 探测起点：哈希值再乘以黄金分割常数取高位，避免整数键的恒等哈希在低位聚集
+    template<typename Key>
+    static size_t bucket(const Table *table, const Key &key);
+
+    // 按 live 个元素重建，装载率保持在 1/2 以下，同时清除墓碑
+    void rebuild(size_t live);
+
+    // 查找指向 node 的槽位
+    std::atomic<NodeT *> *slot_of(const NodeT *node) const;
+
+    std::atomic<Table *> _table;
+    EpochDomain *_epoch;
+    size_t _size;       // 登记的节点数
+    size_t _used;       // 非空槽位数(节点 + 墓碑)
+};
+
+template<typename K, typename NodeT, typename Hash>
+NodeHashIndex<K, NodeT, Hash>::NodeHashIndex(EpochDomain *epoch)
+    : _table(create_table(kMinCapacity)), _epoch(epoch), _size(0), _used(0)
+{
+}
+
+template<typename K, typename NodeT, typename Hash>
+NodeHashIndex<K, NodeT, Hash>::~NodeHashIndex()
+{
+    free_table(_table.load(std::memory_order_relaxed), nullptr);
+}
+
+template<typename K, typename NodeT, typename Hash>
+template<typename Key, typename Equal>
+NodeT *NodeHashIndex<K, NodeT, Hash>::find(const Key &key, Equal equal) const
+{
+    const Table *table = _table.load(std::memory_order_acquire);
+    for (size_t i = bucket(table, key);; i = (i + 1) & table->mask)
+    {
+        NodeT *node = table->slots[i].load(std::memory_order_acquire);
+        if (node == nullptr)
+        {
+            return nullptr;
+        }
+        if (node != tombstone() && equal(node, key))
+        {
+            return node;
+        }
+    }
+}
+
+template<typename K, typename NodeT, typename Hash>
+template<typename Key>
+void NodeHashIndex<K, NodeT, Hash>::prefetch(const Key &key) const
+{
+    const Table *table = _table.load(std::memory_order_acquire);
+#if defined(_MSC_VER)
+    _mm_prefetch(reinterpret_cast<const char *>(&table->slots[bucket(table, key)]), _MM_HINT_T0);
+#else
+    __builtin_prefetch(&table->slots[bucket(table, key)], 0, 3);
+#endif
+}
+
+//  装载率(含墓碑)超过 3/4 时先重建，表中始终留有空槽，探测一定会终止
+template<typename K, typename NodeT, typename Hash>
+void NodeHashIndex<K, NodeT, Hash>::insert(NodeT *node)
+{
+    Table *table = _table.load(std::memory_order_relaxed);
+    if ((_used + 1) * 4 > (table->mask + 1) * 3)
+    {
+        rebuild(_size + 1);
+        table = _table.load(std::memory_order_relaxed);
+    }
+
+    //  新键可以复用墓碑：读者若已越过该墓碑，只会看不到这个正在插入的键
+    size_t i = bucket(table, node->get_key());
+    NodeT *current = table->slots[i].load(std::memory_order_relaxed);
+    while (current != nullptr && current != tombstone())
+    {
+        i = (i + 1) & table->mask;
+        current = table->slots[i].load(std::memory_order_relaxed);
+    }
+    if (current == nullptr)
+    {
+        _used++;
+    }
+    table->slots[i].store(node, std::memory_order_release);
+    _size++;
+}
+
+template<typename K, typename NodeT, typename Hash>
+void NodeHashIndex<K, NodeT, Hash>::erase(const NodeT *node)
+{
+    std::atomic<NodeT *> *slot = slot_of(node);
+    if (slot != nullptr)
+    {
+        slot->store(tombstone(), std::memory_order_release);
+        _size--;
+    }
+}
+
+template<typename K, typename NodeT, typename Hash>
+void NodeHashIndex<K, NodeT, Hash>::replace(const NodeT *old_node, NodeT *new_node)
+{
+    std::atomic<NodeT *> *slot = slot_of(old_node);
+    if (slot != nullptr)
+    {
+        slot->store(new_node, std::memory_order_release);
+    }
+}
+
+template<typename K, typename NodeT, typename Hash>
+void NodeHashIndex<K, NodeT, Hash>::clear()
+{
+    Table *table = _table.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= table->mask; i++)
+    {
+        table->slots[i].store(nullptr, std::memory_order_release);
+    }
+    _size = 0;
+    _used = 0;
+}
+
+template<typename K, typename NodeT, typename Hash>
+size_t NodeHashIndex<K, NodeT, Hash>::size() const
+{
+    return _size;
+}
+
+template<typename K, typename NodeT, typename Hash>
+size_t NodeHashIndex<K, NodeT, Hash>::capacity() const
+{
+    return _table.load(std::memory_order_relaxed)->mask + 1;
+}
+
+template<typename K, typename NodeT, typename Hash>
+typename NodeHashIndex<K, NodeT, Hash>::Table *NodeHashIndex<K, NodeT, Hash>::create_table(size_t capacity)
+{
+    Table *table = new Table;
+    table->mask = capacity - 1;
+    table->shift = 64;
+    for (size_t c = capacity; c > 1; c >>= 1)
+    {
+        table->shift--;
+    }
+    table->slots = new std::atomic<NodeT *>[capacity];
+    for (size_t i = 0; i < capacity; i++)
+    {
+        table->slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+    return table;
+}
+
+template<typename K, typename NodeT, typename Hash>
+void NodeHashIndex<K, NodeT, Hash>::free_table(void *table, void *)
+{
+    Table *t = static_cast<Table *>(table);
+    delete[] t->slots;
+    delete t;
+}
+
+template<typename K, typename NodeT, typename Hash>
+template<typename Key>
+size_t NodeHashIndex<K, NodeT, Hash>::bucket(const Table *table, const Key &key)
+{
+    uint64_t h = static_cast<uint64_t>(hash_index_detail::hash_key<K>(Hash(), key));
+    return static_cast<size_t>((h * 0x9E3779B97F4A7C15ULL) >> table->shift) & table->mask;
+}
+
+//  新表在发布之前完整填好，读者要么在旧表上、要么在新表上探测，两张表都包含所有登记的节点
+template<typename K, typename NodeT, typename Hash>
+void NodeHashIndex<K, NodeT, Hash>::rebuild(size_t live)
+{
+    size_t capacity = kMinCapacity;
+    while (capacity < live * 2)
+    {
+        capacity <<= 1;
+    }
+
+    Table *old_table = _table.load(std::memory_order_relaxed);
+    Table *new_table = create_table(capacity);
+    for (size_t i = 0; i <= old_table->mask; i++)
+    {
+        NodeT *node = old_table->slots[i].load(std::memory_order_relaxed);
+        if (node == nullptr || node == tombstone())
+        {
+            continue;
+        }
+        size_t j = bucket(new_table, node->get_key());
+        while (new_table->slots[j].load(std::memory_order_relaxed) != nullptr)
+        {
+            j = (j + 1) & new_table->mask;
+        }
+        new_table->slots[j].store(node, std::memory_order_relaxed);
+    }
+    _used = _size;
+    _table.store(new_table, std::memory_order_release);
+
+    if (_epoch != nullptr)
+    {
+        _epoch->retire(old_table, &NodeHashIndex::free_table, nullptr);
+    }
+    else
+    {
+        free_table(old_table, nullptr);
+    }
+}
+
+template<typename K, typename NodeT, typename Hash>
+std::atomic<NodeT *> *NodeHashIndex<K, NodeT, Hash>::slot_of(const NodeT *node) const
+{
+    Table *table = _table.load(std::memory_order_relaxed);
+    for (size_t i = bucket(table, node->get_key());; i = (i + 1) & table->mask)
+    {
+        NodeT *current = table->slots[i].load(std::memory_order_relaxed);
+        if (current == nullptr)
+        {
+            return nullptr;
+        }
+        if (current == node)
+        {
+            return &table->slots[i];
+        }
+    }
+}
+
+#endif // KVENGINE_HASH_INDEX_H
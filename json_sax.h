@@ -0,0 +1,357 @@
+#ifndef KVENGINE_JSON_SAX_H
+#define KVENGINE_JSON_SAX_H
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/* 引入RapidJSON库头文件 */
+#include <reader.h>
+
+/**
+ * @file json_sax.h
+ * @brief 键值对 JSON 数组的流式(SAX)解析。
+ *
+ * save_to_json 写出的文件形如 [{"key":1,"value":"a"},...]。这里用 rapidjson::Reader 逐个事件解析，
+ * 每解析完一个元素就把键值对交给调用者，不构建 rapidjson::Document，内存占用与文件大小无关。
+ *
+ * 配合写时复制映射的 MappedFile 使用原地解析：字符串直接在映射的内存中反转义，不再复制到解析器的缓冲区。
+ */
+
+/**
+ * @brief 有边界的原地解析输入流
+ *
+ * 与 rapidjson::InsituStringStream 相同，区别是读到 end 时返回 '\0' 而不是继续读取，
+ * 文件末尾不需要额外的 '\0'，截断的文件也不会越过映射的范围。
+ */
+class BoundedInsituStream
+{
+public:
+    typedef char Ch;
+
+    BoundedInsituStream(Ch *begin, size_t size) : _src(begin), _dst(nullptr), _head(begin), _end(begin + size) {}
+
+    // 读
+    Ch Peek() const { return _src < _end ? *_src : '\0'; }
+    Ch Take() { return _src < _end ? *_src++ : '\0'; }
+    size_t Tell() const { return static_cast<size_t>(_src - _head); }
+
+    // 原地写：写入位置始终不超过读取位置
+    void Put(Ch c) { *_dst++ = c; }
+    Ch *PutBegin() { return _dst = _src; }
+    size_t PutEnd(Ch *begin) { return static_cast<size_t>(_dst - begin); }
+    void Flush() {}
+
+private:
+    Ch *_src;
+    Ch *_dst;
+    Ch *_head;
+    Ch *_end;
+};
+
+namespace rapidjson {
+
+//  流只有几个指针，解析时复制到局部变量以便编译器放进寄存器
+template<>
+struct StreamTraits<BoundedInsituStream>
+{
+    enum { copyOptimization = 1 };
+};
+
+} // namespace rapidjson
+
+/**
+ * @brief 解析键值对数组的 SAX 处理器
+ *
+ * 元素的校验规则与之前基于 Document 的加载相同：元素必须是含 "key" 与 "value" 成员的对象，
+ * "key" 为 int，"value" 为字符串；同名成员以第一个为准，其他成员忽略。不合规的元素输出错误信息后跳过。
+ * 根不是数组时在第一个事件处停止解析。
+ *
+ * @tparam K 键的类型，需要可以由 int 构造
+ * @tparam V 值的类型，需要可以由字符串构造
+ * @tparam Sink 可调用对象，形如 void(K &&key, V &&value)，每个合规的元素调用一次
+ *
+ * @note Sink 只在元素结束(EndObject)时调用，此时输入流的位置已经越过该元素。
+ */
+template<typename K, typename V, typename Sink>
+class KeyValueArrayHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, KeyValueArrayHandler<K, V, Sink>>
+{
+public:
+    explicit KeyValueArrayHandler(Sink sink) : _sink(std::move(sink)) {}
+
+    bool Null() { return scalar(); }
+    bool Bool(bool) { return scalar(); }
+    bool Int(int i) { return integer(i); }
+    bool Uint(unsigned u) { return u <= static_cast<unsigned>(INT_MAX) ? integer(static_cast<int>(u)) : scalar(); }
+    bool Int64(int64_t) { return scalar(); }
+    bool Uint64(uint64_t) { return scalar(); }
+    bool Double(double) { return scalar(); }
+    bool String(const char *str, rapidjson::SizeType length, bool);
+    bool Key(const char *str, rapidjson::SizeType length, bool);
+    bool StartObject();
+    bool EndObject(rapidjson::SizeType);
+    bool StartArray();
+    bool EndArray(rapidjson::SizeType);
+
+    /**
+     * @brief 根是否为数组；为 false 时解析在第一个事件处被中止
+     */
+    bool root_is_array() const { return _root_is_array; }
+
+    /**
+     * @brief 已解析完的元素个数(包括被跳过的)
+     */
+    size_t elements() const { return _elements; }
+
+private:
+    enum class Member { Other, Key, Value };
+
+    // 开始一个新元素
+    void begin_element(bool is_object);
+
+    // 元素结束：校验后交给 sink 或输出错误信息
+    void finish_element();
+
+    // 标量事件与嵌套容器的开始都视为成员值；嵌套容器内部的事件忽略
+    bool scalar();
+    bool integer(int i);
+    void member_value(bool is_int, bool is_string);
+
+    Sink _sink;
+    int _depth = 0;                 // 当前嵌套深度，根数组内为 1，元素对象内为 2
+    bool _root_is_array = false;
+    size_t _elements = 0;
+
+    // 当前元素的状态
+    bool _is_object = false;
+    Member _member = Member::Other; // 当前成员名对应的字段
+    bool _has_key = false;
+    bool _has_value = false;
+    bool _key_ok = false;
+    bool _value_ok = false;
+    std::string _error;             // 转换键或值时捕获的异常信息
+    K _key{};
+    V _value{};
+};
+
+/**
+ * @brief 构造处理器，由参数推导 Sink 的类型
+ */
+template<typename K, typename V, typename Sink>
+KeyValueArrayHandler<K, V, Sink> make_key_value_handler(Sink sink)
+{
+    return KeyValueArrayHandler<K, V, Sink>(std::move(sink));
+}
+
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::String(const char *str, rapidjson::SizeType length, bool)
+{
+    if (_depth != 2)
+    {
+        return scalar();
+    }
+    bool first_value = _member == Member::Value && !_has_value;
+    member_value(false, true);
+    if (first_value)
+    {
+        try
+        {
+            if constexpr (std::is_constructible<V, const char *, size_t>::value)
+            {
+                _value = V(str, length);
+            }
+            else
+            {
+                _value = V(str);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            _value_ok = false;
+            _error = e.what();
+        }
+    }
+    return true;
+}
+
+//  同名成员以第一个为准，重复的成员按其他成员忽略
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::Key(const char *str, rapidjson::SizeType length, bool)
+{
+    if (_depth == 2)
+    {
+        if (length == 3 && std::memcmp(str, "key", 3) == 0 && !_has_key)
+        {
+            _member = Member::Key;
+        }
+        else if (length == 5 && std::memcmp(str, "value", 5) == 0 && !_has_value)
+        {
+            _member = Member::Value;
+        }
+        else
+        {
+            _member = Member::Other;
+        }
+    }
+    return true;
+}
+
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::StartObject()
+{
+    if (_depth == 0)
+    {
+        return false;   //  根不是数组
+    }
+    if (_depth == 1)
+    {
+        begin_element(true);
+    }
+    else if (_depth == 2)
+    {
+        member_value(false, false);
+    }
+    _depth++;
+    return true;
+}
+
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::EndObject(rapidjson::SizeType)
+{
+    if (--_depth == 1)
+    {
+        finish_element();
+    }
+    return true;
+}
+
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::StartArray()
+{
+    if (_depth == 0)
+    {
+        _root_is_array = true;
+    }
+    else if (_depth == 1)
+    {
+        begin_element(false);
+    }
+    else if (_depth == 2)
+    {
+        member_value(false, false);
+    }
+    _depth++;
+    return true;
+}
+
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::EndArray(rapidjson::SizeType)
+{
+    if (--_depth == 1)
+    {
+        finish_element();
+    }
+    return true;
+}
+
+template<typename K, typename V, typename Sink>
+void KeyValueArrayHandler<K, V, Sink>::begin_element(bool is_object)
+{
+    _is_object = is_object;
+    _member = Member::Other;
+    _has_key = false;
+    _has_value = false;
+    _key_ok = false;
+    _value_ok = false;
+    _error.clear();
+}
+
+template<typename K, typename V, typename Sink>
+void KeyValueArrayHandler<K, V, Sink>::finish_element()
+{
+    size_t index = _elements++;
+    if (!_is_object || !_has_key || !_has_value)
+    {
+        std::cerr << "Error: Each key-value pair must be an object with 'key' and 'value'." << std::endl;
+        return;
+    }
+    if (!_error.empty())
+    {
+        std::cerr << "Error: Exception caught while processing key-value pair at index " << index << ": " << _error << std::endl;
+        return;
+    }
+    if (!_key_ok || !_value_ok)
+    {
+        std::cerr << "Error: Key or value type mismatch in element " << index << "." << std::endl;
+        return;
+    }
+    _sink(std::move(_key), std::move(_value));
+}
+
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::scalar()
+{
+    if (_depth == 0)
+    {
+        return false;   //  根不是数组
+    }
+    if (_depth == 1)
+    {
+        begin_element(false);
+        finish_element();
+    }
+    else if (_depth == 2)
+    {
+        member_value(false, false);
+    }
+    return true;
+}
+
+template<typename K, typename V, typename Sink>
+bool KeyValueArrayHandler<K, V, Sink>::integer(int i)
+{
+    if (_depth != 2)
+    {
+        return scalar();
+    }
+    bool first_key = _member == Member::Key && !_has_key;
+    member_value(true, false);
+    if (first_key)
+    {
+        try
+        {
+            _key = K(i);
+        }
+        catch (const std::exception &e)
+        {
+            _key_ok = false;
+            _error = e.what();
+        }
+    }
+    return true;
+}
+
+//  记录当前成员的值是否为期望的类型，同一成员之后的事件都不再影响它
+template<typename K, typename V, typename Sink>
+void KeyValueArrayHandler<K, V, Sink>::member_value(bool is_int, bool is_string)
+{
+    if (_member == Member::Key)
+    {
+        _has_key = true;
+        _key_ok = is_int;
+    }
+    else if (_member == Member::Value)
+    {
+        _has_value = true;
+        _value_ok = is_string;
+    }
+    _member = Member::Other;
+}
+
+#endif // KVENGINE_JSON_SAX_H
@@ -0,0 +1,509 @@
+#ifndef KVENGINE_LAZY_SKIPLIST_H
+#define KVENGINE_LAZY_SKIPLIST_H
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "epoch.h"
+#include "level_generator.h"
+#include "lock_policy.h"
+#include "logMod.h"
+
+/**
+ * @brief 细粒度锁跳表节点
+ *
+ * 每个节点自带一把锁，只保护以该节点为前驱的链接修改以及该节点自身的删除标记。
+ * 后继指针、删除标记与链接完成标志都是原子变量，查找不加锁也能读到一致的值。
+ *
+ * @tparam K 键的类型
+ * @tparam V 值的类型
+ * @tparam NodeLock 节点锁，lock_policy.h 中的 MutexLock 或 SpinLock
+ */
+template<typename K, typename V, typename NodeLock>
+class LazyNode
+{
+public:
+    LazyNode(const K &k, V *v, int level)
+        : key(k), value(v), node_level(level), marked(false), fully_linked(false)
+    {
+        forward = new std::atomic<LazyNode *>[level + 1];
+        for (int i = 0; i <= level; i++)
+        {
+            forward[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~LazyNode()
+    {
+        delete value.load(std::memory_order_relaxed);
+        delete []forward;
+    }
+
+    K key;                                  // 节点的键
+    std::atomic<V *> value;                 // 节点的值，整体替换
+    int node_level;                         // 节点所在层
+    std::atomic<bool> marked;               // 是否已被逻辑删除，持有节点锁时设置
+    std::atomic<bool> fully_linked;         // 插入者是否已完成所有层的链接
+    std::atomic<LazyNode *> *forward;       // 后继指针数组
+    NodeLock lock;                          // 节点锁
+};
+
+/**
+ * @brief 细粒度锁并发跳表(lazy skiplist，Herlihy、Lev、Luchangco、Shavit)
+ *
+ * 与 SkipList 的单一写锁不同，写操作只锁住被修改链接的前驱节点：
+ * - 插入先无锁地找到各层前驱，自底向上锁住前驱并校验"前驱未删除、后继未删除、前驱仍指向后继"，
+ *   校验失败则解锁重试，成功则逐层链接后把节点标记为链接完成；
+ * - 删除先锁住目标节点并打上删除标记(线性化点)，再锁住各层前驱校验后自顶向下摘除；
+ * - 查找完全不加锁：找到链接完成且未标记的节点即命中。
+ * 不相交的键区间上的写操作互不阻塞。被摘除的节点和被替换的旧值通过 EpochDomain 延迟回收。
+ *
+ * 与无锁的 ConcurrentSkipList 相比，写路径用节点锁代替 CAS 重试，逻辑更简单，
+ * 在写竞争集中于少数前驱时表现不同，适合与 SkipList 的各种锁策略一起在 benchmark 中对比。
+ *
+ * @tparam K 键的类型，需要支持 < 和 == 比较
+ * @tparam V 值的类型
+ * @tparam NodeLock 节点锁，默认 TTAS 自旋锁(临界区只有几次指针读写)
+ */
+template<typename K, typename V, typename NodeLock = SpinLock>
+class LazySkipList
+{
+public:
+    using NodeType = LazyNode<K, V, NodeLock>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param max_level 跳表的最大层级数
+     * @param level_probability 节点晋升到上一层的概率，默认 1/2
+     */
+    explicit LazySkipList(int max_level, double level_probability = LevelGenerator::kHalf);
+
+    /**
+     * @brief 析构函数，释放所有节点以及挂起的退休对象
+     *
+     * @note 析构时不能有其他线程仍在访问该跳表。
+     */
+    ~LazySkipList();
+
+    LazySkipList(const LazySkipList &) = delete;
+    LazySkipList &operator=(const LazySkipList &) = delete;
+
+    /**
+     * @brief 插入键值对
+     *
+     * @param key 要插入的键
+     * @param value 要插入的值
+     * @return 插入成功返回 0；键已存在返回 1
+     */
+    int insert_element(K key, V value);
+
+    /**
+     * @brief 修改指定键的值
+     *
+     * 新值整体替换旧值，旧值延迟回收，并发读者要么看到旧值要么看到新值。
+     *
+     * @return 键存在且修改成功返回 true，否则返回 false
+     */
+    bool update_element(K key, V value);
+
+    /**
+     * @brief 搜索指定键是否存在，不加锁
+     */
+    bool search_element(K key);
+
+    /**
+     * @brief 查找元素并拷贝出它的值
+     *
+     * 与 ConcurrentSkipList 相同，并发删除可能随时回收节点，因此在临界区内把值拷贝给调用者。
+     *
+     * @param key 要查找的键
+     * @param value 找到时写入对应的值
+     * @return 找到返回 true，否则返回 false
+     */
+    bool search_element_value(K key, V &value);
+
+    /**
+     * @brief 删除指定键
+     *
+     * @return 本线程成功删除该键返回 true；键不存在或已被其他线程删除返回 false
+     */
+    bool delete_element(K key);
+
+    /**
+     * @brief 打印每一层的键值对
+     *
+     * @note 仅用于调试，并发修改时输出可能不是某一时刻的快照。
+     */
+    void display_list();
+
+    /**
+     * @brief 返回跳表中元素的数量
+     */
+    int size();
+
+    /**
+     * @brief 清空跳表
+     *
+     * @note 调用期间不能有其他线程访问该跳表。
+     */
+    void clear();
+
+    /**
+     * @brief 获取随机层级
+     */
+    int get_random_level();
+
+private:
+    // 无锁查找 key 在每一层的前驱和后继，返回找到 key 的最高层，未找到返回 -1；当前层级之上的层前驱为头节点、后继为空
+    int find(const K &key, NodeType **preds, NodeType **succs);
+
+    // 锁住第 0 到 top_level 层的前驱，同一节点只锁一次；返回锁住的最高层，用于 unlock_preds
+    int lock_preds(NodeType **preds, int top_level);
+
+    // 解锁 lock_preds 锁住的前驱
+    void unlock_preds(NodeType **preds, int highest_locked);
+
+    // 退休回调：释放节点
+    static void free_node(void *node, void *);
+
+    // 退休回调：释放被替换的旧值
+    static void free_value(void *value, void *);
+
+    int _max_level;                         // 跳表最大层级数
+    LevelGenerator _level_generator;        // 随机层级生成器(线程局部随机源，无需加锁)
+    std::atomic<int> _skip_list_level;      // 跳表当前层级数(只增不减)，插入者先提升层级再链接节点
+    NodeType *_header;                      // 头节点，不参与比较
+    std::atomic<int> _element_count;        // 元素数量
+    EpochDomain _epoch;                     // 延迟回收域
+};
+
+template<typename K, typename V, typename NodeLock>
+LazySkipList<K, V, NodeLock>::LazySkipList(int max_level, double level_probability)
+    : _max_level(max_level), _level_generator(max_level, level_probability),
+      _skip_list_level(0), _element_count(0)
+{
+    _header = new NodeType(K(), nullptr, _max_level);
+    _header->fully_linked.store(true, std::memory_order_relaxed);
+}
+
+template<typename K, typename V, typename NodeLock>
+LazySkipList<K, V, NodeLock>::~LazySkipList()
+{
+    LOG_INFO << "Destroying lazy skiplist";
+    clear();
+    delete _header;
+}
+
+template<typename K, typename V, typename NodeLock>
+void LazySkipList<K, V, NodeLock>::free_node(void *node, void *)
+{
+    delete static_cast<NodeType *>(node);
+}
+
+template<typename K, typename V, typename NodeLock>
+void LazySkipList<K, V, NodeLock>::free_value(void *value, void *)
+{
+    delete static_cast<V *>(value);
+}
+
+template<typename K, typename V, typename NodeLock>
+int LazySkipList<K, V, NodeLock>::get_random_level()
+{
+    return _level_generator.generate();
+}
+
+template<typename K, typename V, typename NodeLock>
+int LazySkipList<K, V, NodeLock>::find(const K &key, NodeType **preds, NodeType **succs)
+{
+    int found_level = -1;
+    NodeType *pred = _header;
+    int top = _skip_list_level.load(std::memory_order_acquire);
+    for (int i = _max_level; i > top; i--)
+    {
+        preds[i] = _header;
+        succs[i] = nullptr;
+    }
+    for (int i = top; i >= 0; i--)
+    {
+        NodeType *curr = pred->forward[i].load(std::memory_order_acquire);
+        while (curr != nullptr && curr->key < key)
+        {
+            pred = curr;
+            curr = pred->forward[i].load(std::memory_order_acquire);
+        }
+        if (found_level == -1 && curr != nullptr && curr->key == key)
+        {
+            found_level = i;
+        }
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+    return found_level;
+}
+
+template<typename K, typename V, typename NodeLock>
+int LazySkipList<K, V, NodeLock>::lock_preds(NodeType **preds, int top_level)
+{
+    NodeType *previous = nullptr;
+    for (int i = 0; i <= top_level; i++)
+    {
+        //  同一个前驱可能跨越多层，节点锁不可重入，只锁一次
+        if (preds[i] != previous)
+        {
+            preds[i]->lock.lock();
+            previous = preds[i];
+        }
+    }
+    return top_level;
+}
+
+template<typename K, typename V, typename NodeLock>
+void LazySkipList<K, V, NodeLock>::unlock_preds(NodeType **preds, int highest_locked)
+{
+    NodeType *previous = nullptr;
+    for (int i = 0; i <= highest_locked; i++)
+    {
+        if (preds[i] != previous)
+        {
+            preds[i]->lock.unlock();
+            previous = preds[i];
+        }
+    }
+}
+
+template<typename K, typename V, typename NodeLock>
+int LazySkipList<K, V, NodeLock>::insert_element(K key, V value)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+    int top_level = get_random_level();
+
+    //  先提升跳表层级再链接：查找从当前层级开始，看到高层链接或链接完成标志的线程也必然看到提升后的层级
+    int level = _skip_list_level.load(std::memory_order_relaxed);
+    while (top_level > level && !_skip_list_level.compare_exchange_weak(level, top_level))
+    {
+    }
+
+    while (true)
+    {
+        int found_level = find(key, preds, succs);
+        if (found_level != -1)
+        {
+            NodeType *found = succs[found_level];
+            if (!found->marked.load(std::memory_order_acquire))
+            {
+                //  等待插入者完成链接，之后的查找一定能看到该键
+                while (!found->fully_linked.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+                return 1;   // 元素已在跳表中
+            }
+            continue;   //  同键节点正在被删除，等它摘除后重试
+        }
+
+        //  锁住各层前驱后校验链接没有变化，期间其他写者不能修改这些前驱的后继
+        int highest_locked = lock_preds(preds, top_level);
+        bool valid = true;
+        for (int i = 0; valid && i <= top_level; i++)
+        {
+            valid = !preds[i]->marked.load(std::memory_order_acquire)
+                    && (succs[i] == nullptr || !succs[i]->marked.load(std::memory_order_acquire))
+                    && preds[i]->forward[i].load(std::memory_order_acquire) == succs[i];
+        }
+        if (!valid)
+        {
+            unlock_preds(preds, highest_locked);
+            continue;
+        }
+
+        NodeType *inserted_node = new NodeType(key, new V(std::move(value)), top_level);
+        for (int i = 0; i <= top_level; i++)
+        {
+            inserted_node->forward[i].store(succs[i], std::memory_order_relaxed);
+        }
+        for (int i = 0; i <= top_level; i++)
+        {
+            preds[i]->forward[i].store(inserted_node, std::memory_order_release);
+        }
+        inserted_node->fully_linked.store(true, std::memory_order_release);    //  线性化点
+        unlock_preds(preds, highest_locked);
+
+        _element_count.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+}
+
+template<typename K, typename V, typename NodeLock>
+bool LazySkipList<K, V, NodeLock>::update_element(K key, V value)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+
+    int found_level = find(key, preds, succs);
+    if (found_level == -1)
+    {
+        return false;
+    }
+    NodeType *node = succs[found_level];
+    if (!node->fully_linked.load(std::memory_order_acquire) || node->marked.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    V *old_value = node->value.exchange(new V(std::move(value)), std::memory_order_acq_rel);
+    _epoch.retire(old_value, &LazySkipList::free_value, nullptr);
+    return true;
+}
+
+template<typename K, typename V, typename NodeLock>
+bool LazySkipList<K, V, NodeLock>::search_element(K key)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+
+    int found_level = find(key, preds, succs);
+    return found_level != -1 && succs[found_level]->fully_linked.load(std::memory_order_acquire)
+           && !succs[found_level]->marked.load(std::memory_order_acquire);
+}
+
+template<typename K, typename V, typename NodeLock>
+bool LazySkipList<K, V, NodeLock>::search_element_value(K key, V &value)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+
+    int found_level = find(key, preds, succs);
+    if (found_level == -1 || !succs[found_level]->fully_linked.load(std::memory_order_acquire)
+        || succs[found_level]->marked.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    value = *succs[found_level]->value.load(std::memory_order_acquire);
+    return true;
+}
+
+template<typename K, typename V, typename NodeLock>
+bool LazySkipList<K, V, NodeLock>::delete_element(K key)
+{
+    NodeType *preds[_max_level + 1];
+    NodeType *succs[_max_level + 1];
+    auto guard = _epoch.guard();
+    NodeType *victim = nullptr;
+
+    while (true)
+    {
+        int found_level = find(key, preds, succs);
+        if (victim == nullptr)
+        {
+            //  只删除链接完成、在其最高层被找到且未标记的节点
+            if (found_level == -1)
+            {
+                return false;
+            }
+            NodeType *candidate = succs[found_level];
+            if (!candidate->fully_linked.load(std::memory_order_acquire) || candidate->marked.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (candidate->node_level != found_level)
+            {
+                continue;   //  查找开始时读到的层级早于该节点的插入，重新查找时已能看到它的最高层
+            }
+            candidate->lock.lock();
+            if (candidate->marked.load(std::memory_order_relaxed))
+            {
+                candidate->lock.unlock();
+                return false;   // 其他线程已经删除
+            }
+            candidate->marked.store(true, std::memory_order_release);  //  线性化点，之后由本线程负责摘除
+            victim = candidate;
+        }
+
+        //  锁住各层前驱并校验它们仍直接指向 victim；victim 的锁一直持有，其后继不会再变
+        int top_level = victim->node_level;
+        int highest_locked = lock_preds(preds, top_level);
+        bool valid = true;
+        for (int i = 0; valid && i <= top_level; i++)
+        {
+            valid = !preds[i]->marked.load(std::memory_order_acquire)
+                    && preds[i]->forward[i].load(std::memory_order_acquire) == victim;
+        }
+        if (!valid)
+        {
+            unlock_preds(preds, highest_locked);
+            continue;
+        }
+
+        for (int i = top_level; i >= 0; i--)
+        {
+            preds[i]->forward[i].store(victim->forward[i].load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        victim->lock.unlock();
+        unlock_preds(preds, highest_locked);
+
+        _element_count.fetch_sub(1, std::memory_order_relaxed);
+        _epoch.retire(victim, &LazySkipList::free_node, nullptr);
+        return true;
+    }
+}
+
+template<typename K, typename V, typename NodeLock>
+void LazySkipList<K, V, NodeLock>::display_list()
+{
+    auto guard = _epoch.guard();
+    std::cout << "***** Lazy Skip List *****" << '\n';
+    for (int level = _skip_list_level.load(); level >= 0; --level)
+    {
+        std::ostringstream oss;
+        oss << "Level " << level << ": ";
+        NodeType *node = _header->forward[level].load(std::memory_order_acquire);
+        while (node != nullptr)
+        {
+            if (!node->marked.load(std::memory_order_acquire))
+            {
+                oss << "|" << node->key << ":" << *node->value.load(std::memory_order_acquire) << " ";
+            }
+            node = node->forward[level].load(std::memory_order_acquire);
+        }
+        oss << "|";
+        std::cout << oss.str() << '\n';
+    }
+}
+
+template<typename K, typename V, typename NodeLock>
+int LazySkipList<K, V, NodeLock>::size()
+{
+    return _element_count.load(std::memory_order_relaxed);
+}
+
+template<typename K, typename V, typename NodeLock>
+void LazySkipList<K, V, NodeLock>::clear()
+{
+    LOG_INFO << "Starting LazySkipList clear operation.";
+    NodeType *current = _header->forward[0].load(std::memory_order_acquire);
+    while (current != nullptr)
+    {
+        NodeType *next = current->forward[0].load(std::memory_order_relaxed);
+        delete current;
+        current = next;
+    }
+    for (int i = 0; i <= _max_level; i++)
+    {
+        _header->forward[i].store(nullptr, std::memory_order_relaxed);
+    }
+    _skip_list_level.store(0);
+    _element_count.store(0);
+    _epoch.drain();     // 已退休的节点不在链表中，单独回收
+    LOG_INFO << "LazySkipList cleared successfully.";
+}
+
+#endif // KVENGINE_LAZY_SKIPLIST_H
@@ -0,0 +1,197 @@
+#ifndef KVENGINE_LEVEL_GENERATOR_H
+#define KVENGINE_LEVEL_GENERATOR_H
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @file level_generator.h
+ * @brief 伪随机数生成器与跳表随机层级生成器。
+ */
+
+/**
+ * @brief Xorshift64 伪随机数生成器类
+ *
+ */
+class Xorshift64
+{
+private:
+    uint64_t state;
+
+public:
+    /**
+     * @brief 构造一个 Xorshift64 对象
+     *
+     * @param seed 随机数种子，默认使用随机设备生成
+     */
+    Xorshift64(uint64_t seed = std::random_device{}()) : state(seed) {}
+
+    /**
+     * @brief 生成下一个伪随机数
+     *
+     * @return uint64_t 返回下一个伪随机数
+     */
+    uint64_t next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1D;
+    }
+
+    /**
+     * @brief 生成一个在指定范围内的伪随机数
+     *
+     * @param min 最小值
+     * @param max 最大值
+     * @return uint32_t 返回在指定范围内的伪随机数
+     */
+    uint32_t nextInRange(uint32_t min, uint32_t max)
+    {
+        uint64_t range = max - min + 1;
+        return min + static_cast<uint32_t>(next() % range);
+    }
+};
+
+/**
+ * @brief 统计 64 位整数末尾连续 0 的个数
+ *
+ * @param x 输入值
+ * @return int 末尾 0 的个数，x 为 0 时返回 64
+ */
+inline int count_trailing_zeros64(uint64_t x)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    return _BitScanForward64(&index, x) ? static_cast<int>(index) : 64;
+#else
+    return x ? __builtin_ctzll(x) : 64;
+#endif
+}
+
+/**
+ * @brief 跳表随机层级生成器
+ *
+ * 每个线程持有一个线程局部的 Xorshift64，生成层级时不加锁、也不经过 libc 的 rand()。
+ * 每次只取一个 64 位随机字：
+ * - 晋升概率 p = 1/2^b(1/2、1/4、1/8 ...)时，层级 = 末尾 0 的个数 / b，没有循环；
+ * - 其他概率(例如 1/e)时，与预先计算的阈值表 p^k * 2^64 依次比较，期望比较次数为 1/(1-p)。
+ *
+ * 概率越小，节点平均高度越低、占用的指针越少，但查找时每层需要向右走的步数越多。
+ */
+class LevelGenerator
+{
+public:
+    static constexpr double kHalf = 0.5;                        // 经典跳表，平均每节点 2 个指针
+    static constexpr double kQuarter = 0.25;                    // 平均每节点 1.33 个指针
+    static constexpr double kInverseE = 0.36787944117144233;    // 理论上查找代价最低的 1/e
+
+    /**
+     * @brief 构造函数
+     *
+     * @param max_level 生成层级的上限
+     * @param probability 节点晋升到上一层的概率，取值 (0, 1)
+     */
+    explicit LevelGenerator(int max_level, double probability = kHalf)
+    {
+        reset(max_level, probability);
+    }
+
+    /**
+     * @brief 重新设置层级上限和晋升概率
+     *
+     * @note 不是线程安全的，调用者需保证此时没有其他线程在生成层级。
+     */
+    void reset(int max_level, double probability)
+    {
+        if (!(probability > 0.0 && probability < 1.0))
+        {
+            throw std::invalid_argument("level probability must be in (0, 1)");
+        }
+        _max_level = max_level;
+        _probability = probability;
+        _bits_per_level = 0;
+        _thresholds.clear();
+
+        //  判断 p 是否为 1/2^b
+        double inverse = 1.0 / probability;
+        int bits = static_cast<int>(std::lround(std::log2(inverse)));
+        if (bits >= 1 && bits < 64 && std::fabs(std::ldexp(1.0, bits) - inverse) < 1e-9)
+        {
+            _bits_per_level = bits;
+            return;
+        }
+
+        //  阈值表：随机字小于 thresholds[k-1] 的概率为 p^k
+        double threshold = probability;
+        for (int k = 1; k <= _max_level; k++)
+        {
+            //  threshold < 1，ldexp(threshold, 64) 一定落在 uint64_t 范围内
+            _thresholds.push_back(static_cast<uint64_t>(std::ldexp(threshold, 64)));
+            threshold *= probability;
+        }
+    }
+
+    /**
+     * @brief 生成一个随机层级
+     *
+     * @return int 取值 [0, max_level]，取到 k 的概率为 p^k(1-p)
+     */
+    int generate() const
+    {
+        uint64_t word = thread_rng().next();
+        int level;
+        if (_bits_per_level != 0)
+        {
+            level = count_trailing_zeros64(word) / _bits_per_level;
+        }
+        else
+        {
+            level = 0;
+            while (level < _max_level && word < _thresholds[level])
+            {
+                level++;
+            }
+        }
+        return level < _max_level ? level : _max_level;
+    }
+
+    /**
+     * @brief 获取晋升概率
+     */
+    double probability() const
+    {
+        return _probability;
+    }
+
+private:
+    //  线程局部随机数生成器，种子混合随机设备与线程编号，保证非零
+    static Xorshift64 &thread_rng()
+    {
+        thread_local Xorshift64 rng(seed());
+        return rng;
+    }
+
+    static uint64_t seed()
+    {
+        std::random_device rd;
+        uint64_t s = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+        s ^= static_cast<uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) * 0x9E3779B97F4A7C15ULL;
+        return s != 0 ? s : 0x9E3779B97F4A7C15ULL;
+    }
+
+    int _max_level;                     // 层级上限
+    double _probability;                // 晋升概率
+    int _bits_per_level;                // p = 1/2^b 时为 b，否则为 0
+    std::vector<uint64_t> _thresholds;  // 非 2 的幂次概率时使用的阈值表
+};
+
+#endif // KVENGINE_LEVEL_GENERATOR_H
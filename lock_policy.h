@@ -0,0 +1,136 @@
+#ifndef KVENGINE_LOCK_POLICY_H
+#define KVENGINE_LOCK_POLICY_H
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @file lock_policy.h
+ * @brief 跳表写锁策略。
+ *
+ * SkipList 的每个实例持有一个锁策略对象，写操作(插入、删除、修改、清空)在其 lock()/unlock() 之间执行。
+ * 锁策略需要提供：
+ * - lock() / unlock()                      写操作的互斥，可直接配合 std::lock_guard 使用
+ * - lock_shared() / unlock_shared()        读操作的共享加锁，只在 kSharedRead 为 true 时被调用
+ * - kSharedRead                            为 true 时查询和 read_guard() 持有共享锁，与写操作互斥；
+ *                                          为 false 时查询沿用无锁读(由 EpochDomain 保证节点不被提前释放)
+ *
+ * SkipList 的写路径(元素计数、层数增长、日志顺序、批量插入的查找起点、一致性视图)都假定同一时刻只有一个写者，
+ * 因此锁策略只能替换这一把锁。需要写操作之间也并发时使用 lazy_skiplist.h 的 LazySkipList：
+ * 它以 MutexLock 或 SpinLock 作为每个节点的锁，写操作只锁住被修改链接的前驱节点。
+ */
+
+/**
+ * @brief 不加锁，适用于单线程使用的跳表
+ *
+ * @note 读写不会并发时，可以同时关闭无锁读模式(lock_free_read = false)，删除的节点立即释放。
+ */
+struct NoLock
+{
+    static constexpr bool kSharedRead = false;
+
+    void lock() {}
+    void unlock() {}
+    void lock_shared() {}
+    void unlock_shared() {}
+};
+
+/**
+ * @brief 每个实例一把互斥锁，写操作互斥、查询无锁，默认策略
+ */
+class MutexLock
+{
+public:
+    static constexpr bool kSharedRead = false;
+
+    void lock() { _mutex.lock(); }
+    void unlock() { _mutex.unlock(); }
+    void lock_shared() {}
+    void unlock_shared() {}
+
+private:
+    std::mutex _mutex;
+};
+
+/**
+ * @brief 读写锁，查询持有共享锁，写操作持有独占锁
+ *
+ * 读者与写者互斥，读到的值不会被并发修改；代价是每次查询都要修改锁内部的计数器，
+ * 读线程较多时该缓存行会在核之间来回传递。
+ */
+class SharedMutexLock
+{
+public:
+    static constexpr bool kSharedRead = true;
+
+    void lock() { _mutex.lock(); }
+    void unlock() { _mutex.unlock(); }
+    void lock_shared() { _mutex.lock_shared(); }
+    void unlock_shared() { _mutex.unlock_shared(); }
+
+private:
+    std::shared_mutex _mutex;
+};
+
+/**
+ * @brief TTAS(test-and-test-and-set)自旋锁，查询无锁
+ *
+ * 先只读地等待锁被释放，再尝试 exchange 抢占，等待期间不反复写共享缓存行。
+ * 临界区很短、线程数不超过核数时比 std::mutex 少一次内核态切换；线程数超过核数时会浪费 CPU，
+ * 自旋一定次数后让出时间片。
+ */
+class SpinLock
+{
+public:
+    static constexpr bool kSharedRead = false;
+
+    void lock()
+    {
+        while (true)
+        {
+            if (!_locked.exchange(true, std::memory_order_acquire))
+            {
+                return;
+            }
+            int spins = 0;
+            while (_locked.load(std::memory_order_relaxed))
+            {
+                if (++spins < kSpinLimit)
+                {
+                    cpu_relax();
+                }
+                else
+                {
+                    std::this_thread::yield();
+                    spins = 0;
+                }
+            }
+        }
+    }
+
+    void unlock() { _locked.store(false, std::memory_order_release); }
+    void lock_shared() {}
+    void unlock_shared() {}
+
+private:
+    static constexpr int kSpinLimit = 1024;    // 连续自旋多少次后让出时间片
+
+    static void cpu_relax()
+    {
+#if defined(_MSC_VER)
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    std::atomic<bool> _locked{false};
+};
+
+#endif // KVENGINE_LOCK_POLICY_H
@@ -4,6 +4,7 @@
 #include "ThreadPool.h"
 #include "benchmark.h"
 #include "JsonTest.h"
+#include "SkipListTest.h"
 #include "ConfigUpdater/ConfigUpdater.h"
 #include "logMod.h"
 
@@ -25,7 +26,8 @@
  * - 4: 测试JSON存取数据接口。
  * - 5: 修改配置文件中的进度条显示选项。
  * - 6: 自动保存跳表测试。
- * - 7: 退出程序。
+ * - 7: 跳表行为测试(与 std::map 的差分测试等)。
+ * - 8: 退出程序。
  * 用户需要输入对应的数字来选择想要执行的操作。如果输入无效，程序将提示重新输入。
  *
  * @note
@@ -49,7 +51,7 @@ int main()
     {
         LOG_INFO << "显示主菜单给用户。";
 
-        std::cout << "选择操作：\n1. 进行Benchmark测试\n2. 跳表API接口测试\n3. 命令识别模式\n4. 测试JSON存取\n5. 修改配置文件\n6. 自动保存跳表测试\n7. 退出程序\n请输入选项:" << std::endl;
+        std::cout << "选择操作：\n1. 进行Benchmark测试\n2. 跳表API接口测试\n3. 命令识别模式\n4. 测试JSON存取\n5. 修改配置文件\n6. 自动保存跳表测试\n7. 跳表行为测试\n8. 退出程序\n请输入选项:" << std::endl;
         int choice;
         std::cin >> choice;
 
@@ -125,6 +127,10 @@ int main()
                 std::cout << "自动保存跳表测试结束，请检查文件以验证结果。\n";
                 break;
             case 7:
+                LOG_DEBUG << "用户选择执行跳表行为测试。";
+                run_skiplist_tests();
+                break;
+            case 8:
                 LOG_INFO << "用户选择退出程序。";
                 std::cout << "退出程序。" << std::endl;
                 return 0;
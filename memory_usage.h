@@ -0,0 +1,42 @@
+#ifndef KVENGINE_MEMORY_USAGE_H
+#define KVENGINE_MEMORY_USAGE_H
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+/**
+ * @file memory_usage.h
+ * @brief 键/值在对象本身之外占用的堆内存字节数，用于跳表的内存预算。
+ *
+ * 节点占用的字节数 = 节点本身(含 forward 与跨度数组) + 键的堆内存 + 值的堆内存。
+ * 对象本身的大小已经包含在节点中，这里只统计对象额外申请的堆内存：
+ * - 算术类型等不持有堆内存的类型为 0(默认)；
+ * - std::string 超出短字符串缓冲区时为 capacity() + 1；
+ * - 其他持有堆内存的类型需要特化 HeapUsage，提供 static size_t bytes(const T &value)。
+ */
+
+/**
+ * @brief 计算对象持有的堆内存字节数，默认不持有
+ */
+template<typename T, typename Enable = void>
+struct HeapUsage
+{
+    static size_t bytes(const T &)
+    {
+        return 0;
+    }
+};
+
+template<>
+struct HeapUsage<std::string>
+{
+    static size_t bytes(const std::string &value)
+    {
+        //  空字符串的容量就是短字符串缓冲区的容量，不超过它时字符存放在对象内部
+        static const size_t kInlineCapacity = std::string().capacity();
+        return value.capacity() > kInlineCapacity ? value.capacity() + 1 : 0;
+    }
+};
+
+#endif // KVENGINE_MEMORY_USAGE_H
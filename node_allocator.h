@@ -0,0 +1,301 @@
+#ifndef KVENGINE_NODE_ALLOCATOR_H
+#define KVENGINE_NODE_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file node_allocator.h
+ * @brief 跳表节点分配器。
+ *
+ * 跳表节点与其 forward 指针数组在一次分配中连续存放，分配器只需要提供按字节数分配/释放的接口：
+ * - allocate(bytes)            分配一块至少 bytes 字节、满足 max_align_t 对齐的内存
+ * - deallocate(ptr, bytes)     归还一块由 allocate 分配的内存
+ * - release()                  一次性归还所有内存(不调用任何析构函数)
+ * - kBulkRelease               为 true 时，跳表析构时，以及 clear() 能独占分配器时，跳过逐个 deallocate，直接调用 release()
+ */
+
+/**
+ * @brief 默认节点分配器，直接使用全局 operator new/delete
+ */
+struct DefaultNodeAllocator
+{
+    static constexpr bool kBulkRelease = false;
+
+    void *allocate(size_t bytes)
+    {
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void *ptr, size_t)
+    {
+        ::operator delete(ptr);
+    }
+
+    void release() {}
+};
+
+/**
+ * @brief 按线程划分的竞技场(Arena)节点分配器
+ *
+ * 每个线程从自己的内存块中顺序切分节点，不需要加锁；被释放的节点按大小挂入切出它的线程的空闲链表，
+ * 之后同样大小的分配优先复用。所有内存块归分配器所有，release() 或析构时整块归还。
+ *
+ * 对千万级节点的跳表，这样可以消除 malloc 的逐个分配开销和碎片，并让相邻插入的节点在内存中更集中。
+ *
+ * 内存块按块大小对齐，块首记录切分它的线程的 ThreadArena，释放时由地址直接找到所属的 arena：
+ * - 本线程切出的节点直接挂入本线程的空闲链表；
+ * - 其他线程切出的节点(过期服务、纪元回收或单独的删除线程释放的节点)以无锁方式压入所属 arena 的远程释放链，
+ *   所属线程在对应大小的空闲链表为空时一次取走整条链并按大小分拣，只插入的线程因此也能复用这些节点。
+ *
+ * @note
+ * - 跨线程释放是安全的。
+ * - 已退出的线程的 arena 上的远程释放链不再被取走，其中的节点直到 release() 或析构才归还。
+ * - release() 不能与 allocate()/deallocate() 并发，调用者需保证独占(跳表在 clear() 与析构时调用)。
+ */
+class ArenaNodeAllocator
+{
+public:
+    static constexpr bool kBulkRelease = true;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param block_size 每次向系统申请的内存块大小，向上取为 2 的幂，默认 1MB
+     */
+    explicit ArenaNodeAllocator(size_t block_size = 1 << 20)
+        : _id(next_id()), _block_size(block_alignment(block_size))
+    {
+    }
+
+    ~ArenaNodeAllocator()
+    {
+        release();
+    }
+
+    ArenaNodeAllocator(const ArenaNodeAllocator &) = delete;
+    ArenaNodeAllocator &operator=(const ArenaNodeAllocator &) = delete;
+
+    void *allocate(size_t bytes)
+    {
+        bytes = round_up(bytes);
+        ThreadArena *arena = local_arena();
+
+        // 优先复用同样大小的空闲节点，本线程的链表为空时先取回其他线程归还的节点
+        size_t cls = bytes / kAlignment;
+        if (!has_free(arena, cls) && arena->remote_free.load(std::memory_order_relaxed) != nullptr)
+        {
+            drain_remote(arena);
+        }
+        if (has_free(arena, cls))
+        {
+            FreeNode *node = arena->free_lists[cls];
+            arena->free_lists[cls] = node->next;
+            return node;
+        }
+
+        // 过大的请求单独分配一块
+        if (bytes > _block_size / 4)
+        {
+            return new_block(bytes + kHeaderBytes, arena) + kHeaderBytes;
+        }
+
+        if (arena->cursor == nullptr || static_cast<size_t>(arena->end - arena->cursor) < bytes)
+        {
+            char *block = new_block(_block_size, arena);
+            arena->cursor = block + kHeaderBytes;
+            arena->end = block + _block_size;
+        }
+        void *result = arena->cursor;
+        arena->cursor += bytes;
+        return result;
+    }
+
+    void deallocate(void *ptr, size_t bytes)
+    {
+        size_t cls = round_up(bytes) / kAlignment;
+        ThreadArena *owner = owner_of(ptr);
+        FreeNode *node = static_cast<FreeNode *>(ptr);
+        if (owner == local_arena())
+        {
+            push_free(owner, node, cls);
+            return;
+        }
+
+        // 归还给切出它的线程：压入远程释放链，只有所属线程会整体取走，因此不存在 ABA 问题
+        node->cls = cls;
+        FreeNode *head = owner->remote_free.load(std::memory_order_relaxed);
+        do
+        {
+            node->next = head;
+        } while (!owner->remote_free.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief 归还所有线程的全部内存块
+     *
+     * 线程的 ThreadArena 记录本身保留，线程局部缓存中的指针在分配器析构前始终有效。
+     */
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        for (char *block : _blocks)
+        {
+            ::operator delete(block, std::align_val_t(_block_size));
+        }
+        _blocks.clear();
+        _reserved_bytes.store(0, std::memory_order_relaxed);
+        for (auto &entry : _arenas)
+        {
+            entry.second->cursor = nullptr;
+            entry.second->end = nullptr;
+            entry.second->free_lists.clear();
+            entry.second->remote_free.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 已向系统申请的字节数
+     */
+    size_t reserved_bytes() const
+    {
+        return _reserved_bytes.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t kAlignment = alignof(std::max_align_t);
+    static constexpr size_t kCacheSlots = 16;   // 线程局部缓存的槽位数
+
+    struct FreeNode
+    {
+        FreeNode *next;
+        size_t cls;                         // 大小类别，只在远程释放链上使用
+    };
+
+    struct ThreadArena
+    {
+        char *cursor = nullptr;             // 当前块中下一个可用位置
+        char *end = nullptr;                // 当前块的末尾
+        std::vector<FreeNode *> free_lists; // 按 bytes / kAlignment 索引的空闲链表，只由所属线程访问
+        std::atomic<FreeNode *> remote_free{nullptr};   // 其他线程归还的节点
+    };
+
+    // 块首记录切分该块的线程的 arena，节点从块首之后开始切分
+    struct BlockHeader
+    {
+        ThreadArena *owner;
+    };
+
+    static constexpr size_t kHeaderBytes = (sizeof(BlockHeader) + kAlignment - 1) / kAlignment * kAlignment;
+
+    // 线程局部缓存：按分配器编号直接映射，编号永不复用，因此过期条目不会被误命中
+    struct CacheEntry
+    {
+        uint64_t owner = 0;
+        ThreadArena *arena = nullptr;
+    };
+
+    static uint64_t next_id()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    //  空闲节点要放得下 FreeNode，最小的大小类别不小于它
+    static size_t round_up(size_t bytes)
+    {
+        bytes = bytes < sizeof(FreeNode) ? sizeof(FreeNode) : bytes;
+        return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    //  块按块大小对齐，块大小取不小于请求值的 2 的幂
+    static size_t block_alignment(size_t bytes)
+    {
+        size_t size = 4096;
+        while (size < bytes)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    //  节点离块首不超过一个块大小(单独分配的大块也只在块首之后切出一个节点)，按块大小取整即得块首
+    ThreadArena *owner_of(void *ptr) const
+    {
+        uintptr_t block = reinterpret_cast<uintptr_t>(ptr) & ~static_cast<uintptr_t>(_block_size - 1);
+        return reinterpret_cast<BlockHeader *>(block)->owner;
+    }
+
+    static bool has_free(ThreadArena *arena, size_t cls)
+    {
+        return cls < arena->free_lists.size() && arena->free_lists[cls] != nullptr;
+    }
+
+    static void push_free(ThreadArena *arena, FreeNode *node, size_t cls)
+    {
+        if (cls >= arena->free_lists.size())
+        {
+            arena->free_lists.resize(cls + 1, nullptr);
+        }
+        node->next = arena->free_lists[cls];
+        arena->free_lists[cls] = node;
+    }
+
+    //  取走远程释放链并按大小分拣到本线程的空闲链表
+    static void drain_remote(ThreadArena *arena)
+    {
+        FreeNode *node = arena->remote_free.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr)
+        {
+            FreeNode *next = node->next;
+            push_free(arena, node, node->cls);
+            node = next;
+        }
+    }
+
+    ThreadArena *local_arena()
+    {
+        thread_local CacheEntry cache[kCacheSlots];
+        CacheEntry &entry = cache[_id % kCacheSlots];
+        if (entry.owner == _id)
+        {
+            return entry.arena;
+        }
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        std::unique_ptr<ThreadArena> &arena = _arenas[std::this_thread::get_id()];
+        if (!arena)
+        {
+            arena = std::make_unique<ThreadArena>();
+        }
+        entry.owner = _id;
+        entry.arena = arena.get();
+        return entry.arena;
+    }
+
+    char *new_block(size_t bytes, ThreadArena *owner)
+    {
+        char *block = static_cast<char *>(::operator new(bytes, std::align_val_t(_block_size)));
+        reinterpret_cast<BlockHeader *>(block)->owner = owner;
+        std::lock_guard<std::mutex> lock(_mtx);
+        _blocks.push_back(block);
+        _reserved_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        return block;
+    }
+
+    const uint64_t _id;                 // 分配器编号，用于线程局部缓存
+    const size_t _block_size;           // 内存块大小，也是内存块的对齐
+    std::mutex _mtx;                    // 保护 _arenas 与 _blocks
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadArena>> _arenas;
+    std::vector<char *> _blocks;        // 所有已申请的内存块
+    std::atomic<size_t> _reserved_bytes{0};
+};
+
+#endif // KVENGINE_NODE_ALLOCATOR_H
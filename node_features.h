@@ -0,0 +1,51 @@
+#ifndef KVENGINE_NODE_FEATURES_H
+#define KVENGINE_NODE_FEATURES_H
+
+/**
+ * @file node_features.h
+ * @brief 跳表节点的可选元数据。
+ *
+ * SkipList 的排名、一致性视图、过期和内存预算各自需要在每个节点上存放一份元数据，
+ * 不使用这些功能的跳表不应为它们付出节点大小。特性策略在编译期决定节点带哪些字段，需要提供：
+ * - kRank          每层链接的跨度数组(node_level + 1 个 int)，支持 rank/select/count_range/percentile
+ * - kViews         节点的版本号(uint64_t)，一致性视图据此跳过视图打开之后创建的节点
+ * - kExpiry        过期时间(std::atomic<uint64_t>)，支持带 TTL 的插入、expire/persist 与过期服务
+ * - kMemoryBudget  访问位与节点计费(std::atomic<bool> + size_t)，支持 memory_usage 与 set_memory_budget
+ *
+ * 关闭的特性对应的接口在编译期报错而不是退化为空操作。关闭 kViews 时 consistent_for_each 与各种快照保存
+ * 仍然得到一致的内容，但改为在遍历期间持有写锁，保存期间写操作被阻塞。
+ */
+
+/**
+ * @brief 按模板参数逐项开关的特性策略
+ *
+ * @tparam Rank 是否存放跨度数组
+ * @tparam Views 是否存放版本号
+ * @tparam Expiry 是否存放过期时间
+ * @tparam MemoryBudget 是否存放访问位与节点计费
+ */
+template<bool Rank = true, bool Views = true, bool Expiry = true, bool MemoryBudget = true>
+struct NodeFeatures
+{
+    static constexpr bool kRank = Rank;
+    static constexpr bool kViews = Views;
+    static constexpr bool kExpiry = Expiry;
+    static constexpr bool kMemoryBudget = MemoryBudget;
+};
+
+/**
+ * @brief 开启全部特性
+ */
+using FullNodeFeatures = NodeFeatures<>;
+
+/**
+ * @brief 关闭全部特性，节点只有层级、键、值和后继指针，适用于只做插入、查找、删除与遍历的跳表。SkipList 的默认策略
+ */
+using PlainNodeFeatures = NodeFeatures<false, false, false, false>;
+
+/**
+ * @brief 只开启版本号，一致性视图与快照保存不阻塞写操作，AutoSaveSkipList 使用此策略
+ */
+using ViewNodeFeatures = NodeFeatures<false, true, false, false>;
+
+#endif // KVENGINE_NODE_FEATURES_H
@@ -0,0 +1,382 @@
+#ifndef KVENGINE_SHARDED_SKIPLIST_H
+#define KVENGINE_SHARDED_SKIPLIST_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "skiplist.h"
+
+/**
+ * @file sharded_skiplist.h
+ * @brief 分片跳表。
+ *
+ * 将键划分到 N 个相互独立的 SkipList 中，每个分片持有自己的写锁，
+ * 不同分片上的写操作可以并行执行，而不是全部排队等待同一把锁。
+ */
+
+/**
+ * @brief 分片策略
+ */
+enum class ShardingPolicy
+{
+    Hash,   // 按键的哈希值取模，负载均匀，范围读需要合并所有分片
+    Range   // 按分割点划分连续的键区间，各分片键区间互不重叠
+};
+
+/**
+ * @brief 分片跳表
+ *
+ * 对外提供与 SkipList 相同的插入、查找、删除、修改与 size 接口，并通过 MergeIterator
+ * 按键的顺序遍历所有分片。
+ *
+ * @tparam K 键的类型
+ * @tparam V 值的类型
+ * @tparam LockPolicy 每个分片的写锁策略(见 lock_policy.h)
+ * @tparam Alloc、Compare、Hash、Features 原样转发给每个分片的 SkipList，含义与默认值相同；
+ *         按区间分片的分割点与合并迭代器都按 Compare 排序，按哈希分片时用 Hash 选择分片
+ *
+ * @note 各分片是以 LockPolicy 加锁的 SkipList；跨分片的操作(size、clear、遍历)不是原子快照。
+ */
+template <typename K, typename V, typename LockPolicy = MutexLock, typename Alloc = DefaultNodeAllocator, typename Compare = std::less<>,
+          typename Hash = std::hash<K>, typename Features = PlainNodeFeatures>
+class ShardedSkipList
+{
+private:
+    struct Shard;
+
+public:
+    using ShardType = SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>;
+    using NodeType = Node<K, V, Features>;
+
+    /**
+     * @brief 跨分片的有序合并迭代器
+     *
+     * 为每个分片持有一个读守卫，并用小顶堆维护各分片当前位置，每次取出键最小的节点。
+     * 迭代器存活期间，遍历到的节点即使被并发删除也不会被释放。
+     *
+     * 用法：
+     * @code
+     * for (auto it = store.seek(100); it.valid() && it.get_key() < 200; it.next()) { ... }
+     * @endcode
+     */
+    class MergeIterator
+    {
+    public:
+        MergeIterator(MergeIterator &&) = default;
+        MergeIterator(const MergeIterator &) = delete;
+        MergeIterator &operator=(const MergeIterator &) = delete;
+
+        /**
+         * @brief 是否仍指向有效元素
+         */
+        bool valid() const
+        {
+            return !_heap.empty();
+        }
+
+        /**
+         * @brief 当前元素的键
+         */
+        K get_key() const
+        {
+            return _heap.front()->get_key();
+        }
+
+        /**
+         * @brief 当前元素的值
+         */
+        V get_value() const
+        {
+            return _heap.front()->get_value();
+        }
+
+        /**
+         * @brief 移动到下一个元素
+         */
+        void next()
+        {
+            auto greater = [this](NodeType *a, NodeType *b) { return greater_key(a, b); };
+            std::pop_heap(_heap.begin(), _heap.end(), greater);
+            NodeType *successor = _heap.back()->get_next(0);
+            if (successor != nullptr)
+            {
+                _heap.back() = successor;
+                std::push_heap(_heap.begin(), _heap.end(), greater);
+            }
+            else
+            {
+                _heap.pop_back();
+            }
+        }
+
+    private:
+        friend class ShardedSkipList;
+
+        //  seek 为 nullptr 时从各分片的第一个节点开始
+        MergeIterator(std::vector<std::unique_ptr<Shard>> &shards, const K *seek)
+            : _order(&shards.front()->list)
+        {
+            _guards.reserve(shards.size());
+            _heap.reserve(shards.size());
+            for (auto &shard : shards)
+            {
+                _guards.emplace_back(shard->list.read_guard());
+                NodeType *node = seek ? shard->list.seek_node(*seek) : shard->list.first_node();
+                if (node != nullptr)
+                {
+                    _heap.push_back(node);
+                }
+            }
+            std::make_heap(_heap.begin(), _heap.end(), [this](NodeType *a, NodeType *b) { return greater_key(a, b); });
+        }
+
+        //  各分片的比较器相同，按任一分片的键序比较
+        bool greater_key(NodeType *a, NodeType *b) const
+        {
+            return _order->key_less(b->get_key(), a->get_key());
+        }
+
+        const ShardType *_order;                                // 提供键序的分片
+        std::vector<typename ShardType::ReadGuard> _guards;    // 每个分片一个读守卫
+        std::vector<NodeType *> _heap;              // 各分片当前节点组成的小顶堆
+    };
+
+    /**
+     * @brief 构造函数：按哈希分片
+     *
+     * @param shard_count 分片数量，通常取写线程数
+     * @param max_level 每个分片跳表的最大层级数
+     */
+    ShardedSkipList(int shard_count, int max_level)
+        : _policy(ShardingPolicy::Hash)
+    {
+        if (shard_count <= 0)
+        {
+            throw std::invalid_argument("shard count must be positive");
+        }
+        create_shards(shard_count, max_level);
+    }
+
+    /**
+     * @brief 构造函数：按键区间分片
+     *
+     * 分片 i 存放 [split_keys[i-1], split_keys[i]) 区间内的键，首尾分片分别向两端无界。
+     *
+     * @param split_keys 严格递增的分割点，分片数量为 split_keys.size() + 1
+     * @param max_level 每个分片跳表的最大层级数
+     */
+    ShardedSkipList(const std::vector<K> &split_keys, int max_level)
+        : _policy(ShardingPolicy::Range), _split_keys(split_keys)
+    {
+        //  先创建分片，分割点按分片的比较器校验
+        create_shards(static_cast<int>(_split_keys.size()) + 1, max_level);
+        for (size_t i = 1; i < _split_keys.size(); i++)
+        {
+            if (!key_less(_split_keys[i - 1], _split_keys[i]))
+            {
+                throw std::invalid_argument("split keys must be strictly increasing");
+            }
+        }
+    }
+
+    /**
+     * @brief 插入键值对
+     *
+     * @return 如果成功插入元素，则返回 0；如果元素已存在，则返回 1
+     */
+    int insert_element(K key, V value)
+    {
+        return shard_for(key).insert_element(key, value);
+    }
+
+    /**
+     * @brief 修改指定键的值
+     *
+     * @return 如果键存在且值被修改，则返回 true
+     */
+    bool update_element(K key, V value)
+    {
+        return shard_for(key).update_element(key, value);
+    }
+
+    /**
+     * @brief 查找指定键是否存在
+     */
+    bool search_element(K key)
+    {
+        return shard_for(key).search_element(key);
+    }
+
+    /**
+     * @brief 查找元素值
+     *
+     * @return V* 指向值的指针，不存在时返回 nullptr
+     *
+     * @note 与 SkipList::search_element_value 相同，使用返回值期间需通过 read_guard(key) 持有守卫。
+     */
+    V *search_element_value(K key)
+    {
+        return shard_for(key).search_element_value(key);
+    }
+
+    /**
+     * @brief 删除指定键的元素
+     */
+    void delete_element(K key)
+    {
+        shard_for(key).delete_element(key);
+    }
+
+    /**
+     * @brief 删除 [lo, hi) 区间内的所有元素
+     *
+     * 按哈希分片时区间内的键散布在所有分片上，逐个分片执行区间删除；
+     * 按区间分片时只处理与 [lo, hi) 相交的分片。
+     *
+     * @return int 删除的元素个数
+     */
+    int delete_range(K lo, K hi)
+    {
+        size_t first = 0;
+        size_t last = _shards.size();
+        if (_policy == ShardingPolicy::Range)
+        {
+            first = shard_index(lo);
+            last = std::min(shard_index(hi) + 1, _shards.size());
+        }
+        int removed = 0;
+        for (size_t i = first; i < last; i++)
+        {
+            removed += _shards[i]->list.delete_range(lo, hi);
+        }
+        return removed;
+    }
+
+    /**
+     * @brief 进入 key 所在分片的无锁读临界区
+     */
+    typename ShardType::ReadGuard read_guard(K key)
+    {
+        return shard_for(key).read_guard();
+    }
+
+    /**
+     * @brief 所有分片的元素数量之和
+     */
+    int size()
+    {
+        int total = 0;
+        for (auto &shard : _shards)
+        {
+            total += shard->list.size();
+        }
+        return total;
+    }
+
+    /**
+     * @brief 清空所有分片
+     */
+    void clear()
+    {
+        for (auto &shard : _shards)
+        {
+            shard->list.clear();
+        }
+    }
+
+    /**
+     * @brief 从键最小的元素开始遍历所有分片
+     */
+    MergeIterator begin()
+    {
+        return MergeIterator(_shards, nullptr);
+    }
+
+    /**
+     * @brief 从第一个键不小于 key 的元素开始遍历所有分片
+     */
+    MergeIterator seek(K key)
+    {
+        return MergeIterator(_shards, &key);
+    }
+
+    /**
+     * @brief 分片数量
+     */
+    int shard_count() const
+    {
+        return static_cast<int>(_shards.size());
+    }
+
+    /**
+     * @brief 获取第 index 个分片
+     */
+    ShardType &shard(int index)
+    {
+        return _shards[index]->list;
+    }
+
+    /**
+     * @brief 分片策略
+     */
+    ShardingPolicy policy() const
+    {
+        return _policy;
+    }
+
+private:
+    //  每个分片独占缓存行，避免相邻分片的写锁互相干扰
+    struct alignas(64) Shard
+    {
+        ShardType list;     // 分片跳表，写锁由其锁策略持有
+
+        explicit Shard(int max_level) : list(max_level) {}
+    };
+
+    void create_shards(int shard_count, int max_level)
+    {
+        _shards.reserve(shard_count);
+        for (int i = 0; i < shard_count; i++)
+        {
+            _shards.push_back(std::make_unique<Shard>(max_level));
+        }
+    }
+
+    //  计算 key 所属的分片
+    size_t shard_index(const K &key) const
+    {
+        if (_policy == ShardingPolicy::Range)
+        {
+            auto less = [this](const K &a, const K &b) { return key_less(a, b); };
+            return std::upper_bound(_split_keys.begin(), _split_keys.end(), key, less) - _split_keys.begin();
+        }
+        //  std::hash 对整数通常是恒等映射，再混合一次避免连续键集中在少数分片
+        uint64_t h = static_cast<uint64_t>(Hash{}(key));
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        return h % _shards.size();
+    }
+
+    //  按分片的比较器比较键，与分片内部及合并迭代器的键序一致
+    bool key_less(const K &a, const K &b) const
+    {
+        return _shards.front()->list.key_less(a, b);
+    }
+
+    ShardType &shard_for(const K &key)
+    {
+        return _shards[shard_index(key)]->list;
+    }
+
+    ShardingPolicy _policy;                         // 分片策略
+    std::vector<K> _split_keys;                     // 按区间分片时的分割点
+    std::vector<std::unique_ptr<Shard>> _shards;    // 各分片
+};
+
+#endif // KVENGINE_SHARDED_SKIPLIST_H
@@ -5,44 +5,146 @@
 #include <atomic>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
+#include <cstdio>
 #include <cstdlib>
 #include <cmath>
 #include <cstring>
 #include <cctype>
+#include <functional>
+#include <future>
 #include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <memory>
 #include <iomanip>
+#include <iterator>
+#include <map>
 #include <vector>
 #include <Windows.h>
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
 #include <sstream>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <utility>
 
 /* 引入RapidJSON库头文件 */
 #include <document.h>
-#include <istreamwrapper.h>
-#include <ostreamwrapper.h>
+#include <error/en.h>
+#include <filewritestream.h>
+#include <reader.h>
 #include <writer.h>
 
 #include "logMod.h"
+#include "epoch.h"
+#include "hash_index.h"
+#include "json_sax.h"
+#include "bloom_filter.h"
+#include "level_generator.h"
+#include "lock_policy.h"
+#include "memory_usage.h"
+#include "node_allocator.h"
+#include "node_features.h"
+#include "snapshot.h"
+#include "timing_wheel.h"
+#include "wal.h"
+#include "delta_snapshot.h"
 
 #define STORE_FILE "store/dumpFile" // 宏定义数据持久化文件路径和文件名
 #define CHRONO_STORE_FILE_NAME "chrono_dump_file"    //宏定义定时数据持久化基础文件名
 
-extern std::mutex mtx;           // 互斥锁，保护临界区资源
 extern std::string delimiter;    //  键值对之间的分隔符
 
+namespace skiplist_detail {
+
+// 比较器是否声明了 is_transparent，即能否直接比较 K 与其他类型的键(例如 std::less<>)
+template<typename Compare, typename = void>
+struct is_transparent : std::false_type {};
+
+template<typename Compare>
+struct is_transparent<Compare, std::void_t<typename Compare::is_transparent>> : std::true_type {};
+
+// 线程池是否以 enqueue(f) 提交任务(ThreadPool)；否则按 ctpl::thread_pool 的 push(f(int)) 提交
+template<typename Pool, typename = void>
+struct has_enqueue : std::false_type {};
+
+template<typename Pool>
+struct has_enqueue<Pool, std::void_t<decltype(std::declval<Pool &>().enqueue(std::declval<void (*)()>()))>> : std::true_type {};
+
+//  节点元数据按单继承链逐层叠加，关闭的特性只是一个空的中间基类，不占节点空间
+
+struct NodeNoMeta {};
+
+template<bool Enabled, typename Base>
+struct NodeExpiryMeta : Base {};
+
+template<typename Base>
+struct NodeExpiryMeta<true, Base> : Base
+{
+    //  过期时间(steady_clock 毫秒)，0 表示永不过期；写锁内修改，无锁读者只读
+    std::atomic<uint64_t> expire_at;
+};
+
+template<bool Enabled, typename Base>
+struct NodeVersionMeta : Base {};
+
+template<typename Base>
+struct NodeVersionMeta<true, Base> : Base
+{
+    uint64_t version;   // 创建节点时跳表的版本号，版本号不大于视图版本的节点对一致性视图可见
+};
+
+template<bool Enabled, typename Base>
+struct NodeBudgetMeta : Base {};
+
+template<typename Base>
+struct NodeBudgetMeta<true, Base> : Base
+{
+    size_t charge;      // 节点计入内存预算的字节数(节点本身 + 键和值的堆内存)，写锁内维护
+
+    //  访问位：查询在不加写锁的情况下置位，CLOCK 淘汰经过时清除，经过时未被置位的节点被淘汰。新节点未置位，
+    //  从未被查询过的键先于被查询过的键淘汰
+    std::atomic<bool> referenced;
+};
+
+//  访问位放在最后，与节点自身的 node_level 共用对齐空隙
+template<typename Features>
+using NodeMeta = NodeBudgetMeta<Features::kMemoryBudget, NodeVersionMeta<Features::kViews, NodeExpiryMeta<Features::kExpiry, NodeNoMeta>>>;
+
+} // namespace skiplist_detail
+
+/**
+ * @brief 预取一块内存到缓存，只是提示，不影响正确性
+ * 
+ * @param address 即将读取的地址
+ */
+inline void prefetch_for_read(const void *address)
+{
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+    __builtin_prefetch(address, 0, 3);
+#endif
+}
+
 /**
  * @brief 节点类
  * 
  * 表示跳表中的一个节点。
  * 
+ * forward 指针数组是节点的柔性尾部：节点与 node_level + 1 个后继指针在同一次分配中连续存放，
+ * 开启排名时之后紧跟 node_level + 1 个跨度(第 i 层链接跨过的最底层节点数)，
+ * 因此节点必须通过 storage_size() 计算大小、在分配器提供的内存上原位构造，不能直接 new。
+ * 
  * @tparam K 键的类型
  * @tparam V 值的类型
+ * @tparam Features 特性策略(见 node_features.h)，决定节点是否带跨度、版本号、过期时间、访问位与计费
  */
-template<typename K, typename V>
-class Node
+template<typename K, typename V, typename Features = PlainNodeFeatures>
+class Node : public skiplist_detail::NodeMeta<Features>
 {
 public:
 
@@ -65,25 +167,28 @@ public:
     Node(K k, V v, int);    //  有参构造函数
 
     /**
-     * @brief 析构函数
+     * @brief 计算指定层级的节点(含尾部指针数组，开启排名时还有跨度数组)所需的字节数
      * 
-     * 删除节点的指针数组，确保释放内存。
+     * @param level 节点的层级
+     * @return size_t 分配节点时需要的字节数
      */
-    ~Node();    //  析构函数
+    static size_t storage_size(int level);
 
     /**
      * @brief 获取节点的键
      * 
-     * @return K 节点的键
+     * 返回引用，查找路径上的比较不拷贝键。节点插入后键不再改变。
+     * 
+     * @return const K& 节点的键
      */
-    K get_key() const;  //  获取键
+    const K &get_key() const;  //  获取键
 
     /**
      * @brief 获取节点的值
      * 
-     * @return V 节点的值
+     * @return const V& 节点的值
      */
-    V get_value() const;    //  获取值
+    const V &get_value() const;    //  获取值
 
     /**
      * @brief 获取存储在节点中的值的引用。
@@ -117,64 +222,153 @@ public:
      */
     void set_value(V);  //  设定值
 
-    //  指向下一节点的指针数组
-    Node<K, V> **forward;
+    /**
+     * @brief 获取节点在指定层的后继
+     * 
+     * 以 acquire 语义读取，保证看到后继节点在发布前写入的键、值和指针。
+     * 
+     * @param level 层级
+     * @return Node<K, V, Features>* 后继节点，不存在时为 nullptr
+     */
+    Node<K, V, Features> *get_next(int level) const;
+
+    /**
+     * @brief 设置节点在指定层的后继
+     * 
+     * 以 release 语义写入，新节点的内容先于链接对无锁读者可见。
+     * 
+     * @param level 层级
+     * @param node 新的后继节点
+     */
+    void set_next(int level, Node<K, V, Features> *node);
+
+    /**
+     * @brief 获取节点第 level 层链接的跨度
+     * 
+     * 跨度是沿该层后继前进一步所跨过的最底层节点数，后继为空时是到表尾的节点数。
+     * 跨度只在写锁内修改，排名查询在读守卫内以 relaxed 原子读取，并按写操作序号校验读到的跨度是否一致。
+     * 只有 Features::kRank 为 true 时可用。
+     * 
+     * @param level 层级
+     * @return int 跨度
+     */
+    int get_span(int level) const;
+
+    /**
+     * @brief 设置节点第 level 层链接的跨度
+     * 
+     * @param level 层级
+     * @param span 新的跨度
+     */
+    void set_span(int level, int span);
 
     int node_level;     // 节点所在层
 
 private:
     K key;      // 节点的键，唯一标识节点
     V value;    //节点的值，键->数据
+
+public:
+    //  指向下一节点的指针数组，原子指针使无锁读者不会读到撕裂的链接
+    //  柔性尾部：实际长度为 node_level + 1，必须是最后一个成员
+    std::atomic<Node<K, V, Features>*> forward[1];
 };
 
 //  有参构造函数实现
-template<typename K, typename V>
-Node<K, V>::Node(const K k, const V v, int level)
+template<typename K, typename V, typename Features>
+Node<K, V, Features>::Node(K k, V v, int level)
+    : key(std::move(k)), value(std::move(v))
 {
-    this->key = k;
-    this->value = v;
     this->node_level = level;
+    if constexpr (Features::kViews)
+    {
+        this->version = 0;
+    }
+    if constexpr (Features::kExpiry)
+    {
+        this->expire_at.store(0, std::memory_order_relaxed);
+    }
+    if constexpr (Features::kMemoryBudget)
+    {
+        this->referenced.store(false, std::memory_order_relaxed);
+        this->charge = 0;
+    }
 
-    // 数组大小为 0-level 的个数，level + 1
-    this->forward = new Node<K, V>*[level+1];
-
-    // 初始化指针数组 NULL(0)
-    memset(this->forward, 0, sizeof(Node<K, V>*)*(level+1));
+    // 初始化尾部指针数组 NULL(0)，数组大小为 0-level 的个数，level + 1
+    for (int i = 0; i <= level; i++)
+    {
+        this->forward[i].store(nullptr, std::memory_order_relaxed);
+        if constexpr (Features::kRank)
+        {
+            this->set_span(i, 0);
+        }
+    }
 };
 
-template<typename K, typename V>
-Node<K, V>::~Node()
+//  节点大小 = 节点本身(含 forward[0]) + 额外 level 个后继指针 + 开启排名时 level + 1 个跨度
+template<typename K, typename V, typename Features>
+size_t Node<K, V, Features>::storage_size(int level)
 {
-    delete []forward;   // delete [] ，确保释放整个数组
+    size_t spans = Features::kRank ? sizeof(std::atomic<int>) * (level + 1) : 0;
+    return sizeof(Node<K, V, Features>) + sizeof(std::atomic<Node<K, V, Features>*>) * level + spans;
 };
 
 //  获取键
-template<typename K, typename V>
-K Node<K, V>::get_key() const
+template<typename K, typename V, typename Features>
+const K& Node<K, V, Features>::get_key() const
 {
     return key;
 };
 
 //  获取键->值
-template<typename K, typename V>
-V Node<K, V>::get_value() const
+template<typename K, typename V, typename Features>
+const V& Node<K, V, Features>::get_value() const
 {
     return value;
 };
 
 // 获取节点储存的值的引用
 // 返回值类型为V的引用，允许直接修改节点储存的值
-template<typename K, typename V>
-V& Node<K, V>::get_value()
+template<typename K, typename V, typename Features>
+V& Node<K, V, Features>::get_value()
 {
     return value;
 };
 
 //  设定节点的值为 value
-template<typename K, typename V>
-void Node<K, V>::set_value(V value)
+template<typename K, typename V, typename Features>
+void Node<K, V, Features>::set_value(V value)
+{
+    this->value = std::move(value);
+};
+
+//  获取第 level 层的后继节点
+template<typename K, typename V, typename Features>
+Node<K, V, Features>* Node<K, V, Features>::get_next(int level) const
+{
+    return forward[level].load(std::memory_order_acquire);
+};
+
+//  设置第 level 层的后继节点
+template<typename K, typename V, typename Features>
+void Node<K, V, Features>::set_next(int level, Node<K, V, Features> *node)
+{
+    forward[level].store(node, std::memory_order_release);
+};
+
+//  跨度数组紧跟在 forward[node_level] 之后
+template<typename K, typename V, typename Features>
+int Node<K, V, Features>::get_span(int level) const
+{
+    static_assert(Features::kRank, "link spans require Features::kRank");
+    return reinterpret_cast<const std::atomic<int> *>(forward + node_level + 1)[level].load(std::memory_order_relaxed);
+};
+
+template<typename K, typename V, typename Features>
+void Node<K, V, Features>::set_span(int level, int span)
 {
-    this->value=value;
+    static_assert(Features::kRank, "link spans require Features::kRank");
+    reinterpret_cast<std::atomic<int> *>(forward + node_level + 1)[level].store(span, std::memory_order_relaxed);
 };
 
 /**
@@ -185,22 +379,143 @@ void Node<K, V>::set_value(V value)
  * 
  * @tparam K 键的类型
  * @tparam V 值的类型
+ * @tparam LockPolicy 写锁策略(见 lock_policy.h)，每个实例持有自己的锁：NoLock、MutexLock(默认)、SharedMutexLock、SpinLock
+ * @tparam Alloc 节点分配器，默认逐个使用 operator new；ArenaNodeAllocator 按线程切分内存块并在 clear()/析构时整块释放
+ * @tparam Compare 键的严格弱序比较器，默认 std::less<>。比较器透明(声明 is_transparent)时，查找与删除接口接受任何能与 K 比较的键类型，
+ *         例如 K 为 std::string 时可以直接传入 std::string_view 或字符串字面量，不构造临时的 K
+ * @tparam Hash 哈希索引与布隆过滤器使用的哈希函数，默认 std::hash<K>，只在开启两者之后使用；按 Compare 等价的键必须有相同的哈希值
+ * @tparam Features 节点特性策略(见 node_features.h)，默认 PlainNodeFeatures：节点只有层级、键、值和后继指针。
+ *         排名、一致性视图、TTL 与内存预算需要显式开启对应特性(例如 FullNodeFeatures)，关闭的特性不在节点中占用空间，对应的接口不可用
  * 
- * @note    键值中的key用int型，如果用其他类型，需要自定义比较函数，同时需要修改skipList.load_file函数
+ * @note    键值中的key用int型，如果用其他类型，需要提供比较器，同时需要修改skipList.load_file函数
+ * @note    写操作(插入、删除、修改)在锁策略的 lock()/unlock() 之间互斥执行；查询默认不加锁。在无锁读模式下，链接以原子指针发布，
+ *          修改值时以新节点替换旧节点而不原地改写，被删除或替换的节点通过 EpochDomain 延迟释放，
+ *          查询与写操作并发时既不会阻塞，也不会访问已释放的节点或读到写了一半的值。
+ *          锁策略的 kSharedRead 为 true 时，查询改为持有共享锁，与写操作互斥。
  */
-template <typename K, typename V>
+template <typename K, typename V, typename LockPolicy = MutexLock, typename Alloc = DefaultNodeAllocator, typename Compare = std::less<>, typename Hash = std::hash<K>,
+          typename Features = PlainNodeFeatures>
 class SkipList
 {
 public:
 
+    /**
+     * @brief 沿最底层按键递增顺序遍历的前向迭代器
+     * 
+     * 解引用得到节点本身，通过 get_key()/get_value() 访问键值。
+     * 
+     * @tparam IsConst 为 true 时只能读取节点
+     * 
+     * @note 迭代器不持有读守卫。与删除并发遍历时，需要在迭代器使用期间持有 read_guard()。
+     */
+    template<bool IsConst>
+    class BasicIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Node<K, V, Features>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<IsConst, const Node<K, V, Features> *, Node<K, V, Features> *>::type;
+        using reference = typename std::conditional<IsConst, const Node<K, V, Features> &, Node<K, V, Features> &>::type;
+
+        BasicIterator() : _node(nullptr) {}
+        explicit BasicIterator(Node<K, V, Features> *node) : _node(node) {}
+
+        //  非 const 迭代器可以隐式转换为 const 迭代器
+        operator BasicIterator<true>() const { return BasicIterator<true>(_node); }
+
+        reference operator*() const { return *_node; }
+        pointer operator->() const { return _node; }
+
+        BasicIterator &operator++()
+        {
+            _node = _node->get_next(0);
+            return *this;
+        }
+
+        BasicIterator operator++(int)
+        {
+            BasicIterator old = *this;
+            _node = _node->get_next(0);
+            return old;
+        }
+
+        bool operator==(const BasicIterator &other) const { return _node == other._node; }
+        bool operator!=(const BasicIterator &other) const { return _node != other._node; }
+
+    private:
+        Node<K, V, Features> *_node;  //  当前节点，nullptr 表示 end()
+    };
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    /**
+     * @brief 读临界区守卫
+     * 
+     * 登记纪元，保证守卫存活期间读到的节点不会被释放；锁策略的 kSharedRead 为 true 时同时持有共享锁。
+     * 同一线程嵌套获取守卫时只有最外层加共享锁，避免读写锁在有写者排队时重入死锁。
+     * 
+     * @note 持有共享锁的线程不能对同一跳表执行写操作。
+     */
+    class ReadGuard
+    {
+    public:
+        ReadGuard(EpochDomain *domain, LockPolicy *lock) : _epoch(domain), _lock(nullptr)
+        {
+            if constexpr (LockPolicy::kSharedRead)
+            {
+                std::vector<LockPolicy *> &held = held_shared_locks();
+                if (std::find(held.begin(), held.end(), lock) == held.end())
+                {
+                    lock->lock_shared();
+                    held.push_back(lock);
+                    _lock = lock;
+                }
+            }
+        }
+
+        ReadGuard(ReadGuard &&other) noexcept : _epoch(std::move(other._epoch)), _lock(other._lock)
+        {
+            other._lock = nullptr;
+        }
+
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+        ReadGuard &operator=(ReadGuard &&) = delete;
+
+        ~ReadGuard()
+        {
+            if (_lock != nullptr)
+            {
+                std::vector<LockPolicy *> &held = held_shared_locks();
+                held.erase(std::find(held.begin(), held.end(), _lock));
+                _lock->unlock_shared();
+            }
+        }
+
+    private:
+        //  当前线程已持有共享锁的锁对象
+        static std::vector<LockPolicy *> &held_shared_locks()
+        {
+            thread_local std::vector<LockPolicy *> held;
+            return held;
+        }
+
+        EpochDomain::Guard _epoch;
+        LockPolicy *_lock;  //  本守卫加上的共享锁，没有时为空
+    };
+
     /**
      * @brief 构造函数：创建新的跳表对象
      * 
      * 构造一个新的跳表对象，指定跳表的最大层级数，并初始化跳表的各项属性。
      * 
      * @param max_level 跳表的最大层级数
+     * @param lock_free_read 是否启用无锁读模式。启用时查询在纪元临界区内执行，被删除的节点延迟释放；
+     *        关闭时删除立即释放节点，只适用于读写不会并发的场景。
      */
-    SkipList(int);
+    SkipList(int, bool lock_free_read = true);
 
     /**
      * @brief 销毁跳表对象
@@ -217,11 +532,26 @@ public:
      * @brief 获取随机层级
      * 
      * 根据跳表的随机性质，生成一个随机层级数，用于新节点的插入。
+     * 由线程局部的 Xorshift64 生成，不调用 rand()，不需要任何锁。
      * 
      * @return 返回生成的随机层级数
      */
     int get_random_level();
 
+    /**
+     * @brief 设置节点晋升到上一层的概率
+     * 
+     * 只影响之后插入的节点。概率越小，节点平均层数越低、内存占用越少，查找时每层的比较次数越多。
+     * 
+     * @param probability 晋升概率，取值 (0, 1)，常用 LevelGenerator::kHalf、kQuarter、kInverseE
+     */
+    void set_level_probability(double probability);
+
+    /**
+     * @brief 获取节点晋升到上一层的概率
+     */
+    double get_level_probability() const;
+
     /**
      * @brief 创建一个节点对象
      * 
@@ -232,7 +562,7 @@ public:
      * @param level 节点的层级（高度）
      * @return 返回指向新创建的节点对象的指针
      */
-    Node<K, V>* create_node(K, V, int);
+    Node<K, V, Features>* create_node(K, V, int);
 
     /**
      * @brief 向跳表中插入新的键值对元素
@@ -243,19 +573,67 @@ public:
      * @param key 要插入的键
      * @param value 要插入的值
      * @return 如果成功插入元素，则返回 0；如果元素已存在于跳表中，则返回 1
+     * 
+     * @note 键和值按值传入后移动进节点，调用者传入右值时不产生拷贝。
      */
     int insert_element(K, V);
 
+    /**
+     * @brief 插入带过期时间的键值对
+     * 
+     * 与 insert_element 相同，新节点在 ttl 之后过期：过期的键对查询不可见，由过期服务在后台删除。
+     * 键已存在且未过期时不插入，也不改变它的过期时间；键已过期但尚未被删除时先删除旧节点再插入。
+     * 
+     * @param key 要插入的键
+     * @param value 要插入的值
+     * @param ttl 存活时间，不大于 0 时插入后立即过期
+     * @return 如果成功插入元素，则返回 0；如果元素已存在于跳表中，则返回 1
+     */
+    int insert_element(K key, V value, std::chrono::milliseconds ttl);
+
+    /**
+     * @brief 原位构造值并插入
+     * 
+     * 与 insert_element 相同，但值由 args 构造，并且只有在键不存在时才构造。
+     * 
+     * @param key 要插入的键
+     * @param args 构造值的参数
+     * @return 如果成功插入元素，则返回 0；如果元素已存在于跳表中，则返回 1
+     */
+    template<typename... Args>
+    int emplace(K key, Args &&...args);
+
+    /**
+     * @brief 批量插入键值对
+     * 
+     * 整批只加一次写锁。输入未按键有序时先在锁外排序(稳定排序，同一批内重复的键以先出现的为准)，
+     * 然后按键递增的顺序插入：
+     * - 跳表为空时，按层维护尾指针直接向后追加，整批链接为 O(n)；
+     * - 跳表非空时，保留上一个键的 update[] 作为"手指"，下一个键只需从手指失效的最低若干层重新下降，
+     *   相邻键距离较近时每次插入的期望代价为 O(1)，而不是从头节点开始的 O(log n)。
+     * 
+     * @tparam InputIt 输入迭代器，解引用后可转换为 std::pair<K, V>
+     * @param first 起始迭代器
+     * @param last 结束迭代器
+     * @return int 实际插入的元素个数(已存在的键与批内重复的键不计入)
+     */
+    template<typename InputIt>
+    int insert_batch(InputIt first, InputIt last);
+
     /**
      * @brief 修改指定键的值。
      * 
      * 如果跳表中存在指定键的元素，则更新其值。
      * 
+     * @tparam Key 查找键的类型，要求同 search_element；日志记录的是跳表中已有节点的键
      * @param key 要修改的键
      * @param value 新的值
      * @return 如果跳表中存在键且值被成功修改，则返回 true；如果键不存在，则返回 false
+     * 
+     * @note 无锁读模式下用新节点替换旧节点，正在读取旧值的查询不受影响，旧节点在读者离开后释放。
      */
-    bool update_element(K key, V value);
+    template<typename Key>
+    bool update_element(const Key &key, V value);
 
     /**
      * 更新跳表中的元素值。
@@ -264,6 +642,7 @@ public:
      * 并用新的值（new_value）更新找到的元素的值。如果元素被成功找到并更新，
      * 方法将返回true；如果给定的键在跳表中不存在，方法将返回false。
      *
+     * @tparam Key 查找键的类型，要求同 search_element
      * @param key 要更新的元素的键。这个键用于在跳表中定位元素。
      * @param new_value 用于更新元素值的新值。
      * @param old_value 一个引用参数，用于存储被更新的元素的旧值。
@@ -271,10 +650,11 @@ public:
      * @return bool 如果元素被成功找到并更新，返回true。
      *         如果给定的键在跳表中不存在，返回false。
      *
-     * 注意：这个方法使用search_element_value来定位旧值，然后更新元素值。
+     * 注意：这个方法在写锁内定位节点并更新元素值，与 update_element 一样遵循一致性视图的替换规则。
      *       如果定位和更新操作成功，将通过标准输出打印更新信息。
      */
-    bool update_element_value(K key, V new_vlaue, V &old_value);
+    template<typename Key>
+    bool update_element_value(const Key &key, V new_vlaue, V &old_value);
 
     /**
      * @brief 显示跳表的内容。
@@ -302,10 +682,12 @@ public:
     /**
      * @brief 搜索指定键的元素是否存在于跳表中
      * 
+     * @tparam Key 查找键的类型：比较器透明时可以是任何能与 K 比较的类型，查找过程不构造 K；否则先转换为 K
      * @param key 要搜索的键
      * @return 如果跳表中存在指定键的元素，则返回 true；否则返回 false
      */
-    bool search_element(K);
+    template<typename Key>
+    bool search_element(const Key &key);
 
     /**
      * @brief 查找元素值
@@ -316,637 +698,4515 @@ public:
      * @tparam K 节点键值的类型。
      * @tparam V 节点存储值的类型。
      * 
+     * @tparam Key 查找键的类型：比较器透明时可以是任何能与 K 比较的类型，查找过程不构造 K；否则先转换为 K
      * @param key 要搜索的节点的键。
      * 
      * @return V* 如果找到了具有指定键的节点，返回指向节点值的指针；如果没有找到，返回nullptr。
      * 
      * @note 如果函数返回了一个非空指针，必须确保在使用指针期间跳表的内容不被修改，因为这样可能会使指针失效。
+     *       与删除并发时，可以在调用前通过 read_guard() 持有守卫，守卫存活期间节点不会被释放。
+     *       无锁读模式下写者不原地改写值，守卫存活期间指针指向的值保持不变(修改后的值在替换它的新节点中)；
+     *       通过指针修改值不受这一保护，只适用于没有并发读者的场景。
      * 
      * @exception none 此方法不抛出任何异常。
      */
-    V* search_element_value(K key);
+    template<typename Key>
+    V* search_element_value(const Key &key);
 
     /**
-     * @brief 从跳表中删除指定键的元素
+     * @brief 批量查找一组键，多个键的下降过程交错推进
      * 
-     * @param key 要删除的键
+     * 单次查找每走一步都要等待下一个节点的缓存未命中。本函数同时维护最多 kMultiGetLanes 个查找，
+     * 每个查找每轮只前进一步，并在转去推进其他查找之前预取它下一步要读取的节点，
+     * 使多个缓存未命中同时在途。一个查找结束后立即由下一个未开始的键接替。
+     * 
+     * @tparam Key 查找键的类型，要求同 search_element_value；比较器不透明且 Key 不是 K 时先统一转换为 K
+     * @param keys 要查找的键，不要求有序，可以重复
+     * @param count 键的个数
+     * @param values 输出数组，长度至少为 count；values[i] 为 keys[i] 对应值的指针，找不到时为 nullptr
+     * @return size_t 找到的键的个数
+     * 
+     * @note 整个批次在同一个读守卫内完成。返回的指针与 search_element_value 一样，
+     *       与删除并发时需要在调用前通过 read_guard() 持有守卫，守卫存活期间才保证有效。
      */
-    void delete_element(K);
+    template<typename Key>
+    size_t multi_get(const Key *keys, size_t count, V **values);
 
     /**
-     * @brief 将内存中的数据持久化到本地磁盘文件中
+     * @brief 查找第一个键不小于 key 的节点
      * 
-     * 遍历跳表并将其中的键值对写入文件中，用于数据持久化。
+     * 供按序遍历(例如分片跳表的合并迭代)定位起点，之后沿 get_next(0) 向后遍历。
+     * 
+     * @tparam Key 查找键的类型：比较器透明时可以是任何能与 K 比较的类型，查找过程不构造 K；否则先转换为 K
+     * @param key 起始键
+     * @return Node<K, V, Features>* 第一个键不小于 key 的节点；不存在时返回 nullptr
+     * 
+     * @note 返回的节点只在调用者持有 read_guard() 守卫期间保证有效。
      */
-    void dump_file();
+    template<typename Key>
+    Node<K, V, Features>* seek_node(const Key &key);
 
     /**
-     * @brief 从文件加载数据到跳表中
+     * @brief 获取最底层的第一个节点
      * 
-     * 打开指定文件并从中读取数据，将键值对插入到跳表中。
+     * @return Node<K, V, Features>* 键最小的节点；跳表为空时返回 nullptr
+     * 
+     * @note 返回的节点只在调用者持有 read_guard() 守卫期间保证有效。
      */
-    void load_file();
+    Node<K, V, Features>* first_node();
 
     /**
-     * @brief 返回跳表中元素的数量
+     * @brief 按跳表的比较器判断 a 是否小于 b
      * 
-     * @return 返回跳表中元素的数量
+     * 供按序合并多个跳表(例如分片跳表)的调用者使用与跳表内部相同的键序。
      */
-    int size();
+    template<typename A, typename B>
+    bool key_less(const A &a, const B &b) const;
 
     /**
-     * @brief 清空跳表
+     * @brief 指向键最小元素的迭代器
+     */
+    iterator begin();
+    const_iterator begin() const;
+
+    /**
+     * @brief 尾后迭代器
+     */
+    iterator end();
+    const_iterator end() const;
+
+    /**
+     * @brief 指向第一个键不小于 key 的元素的迭代器
      * 
-     * 清空跳表中的所有节点，并重置跳表的状态。
+     * 只做一次自顶向下的查找，之后可以沿迭代器顺序遍历。
      * 
-     * @tparam K 键的类型
-     * @tparam V 值的类型
+     * @param key 起始键，类型要求同 seek_node
+     * @return iterator 找不到时返回 end()
      */
-    void clear();
+    template<typename Key>
+    iterator lower_bound(const Key &key);
 
     /**
-     * @brief 从指定的 JSON 文件中加载数据，并将这些数据插入跳表中。
-     *
-     * 此方法打开一个 JSON 文件，读取键值对数组，并依次将它们插入到跳表中。
-     * 键值对应该是 JSON 对象的形式，并且每个对象都应该有 "key" 和 "value" 两个字段。
-     * 如果文件无法打开，或者 JSON 格式不正确（例如，不是一个数组，或者数组中的元素缺少 "key" 或 "value" 字段），
-     * 将输出错误信息并返回。
-     *
-     * @param file_name JSON 文件的路径和名称。
-     * @tparam K 跳表中键的类型。注意，此类型必须与 JSON 文件中的键类型兼容。
-     * @tparam V 跳表中值的类型。注意，此类型必须与 JSON 文件中的值类型兼容。
-     * @note 此方法假设键类型 K 可以从 JSON 的 int 类型转换而来，值类型 V 可以从 JSON 的 string 类型转换而来。
-     *       如果 K 和 V 的类型与此不同，需要对代码进行适当修改。
+     * @brief 按键递增顺序访问 [lo, hi) 区间内的所有元素
+     * 
+     * 一次下降定位到 lo，然后沿最底层顺序访问，整个过程持有读守卫，回调期间节点不会被释放。
+     * 
+     * @tparam Prefetch 为 true 时，在回调处理当前节点的同时预取下一个节点，适合回调较重或节点分散的场景
+     * @tparam Key 区间端点的类型，要求同 search_element
+     * @tparam Callback 可调用对象，形如 void(const K &key, const V &value)
+     * @param lo 区间下界(包含)
+     * @param hi 区间上界(不包含)
+     * @param callback 对每个元素调用一次
+     * @return int 访问的元素个数
+     * 
+     * @note 回调内不能对同一跳表执行写操作，否则会在写锁上死锁或破坏遍历。
+     *       无锁读模式下并发的修改以新节点替换旧节点，回调引用的值在回调期间不会被改写或释放；
+     *       并发修改的键可能读到修改前或修改后的值。关闭无锁读时只适用于没有并发写者的场景。
      */
-    void load_from_json(const std::string &file_name);
+    template<bool Prefetch = false, typename Key, typename Callback>
+    int range(const Key &lo, const Key &hi, Callback callback);
 
     /**
-     * @brief 保存跳表内容到JSON文件。此函数将当前跳表的键值对以JSON格式保存到指定的文件中。
-     *        文件名将包含基础文件名与当前时间戳，确保每个文件都是唯一的。文件将被保存到指定的绝对路径下。
-     * 
-     * @tparam K 跳表键的类型。
-     * @tparam V 跳表值的类型。
-     * @param basic_file_name 基础文件名，不包含路径和文件扩展名。函数将在此基础上添加时间戳和.json扩展名。
+     * @brief 从第一个键不小于 lo 的元素开始，按顺序取出最多 limit 个键值对
      * 
-     * @details
-     * 函数执行流程如下：
-     * 1. 获取当前时间，并转化为字符串形式，用以生成唯一的文件名。
-     * 2. 构造完整的文件名，包含事先设定的绝对路径和".json"扩展名。
-     * 3. 打开文件输出流，准备写入数据。
-     *    - 如果无法打开文件，函数将输出错误信息并提前返回。
-     * 4. 利用RapidJSON库创建一个空的JSON数组。
-     * 5. 遍历跳表的所有节点，为每一个键值对创建JSON对象，并添加到JSON数组中。
-     * 6. 将JSON数组写入文件。
-     * 7. 关闭文件输出流。
+     * 用于分页查询：以上一页最后一个键的后继作为下一页的 lo。
      * 
-     * 注意：确保有写权限到指定的文件夹路径，并且RapidJSON库已经被正确引入到项目中。
+     * @tparam Prefetch 为 true 时在拷贝当前元素的同时预取下一个节点
+     * @tparam Key 起始键的类型，要求同 search_element
+     * @param lo 起始键(包含)
+     * @param limit 最多返回的元素个数
+     * @return std::vector<std::pair<K, V>> 按键递增排列的键值对拷贝
      * 
-     * 使用示例：
-     * SkipList<int, std::string> skiplist;
-     * skiplist.save_to_json("my_skiplist_data");
-     * 将生成文件名类似于 "C:/SoftWare/VScode-dir/KVengine_cpp/store/my_skiplist_data_2024-01-01_12-00-00.json"
+     * @note 拷贝在读守卫内进行，并发修改的值与 range 一样不会被拷贝到一半；各个键的值不保证来自同一时刻，
+     *       需要整体一致的结果时使用 consistent_for_each。
      */
-    void save_to_json(const std::string &basic_file_name);
+    template<bool Prefetch = false, typename Key>
+    std::vector<std::pair<K, V>> scan(const Key &lo, size_t limit);
 
     /**
-     * @brief 比较当前跳表与另一个跳表的最低层中的键值对是否完全一致。
+     * @brief 按调用时刻的一致性视图，以键递增顺序访问所有元素
      * 
-     * @details
-     * 此方法执行一个逐节点对比的操作，比较每个节点的键和值：
-     * - 如果所有对应节点的键和值均相等，则认为两个跳表在最低层是一致的。
-     * - 如果在任何点上发现键或值不相等，或者两个跳表的节点数量不同，则认为它们不一致。
+     * 打开视图只在写锁内记录一个版本号，之后遍历不持有写锁，写操作照常进行：
+     * - 视图打开之后插入的节点被跳过；
+     * - 视图可见的节点被修改时，写者用新节点替换它而不是原地修改；被删除或替换的可见节点交给视图保管，
+     *   视图按键合并这些节点与仍在链上的节点，关闭时再统一退休。
+     * 因此回调看到的恰好是打开视图那一刻的内容，写者只为视图打开期间第一次修改的键多付出一次节点分配。
      * 
-     * @tparam K 键的类型。
-     * @tparam V 值的类型。
-     * @param other 与当前跳表进行对比的另一个跳表对象的引用。
-     * @return 如果两个跳表在最低层完全一致，则返回true；否则返回false。
+     * @tparam Callback 可调用对象，形如 void(const K &key, const V &value)
+     * @param callback 对每个元素调用一次
+     * @return size_t 访问的元素个数
+     * 
+     * @note 同一时刻只有一个视图，并发调用依次执行；clear() 会等待当前视图关闭。
+     *       回调内不能对同一跳表执行 clear()，也不能通过 search_element_value 返回的指针修改值。
+     * @note Features::kViews 为 false 时节点没有版本号，遍历期间改为持有写锁：结果同样一致，但写操作被阻塞，
+     *       回调内也不能对同一跳表执行任何写操作。快照保存同样如此。
      */
-    bool skiplist_equals(const SkipList<K, V>& other) const;
+    template<typename Callback>
+    size_t consistent_for_each(Callback callback);
 
-private:
-    void get_key_value_from_string(const std::string& str, std::string* key, std::string* value);   //  从字符串提取键值对
-    bool is_valid_string(const std::string& str);   //  检查字符串是否有效
+    /**
+     * @brief 统计键小于 key 的元素个数，即 key 在跳表中的排名(从 0 开始)
+     * 
+     * 每层链接记录了它跨过的最底层节点数，下降时累加向右走过的跨度，复杂度 O(log n)。
+     * 
+     * @tparam Key 查找键的类型，要求同 search_element_value
+     * @param key 目标键，不要求存在于跳表中
+     * @return int 键小于 key 的元素个数
+     * 
+     * @note 跨度只在写锁内维护。排名类查询不加写锁：在读守卫内乐观地读取跨度，期间有写操作修改了跨度就重试，
+     *       写操作持续不断、多次重试仍不成功时才在写锁内完成。锁策略要求共享读时守卫持有共享锁，一次即可读完。
+     */
+    template<typename Key>
+    int rank(const Key &key);
 
-private:
-    //  跳表最大层级数
-    int _max_level;
+    /**
+     * @brief 按排名取元素
+     * 
+     * @param index 排名，从 0 开始
+     * @return iterator 第 index 小的元素；index 不在 [0, size()) 内时返回 end()
+     * 
+     * @note 返回的迭代器只在调用者持有 read_guard() 守卫期间保证有效。
+     */
+    iterator select(int index);
 
-    // 跳表当前层级数
-    int _skip_list_level;
+    /**
+     * @brief 统计 [lo, hi) 区间内的元素个数
+     * 
+     * 等于 rank(hi) - rank(lo)，两次下降读到的是同一个版本的跨度，不遍历区间。
+     * 
+     * @return int 元素个数，lo 不小于 hi 时返回 0
+     */
+    template<typename Key>
+    int count_range(const Key &lo, const Key &hi);
 
-    // 指向跳表头结点的指针
-    Node<K, V> *_header;
+    /**
+     * @brief 取分位数处的元素(最近排名法)
+     * 
+     * 返回排名为 ceil(p * n) - 1 的元素，p 为 0 时返回最小元素，p 为 1 时返回最大元素。
+     * 
+     * @param p 分位数，取值 [0, 1]，越界时截断
+     * @return iterator 对应元素；跳表为空时返回 end()
+     * 
+     * @note 返回的迭代器只在调用者持有 read_guard() 守卫期间保证有效。
+     */
+    iterator percentile(double p);
 
-    // 输入输出流
-    std::ofstream _file_writer;
-    std::ifstream _file_reader;
+    /**
+     * @brief 从跳表中删除指定键的元素
+     * 
+     * @tparam Key 查找键的类型：比较器透明时可以是任何能与 K 比较的类型，查找过程不构造 K；否则先转换为 K
+     * @param key 要删除的键
+     */
+    template<typename Key>
+    void delete_element(const Key &key);
 
-    // 跳表中元素的数量
-    int _element_count;
-};
+    /**
+     * @brief 删除 [lo, hi) 区间内的所有元素
+     * 
+     * 一次下降同时找到每一层区间前的最后一个节点和区间内的最后一个节点，每层只改写一个链接，
+     * 整段节点一次摘除，跨度按删除的个数调整，日志只记录一条区间删除。
+     * 摘除的节点仍按第 0 层相连，释放写锁后由调用线程等待读者离开再逐个释放，释放期间其他写者照常进行。
+     * 
+     * @tparam Key 查找键的类型，要求同 delete_element
+     * @param lo 区间下界(包含)
+     * @param hi 区间上界(不包含)
+     * @return int 删除的元素个数
+     * 
+     * @note 有一致性视图打开时，摘除的节点交给视图保管，视图关闭时再释放。
+     *       调用线程持有 read_guard() 时无法等待读者离开，摘除的节点改为逐个退休。
+     */
+    template<typename Key>
+    int delete_range(const Key &lo, const Key &hi);
+
+    /**
+     * @brief 设置已有键的过期时间
+     * 
+     * 覆盖原有的过期时间。过期时间登记到分层时间轮，不为每个键创建定时器。
+     * 
+     * @tparam Key 查找键的类型，要求同 delete_element
+     * @param key 目标键
+     * @param ttl 从现在起的存活时间，不大于 0 时立即过期
+     * @return bool 键存在且未过期时返回 true
+     */
+    template<typename Key>
+    bool expire(const Key &key, std::chrono::milliseconds ttl);
+
+    /**
+     * @brief 取消已有键的过期时间
+     * 
+     * @return bool 键存在且未过期时返回 true
+     */
+    template<typename Key>
+    bool persist(const Key &key);
+
+    /**
+     * @brief 推进时间轮到当前时间，删除期间到期的键
+     * 
+     * 时间轮取出的条目与节点当前的过期时间一致时才删除，键被重新插入或修改过期时间后旧条目自动失效。
+     * 删除按批加写锁，每批之间释放写锁，不长时间阻塞其他写者。过期服务周期性调用本函数，也可以手动调用。
+     * 
+     * @return size_t 删除的键的个数
+     * 
+     * @note 挂接的日志失败时仍处理完所有取出的条目，最后抛出 WalCommitError。
+     */
+    size_t expire_due();
+
+    /**
+     * @brief 在线程池中启动过期服务
+     * 
+     * 向线程池提交一个常驻任务，每隔 interval 调用一次 expire_due()。任务一直占用线程池的一个线程，
+     * 直到 stop_expiry_service() 或跳表析构。已在运行时不重复启动。
+     * 
+     * @tparam Pool ThreadPool(通过 enqueue 提交)或 ctpl::thread_pool(通过 push 提交)
+     * @param pool 线程池，生命周期必须长于过期服务
+     * @param interval 唤醒间隔，决定过期的键最晚多久被删除
+     * 
+     * @note 销毁线程池之前必须先停止过期服务，否则线程池会一直等待这个常驻任务结束。
+     */
+    template<typename Pool>
+    void start_expiry_service(Pool &pool, std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+
+    /**
+     * @brief 停止过期服务，等待后台任务退出
+     */
+    void stop_expiry_service();
+
+    /**
+     * @brief 设置内存预算
+     * 
+     * 每个节点按"节点本身(含 forward 与跨度数组) + 键和值的堆内存(见 memory_usage.h)"精确计入内存占用。
+     * 插入或修改使占用超过预算时，在同一次加写锁内按 CLOCK 算法淘汰节点：时钟指针沿最底层按键顺序循环移动，
+     * 经过访问位已置位的节点时清除访问位，经过未被访问过的节点时将其删除，直到占用不超过预算。
+     * 查询命中时以 relaxed 原子写置位访问位，不加写锁。
+     * 
+     * @param bytes 预算字节数，0 表示不限制。小于当前占用时立即淘汰
+     * 
+     * @note 淘汰与 delete_element 一样记录删除日志并延迟释放节点。通过 search_element_value 返回的指针
+     *       修改值不会更新节点的计费，需要改变值的大小时应使用 update_element。
+     */
+    void set_memory_budget(size_t bytes);
+
+    /**
+     * @brief 获取内存预算，0 表示不限制
+     */
+    size_t memory_budget() const;
+
+    /**
+     * @brief 开启哈希索引
+     * 
+     * 在跳表旁维护一个开放寻址哈希表，把键映射到节点。开启后 search_element、search_element_value、multi_get
+     * 与 update_element 直接由索引定位节点，期望 O(1)；删除与插入对不存在/已存在的键由索引 O(1) 判定。
+     * 跳表仍是唯一的有序结构，范围查询、遍历、快照和日志不受影响。
+     * 
+     * 索引只在写锁内修改，查询不加锁：槽位是原子指针，扩容时整表替换，旧表与节点一样通过纪元延迟释放，
+     * 因此在任何锁策略与读模式下，索引查询的并发安全性都与跳表本身的查询相同。
+     * 
+     * @note 开启时在写锁内遍历一遍现有节点建立索引，每个节点额外占用约 2~4 个指针的槽位。
+     */
+    void enable_hash_index();
+
+    /**
+     * @brief 关闭哈希索引，查询回到逐层查找
+     */
+    void disable_hash_index();
+
+    /**
+     * @brief 是否已开启哈希索引
+     */
+    bool has_hash_index() const;
+
+    /**
+     * @brief 开启布隆过滤器；已开启时按新的参数重建
+     * 
+     * 在跳表旁维护一个按缓存行分块的计数布隆过滤器。开启后 search_element、search_element_value、multi_get
+     * 与 delete_element 在下降之前先查询过滤器，不存在的键大多只访问一条缓存行就返回；删除键时计数器减一，
+     * 过滤器始终与跳表内容一致，不需要定期重建。开启哈希索引时查询直接走索引，不再查询过滤器。
+     * 
+     * 命中的查询会多访问一条缓存行，适合不存在的键占比较高的负载。
+     * 过滤器的大小在开启时确定，键数远超预期后假阳性率上升，可以用更大的 expected_keys 再次调用以重建。
+     * save_snapshot 会把过滤器一并写入快照，空跳表从快照加载时直接恢复过滤器。
+     * 
+     * @param expected_keys 预期键数，为 0 时取当前元素数(至少 1024)
+     * @param counters_per_key 每个键分摊的 4 位计数器数，默认 10，假阳性率约 1%
+     */
+    void enable_bloom_filter(size_t expected_keys = 0, size_t counters_per_key = 10);
+
+    /**
+     * @brief 关闭布隆过滤器
+     */
+    void disable_bloom_filter();
+
+    /**
+     * @brief 是否已开启布隆过滤器
+     */
+    bool has_bloom_filter() const;
+
+    /**
+     * @brief 获取布隆过滤器的统计信息，未开启时各项为 0
+     * 
+     * 下降后未找到的键计为假阳性，其中也包括已过期但尚未删除的键。
+     */
+    BloomFilterStats bloom_filter_stats();
+
+    /**
+     * @brief 获取当前计入内存预算的字节数
+     * 
+     * 不加锁读取。节点从跳表摘除时即扣除，不计入尚未释放的节点。
+     */
+    size_t memory_usage() const;
+
+    /**
+     * @brief 将内存中的数据持久化到本地磁盘文件中
+     * 
+     * 遍历跳表并将其中的键值对写入文件中，用于数据持久化。
+     */
+    void dump_file();
+
+    /**
+     * @brief 从文件加载数据到跳表中
+     * 
+     * 打开指定文件并从中读取数据，将键值对插入到跳表中。
+     */
+    void load_file();
+
+    /**
+     * @brief 返回跳表中元素的数量
+     * 
+     * @return 返回跳表中元素的数量
+     */
+    int size();
+
+    /**
+     * @brief 清空跳表
+     * 
+     * 清空跳表中的所有节点，并重置跳表的状态。
+     * 
+     * @tparam K 键的类型
+     * @tparam V 值的类型
+     * 
+     * @note 分配器支持整块释放(kBulkRelease)、没有写锁外正在分配或释放节点的操作(区间删除、清空、快照加载)
+     *       且调用线程不持有读守卫时，在写锁内等待读者离开后析构整条链并整块归还内存。
+     *       否则写锁内只把整条链从头节点摘下，等待读者离开与逐个释放节点都在写锁外进行，期间其他写操作照常进行。
+     */
+    void clear();
+
+    /**
+     * @brief 从指定的 JSON 文件中加载数据，并将这些数据插入跳表中。
+     *
+     * 此方法以写时复制方式映射 JSON 文件，用 rapidjson::Reader 原地解析键值对数组，
+     * 每攒够 kJsonLoadBatch 个键值对就按有序批量插入一次，不构建 rapidjson::Document。
+     * 内存中最多保留一批键值对，已解析部分的映射页在每批插入后释放。
+     * 键值对应该是 JSON 对象的形式，并且每个对象都应该有 "key" 和 "value" 两个字段。
+     * 如果文件无法打开或根不是数组，将输出错误信息并返回；缺少字段或类型不符的元素输出错误信息后跳过。
+     * 文件中途出现语法错误时，错误位置之前的元素已经插入，不会回滚。
+     *
+     * @param file_name JSON 文件的路径和名称。
+     * @tparam K 跳表中键的类型。注意，此类型必须与 JSON 文件中的键类型兼容。
+     * @tparam V 跳表中值的类型。注意，此类型必须与 JSON 文件中的值类型兼容。
+     * @note 此方法假设键类型 K 可以从 JSON 的 int 类型转换而来，值类型 V 可以从 JSON 的 string 类型转换而来。
+     *       如果 K 和 V 的类型与此不同，需要对代码进行适当修改。
+     */
+    void load_from_json(const std::string &file_name);
+
+    /**
+     * @brief 保存跳表内容到JSON文件。此函数将当前跳表的键值对以JSON格式保存到指定的文件中。
+     *        文件名将包含基础文件名与当前时间戳，确保每个文件都是唯一的。文件将被保存到指定的绝对路径下。
+     * 
+     * @tparam K 跳表键的类型。
+     * @tparam V 跳表值的类型。
+     * @param basic_file_name 基础文件名，不包含路径和文件扩展名。函数将在此基础上添加时间戳和.json扩展名。
+     * 
+     * @details
+     * 函数执行流程如下：
+     * 1. 获取当前时间，并转化为字符串形式，用以生成唯一的文件名。
+     * 2. 构造完整的文件名，包含事先设定的绝对路径和".json"扩展名。
+     * 3. 打开文件，准备写入数据。
+     *    - 如果无法打开文件，函数将输出错误信息并提前返回。
+     * 4. 通过 consistent_for_each 遍历调用时刻的所有节点，由 rapidjson::Writer 把每个键值对直接写入带缓冲的文件流。
+     * 5. 刷新缓冲区并关闭文件，写入失败时输出错误信息。
+     * 
+     * 不构建 rapidjson::Document，也不复制值字符串，额外内存只有固定大小(kJsonWriteBufferSize)的输出缓冲区，
+     * 与跳表中的数据量无关。输出格式与之前相同：[{"key":...,"value":"..."},...]。
+     * 
+     * 注意：确保有写权限到指定的文件夹路径，并且RapidJSON库已经被正确引入到项目中。
+     * 
+     * 使用示例：
+     * SkipList<int, std::string> skiplist;
+     * skiplist.save_to_json("my_skiplist_data");
+     * 将生成文件名类似于 "C:/SoftWare/VScode-dir/KVengine_cpp/store/my_skiplist_data_2024-01-01_12-00-00.json"
+     */
+    void save_to_json(const std::string &basic_file_name);
+
+    /**
+     * @brief 将跳表保存为二进制快照
+     * 
+     * 按键递增顺序写出长度前缀的记录，文件头记录元素个数、最大层级与记录区校验和(格式见 snapshot.h)。
+     * 先写入 file_name.tmp，完成后再替换目标文件，写到一半失败不会破坏已有快照。
+     * 
+     * @param file_name 快照文件路径
+     * @return bool 保存成功返回 true
+     * 
+     * @note 通过 consistent_for_each 遍历，不阻塞写操作，快照是开始保存那一刻的精确副本。
+     */
+    bool save_snapshot(const std::string &file_name);
+
+    /**
+     * @brief 从二进制快照加载数据
+     * 
+     * 以内存映射方式打开快照，校验文件头与校验和后直接在映射内存上解码。记录本身按键有序，
+     * 先在写锁外解码为一条独立的有序链，全部记录解码成功后才加写锁发布：跳表为空时整条接入，
+     * 整个导入为 O(n)；否则走有序插入路径合并，已存在的键保持不变。
+     * 
+     * @param file_name 快照文件路径
+     * @return bool 加载成功返回 true；文件不存在、格式不符、校验失败或含有无法解码的记录时返回 false 且不导入任何数据
+     */
+    bool load_snapshot(const std::string &file_name);
+
+    /**
+     * @brief 将跳表并行保存为分区快照
+     * 
+     * 在打开一致性视图的同一次加锁内，从最高层往下找到第一个节点数不少于 K 的若干倍的层，在该层上等距取
+     * K - 1 个分界节点，把键空间切成 K 个元素数大致相同的连续区间；加锁期间只走过 O(K) 个节点。每个区间由线程池中的一个任务在同一视图上遍历，写成一个独立的段文件
+     * (格式与 save_snapshot 相同，可以单独用 load_snapshot 加载)；全部写完后再写清单，按键序列出所有段。
+     * 
+     * 清单先写入 .tmp 再替换，替换清单即提交：段文件名中带有递增的代数，新一代的段不会覆盖旧清单引用的段，
+     * 中途失败时旧快照仍然完整。提交后删除上一代的段文件。
+     * 
+     * @tparam Pool ThreadPool(通过 enqueue 提交)或 ctpl::thread_pool(通过 push 提交)
+     * @param manifest_file 清单文件路径，段文件写在同一目录下，名为 <清单文件名>.<代数>-<序号>.seg
+     * @param pool 执行写段任务的线程池
+     * @param partitions 分区数 K，为 0 时取硬件线程数；不超过元素个数
+     * @return bool 所有段与清单都写入成功时返回 true
+     * 
+     * @note 与 save_snapshot 一样不阻塞写操作，所有段合起来是开始保存那一刻的精确副本。
+     *       调用线程等待所有段写完，不能在同一线程池的任务中调用，否则线程池被占满时会互相等待。
+     *       段中不写布隆过滤器，开启了过滤器的跳表加载时按插入的键重新填充。
+     */
+    template<typename Pool>
+    bool save_partitioned_snapshot(const std::string &manifest_file, Pool &pool, size_t partitions = 0);
+
+    /**
+     * @brief 从分区快照并行加载数据
+     * 
+     * 读取清单后，线程池中的每个任务映射一个段文件，按清单核对记录数与校验和，解码记录并自底向上构建一段独立的有序链：
+     * 节点的各层直接接在该段各层的尾部，段内的跨度一并算好，此时节点还不属于跳表。所有段构建完成后，
+     * 按键序把各段每一层的链首尾相接，只补上段与段交界处的链接与跨度，不再逐个查找插入位置。
+     * 
+     * @tparam Pool ThreadPool(通过 enqueue 提交)或 ctpl::thread_pool(通过 push 提交)
+     * @param manifest_file save_partitioned_snapshot 写出的清单
+     * @param pool 执行构建任务的线程池
+     * @return bool 加载成功返回 true；清单或任一段缺失、损坏，或段之间的键区间重叠时返回 false 且不导入任何数据
+     * 
+     * @note 解码与构建不持有写锁，期间写者与线程池中需要写锁的任务(例如过期服务、其他写操作)照常进行；
+     *       全部段构建完成后才加写锁(并等待当前的一致性视图关闭)，此时跳表仍为空就整段拼接，否则走有序插入路径合并，
+     *       已存在的键保持不变。节点由多个线程同时分配，分配器需要支持并发分配
+     *       (DefaultNodeAllocator 与 ArenaNodeAllocator 都支持)。开启了布隆过滤器、哈希索引或挂接了日志时，
+     *       这些登记只能由一个写者维护，在写锁内顺序补上。调用线程等待所有段构建完，不能在同一线程池的任务中调用，
+     *       否则线程池被占满时会互相等待。
+     */
+    template<typename Pool>
+    bool load_partitioned_snapshot(const std::string &manifest_file, Pool &pool);
+
+    /**
+     * @brief 增量保存：只写出上一次保存之后被修改的键
+     * 
+     * 第一次调用时写一个完整的基准快照并开始跟踪变化：之后每个写操作在写锁内记入变更日志，同一个键只保留最终状态，
+     * 删除记为墓碑，区间删除与清空各记一条。再次调用时在写锁内换出变更日志，锁外编码为链上的下一个增量文件，
+     * 开销只与修改过的键数有关，与跳表大小无关；没有任何变化时不写文件。
+     * 
+     * 增量数达到 max_deltas，或增量累计的字节数超过基准的一半时改为压缩：重写基准，开始一条新链并删除旧链的文件，
+     * 加载时需要重放的增量因此有上限。文件组织与格式见 delta_snapshot.h。
+     * 
+     * @param file_name 清单文件路径，基准与增量写在同一目录下
+     * @param max_deltas 一条链上最多的增量数
+     * @return bool 保存成功返回 true；增量写入失败时返回 false，下一次调用改为压缩，已提交的链保持可加载
+     * 
+     * @note 同一跳表同一时刻只有一个增量保存在进行。开始跟踪之后每个写操作多一次有序表插入，
+     *       不再需要增量保存的跳表不应调用本接口。与日志一样，键或值没有 SnapshotCodec 时不能使用。
+     */
+    bool save_incremental_snapshot(const std::string &file_name, size_t max_deltas = kMaxDeltaChain);
+
+    /**
+     * @brief 压缩增量快照：立即写一个新的基准快照并开始新链
+     * 
+     * 基准按一致性视图写出，不阻塞写操作；变更日志在打开视图的同一次加锁内清空，基准加上之后的增量恰好覆盖所有写操作。
+     * 新清单提交后删除旧链的基准与增量。
+     * 
+     * @param file_name 清单文件路径
+     * @return bool 成功返回 true；失败时旧链保持不变
+     */
+    bool compact_incremental_snapshot(const std::string &file_name);
+
+    /**
+     * @brief 加载增量快照：加载清单指向的基准，再按序号依次应用链上的增量
+     * 
+     * 先在写锁外校验基准与所有增量，并把增量按序折叠为一组区间墓碑与逐键的最终结果
+     * (每个增量先清空(如果记录了清空)，再删除各区间，最后逐键写入或删除)；
+     * 再与基准的有序记录归并，在一次写锁内从空跳表顺序构建。
+     * 
+     * @param file_name save_incremental_snapshot 写出的清单
+     * @return bool 加载成功返回 true；跳表非空，清单、基准或任一增量缺失、损坏时返回 false 且不导入任何数据
+     * 
+     * @note 只能加载到空跳表。加载不接续磁盘上的链，之后的第一次 save_incremental_snapshot 会写一个新的基准。
+     */
+    bool load_incremental_snapshot(const std::string &file_name);
+
+    /**
+     * @brief 挂接预写日志
+     * 
+     * 挂接后 insert/update/delete/clear 以及批量插入在写锁内追加日志记录，释放写锁后按日志的落盘策略等待。
+     * 日志写出或 fsync 失败后拒绝追加，写操作仍在内存中生效但不再被记录：记录了日志的写操作(包括过期删除、
+     * 预算淘汰与快照加载)在释放写锁后抛出 WalCommitError，此时 checkpoint() 也返回 false。
+     * 
+     * @param wal 已 open() 的日志；传入 nullptr 取消挂接。日志的生命周期必须长于挂接期间
+     */
+    void attach_wal(WriteAheadLog<K, V> *wal);
+
+    /**
+     * @brief 启动时恢复数据：加载快照，重放日志，然后开启新的日志段并挂接
+     * 
+     * @param snapshot_file 最近一次检查点的快照文件，不存在时只重放日志
+     * @param wal 尚未 open() 的日志
+     * @return bool 快照存在但无法加载，或日志无法打开时返回 false
+     */
+    bool recover(const std::string &snapshot_file, WriteAheadLog<K, V> &wal);
+
+    /**
+     * @brief 检查点：切换日志段，保存快照，然后删除已包含在快照中的旧日志段
+     * 
+     * 保存期间写操作照常进行并写入新段，恢复时从快照重放新段即可。
+     * 
+     * @param snapshot_file 快照文件路径
+     * @return bool 成功返回 true；失败时旧日志段保留，不影响恢复
+     */
+    bool checkpoint(const std::string &snapshot_file);
+
+    /**
+     * @brief 比较当前跳表与另一个跳表的最低层中的键值对是否完全一致。
+     * 
+     * @details
+     * 此方法执行一个逐节点对比的操作，比较每个节点的键和值：
+     * - 如果所有对应节点的键和值均相等，则认为两个跳表在最低层是一致的。
+     * - 如果在任何点上发现键或值不相等，或者两个跳表的节点数量不同，则认为它们不一致。
+     * 
+     * @tparam K 键的类型。
+     * @tparam V 值的类型。
+     * @param other 与当前跳表进行对比的另一个跳表对象的引用。
+     * @return 如果两个跳表在最低层完全一致，则返回true；否则返回false。
+     */
+    bool skiplist_equals(const SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>& other) const;
+
+    /**
+     * @brief 进入无锁读临界区
+     * 
+     * 守卫存活期间，本线程读到的节点即使被并发删除也不会被释放。
+     * 查询接口内部已经各自持有守卫，只有需要在多次调用之间保留节点指针(例如 search_element_value 的返回值)时才需要显式使用。
+     * 
+     * @return ReadGuard 离开作用域时自动退出临界区；未启用无锁读模式时不登记纪元，锁策略要求共享读时同时持有共享锁
+     */
+    ReadGuard read_guard();
+
+    /**
+     * @brief 获取节点分配器
+     * 
+     * @return Alloc& 跳表使用的节点分配器
+     */
+    Alloc &get_allocator();
+
+private:
+    void get_key_value_from_string(const std::string& str, std::string* key, std::string* value);   //  从字符串提取键值对
+    bool is_valid_string(const std::string& str);   //  检查字符串是否有效
+
+private:
+    //  跳表最大层级数
+    int _max_level;
+
+    // 随机层级生成器
+    LevelGenerator _level_generator;
+
+    // 跳表当前层级数，无锁读者从这一层开始下降
+    std::atomic<int> _skip_list_level;
+
+    // 指向跳表头结点的指针
+    Node<K, V, Features> *_header;
+
+    // 输入输出流
+    std::ofstream _file_writer;
+    std::ifstream _file_reader;
+
+    // 跳表中元素的数量，只在写锁内修改；size() 与排名查询在写锁外读取
+    std::atomic<int> _element_count;
+
+    // 是否启用无锁读模式
+    bool _lock_free_read;
+
+    // 保护写操作的锁，每个实例独立
+    LockPolicy _lock;
+
+    // 被删除节点的延迟回收域
+    EpochDomain _epoch;
+
+    // 节点分配器
+    Alloc _allocator;
+
+    // multi_get 同时推进的查找个数
+    static constexpr size_t kMultiGetLanes = 16;
+
+    // 排名查询乐观读取的最多尝试次数，之后改为在写锁内查询
+    static constexpr int kRankQueryAttempts = 16;
+
+    // 写操作序号：修改跨度、链接或元素计数期间为奇数，排名查询据此判断读到的跨度是否一致
+    std::atomic<uint64_t> _span_seq;
+    int _span_write_depth;  // 嵌套的 SpanWrite 层数，只在写锁内访问
+
+    /**
+     * @brief 修改跨度的作用域，只在写锁内使用
+     *
+     * 最外层进入时把 _span_seq 变为奇数，最外层退出时变回偶数；嵌套使用时(例如插入之后的淘汰)只计一次。
+     * 没有排名时跨度不存在，什么也不做。
+     */
+    class SpanWrite
+    {
+    public:
+        explicit SpanWrite(SkipList &list) : _list(list)
+        {
+            if constexpr (Features::kRank)
+            {
+                if (_list._span_write_depth++ == 0)
+                {
+                    _list._span_seq.fetch_add(1, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_release);
+                }
+            }
+        }
+
+        ~SpanWrite()
+        {
+            if constexpr (Features::kRank)
+            {
+                if (--_list._span_write_depth == 0)
+                {
+                    _list._span_seq.fetch_add(1, std::memory_order_release);
+                }
+            }
+        }
+
+        SpanWrite(const SpanWrite &) = delete;
+        SpanWrite &operator=(const SpanWrite &) = delete;
+
+    private:
+        SkipList &_list;
+    };
+
+    // 在跨度一致的快照上执行排名查询：读守卫内乐观读取并校验写操作序号，多次被打断后改为持有写锁
+    template<typename Query>
+    auto rank_query(Query query);
+
+    // save_to_json 的输出缓冲区字节数
+    static constexpr size_t kJsonWriteBufferSize = 4 << 20;
+
+    // load_from_json 每批插入的键值对个数
+    static constexpr size_t kJsonLoadBatch = 1 << 16;
+
+    // save_partitioned_snapshot 选分界节点时每个分区至少的样本数，样本越多各分区大小越接近
+    static constexpr size_t kPartitionSamples = 8;
+
+    // 键比较器
+    Compare _compare;
+
+    // node 是第一个不小于 key 的节点时，判断它的键是否与 key 等价
+    template<typename Key>
+    bool key_matches(const Node<K, V, Features> *node, const Key &key) const;
+
+    // 查找用的键：比较器透明或 Key 就是 K 时直接引用调用者的键，否则转换为 K
+    template<typename Key>
+    decltype(auto) lookup_key(const Key &key) const;
+
+    // 预写日志，未挂接时为空
+    WriteAheadLog<K, V> *_wal;
+
+    // 一条增量链上默认最多的增量数
+    static constexpr size_t kMaxDeltaChain = 32;
+
+    // 变更日志，第一次增量保存时创建；写者在写锁内记录，保存时在写锁内换出
+    std::unique_ptr<ChangeLog<K, V, Compare>> _change_log;
+
+    // 增量链的状态，只在持有 _delta_mutex 时访问
+    std::mutex _delta_mutex;        // 串行化增量保存
+    std::string _delta_file;        // 当前链的清单路径
+    uint64_t _delta_chain;          // 当前链编号，0 表示没有可接续的链，下一次保存需要压缩
+    uint64_t _delta_sequence;       // 链上已写出的增量数
+    uint64_t _delta_bytes;          // 链上已写出的增量字节数
+    uint64_t _delta_base_bytes;     // 基准快照的记录区字节数
+
+    // 写出新的基准快照并提交新链；调用者持有 _delta_mutex
+    bool write_delta_base(const std::string &file_name);
+
+    /**
+     * @brief 一致性视图的状态，由打开视图的线程持有，写者在写锁内通过 _view 访问
+     */
+    struct ViewState
+    {
+        uint64_t version;                               // 视图版本号，版本号不大于它的节点可见
+        std::mutex mutex;                               // 保护 preserved
+        std::map<K, Node<K, V, Features>*, Compare> preserved;    // 视图打开后被删除或替换的可见节点，每个键至多一个
+        std::atomic<size_t> preserved_count{0};         // preserved 的元素个数，读者据此判断是否需要重新查找
+        std::vector<Node<K, V, Features>*> retained;              // 视图打开后被删除的不可见节点，读者可能正停留在上面
+    };
+
+    // 跳表版本号，每打开一个视图加一
+    uint64_t _version;
+
+    // 当前打开的视图，没有时为空
+    ViewState *_view;
+
+    // 视图互斥：同一时刻只有一个视图，clear() 等待视图关闭
+    std::mutex _view_gate;
+
+    // 写锁外正在分配或释放节点的操作数，clear() 只在为 0 时整块归还内存
+    std::atomic<int> _allocator_users;
+
+    // clear() 在写锁内等待读者离开以整块归还内存的最多尝试次数
+    static constexpr int kBulkReleaseAttempts = 64;
+
+    // 过期时间轮，第一次设置过期时间时创建；锁顺序为先 _lock 后 _wheel_mutex
+    std::unique_ptr<TimingWheel<K>> _wheel;
+    std::mutex _wheel_mutex;
+
+    // 过期服务的运行状态
+    std::mutex _expiry_mutex;
+    std::condition_variable _expiry_cv;
+    bool _expiry_running;   // 后台任务已提交且尚未退出
+    bool _expiry_stop;      // 请求后台任务退出
+
+    // 每次加写锁最多删除的过期键个数
+    static constexpr size_t kExpireBatch = 64;
+
+    // 内存预算与当前占用(字节)，预算为 0 表示不限制
+    std::atomic<size_t> _memory_budget;
+    std::atomic<size_t> _memory_bytes;
+
+    // CLOCK 时钟指针：下一次淘汰从第一个不小于该键的节点开始，_clock_hand_valid 为 false 时从表头开始
+    K _clock_hand;
+    bool _clock_hand_valid;
+
+    // 计算节点计入内存预算的字节数
+    static size_t node_charge(const Node<K, V, Features> *node);
+
+    using HashIndex = NodeHashIndex<K, Node<K, V, Features>, Hash>;
+
+    // 哈希索引，未开启时为空；写者在写锁内修改，读者以 acquire 语义读取
+    std::atomic<HashIndex *> _hash_index;
+
+    // 在索引中查找与 key 等价且未过期的节点
+    template<typename Key>
+    Node<K, V, Features> *index_find(const HashIndex *index, const Key &key) const;
+
+    // 布隆过滤器，未开启时为空；写者在写锁内修改，读者以 acquire 语义读取
+    std::atomic<CountingBloomFilter *> _bloom_filter;
+
+    // 计算键在过滤器中使用的哈希值
+    template<typename Key>
+    static uint64_t filter_hash(const Key &key);
+
+    // 发布新的过滤器，旧过滤器在读者离开后释放
+    void install_bloom_filter(CountingBloomFilter *filter);
+    static void free_bloom_filter(void *filter, void *context);
+
+    // 在写锁内定位 key 对应的未过期节点，找不到时返回 nullptr。
+    // 有索引且节点可以原地修改时由索引直接定位，update 不填写；否则下降并填写 update 供写时复制替换
+    template<typename Key>
+    Node<K, V, Features> *find_for_update(const Key &key, Node<K, V, Features> **update);
+
+    // 退休回调：释放关闭的索引
+    static void free_index(void *index, void *context);
+
+    // 查询命中时置位访问位；已置位时只读不写，避免读者之间争用缓存行
+    static void mark_referenced(Node<K, V, Features> *node);
+
+    // 在写锁内按 CLOCK 淘汰节点，直到内存占用不超过预算；protect 是刚插入的节点，本次不淘汰
+    void evict_to_budget(WalTicket<K, V> &ticket, const Node<K, V, Features> *protect = nullptr);
+
+    // 当前时间(steady_clock 毫秒)，与 Node::expire_at 使用同一时钟
+    static uint64_t now_ms();
+
+    // 节点设置了过期时间且已经过期
+    static bool is_expired(const Node<K, V, Features> *node);
+
+    // 在写锁内登记过期时间
+    void schedule_expiry(const K &key, uint64_t deadline);
+
+    // 过期服务的主循环
+    void expiry_loop(std::chrono::milliseconds interval);
+
+    // 在写锁内插入，新节点的过期时间为 expire_at(0 表示不过期)
+    template<typename... Args>
+    int emplace_until(uint64_t expire_at, K key, Args &&...args);
+
+    // 在写锁内摘除一个节点，update 为节点在各层的前驱；记录删除日志并退休节点
+    void unlink_node(Node<K, V, Features> *node, Node<K, V, Features> **update, WalTicket<K, V> &ticket);
+
+    // 在写锁内、摘除节点之前调用：有视图时节点交给视图保管并返回 true，否则返回 false 由调用者退休
+    bool preserve_for_view(Node<K, V, Features> *node);
+
+    // 在写锁内修改节点的值，update 为节点在各层的前驱；节点可能被无锁读者或视图读取时用新节点替换
+    void assign_value(Node<K, V, Features> *node, Node<K, V, Features> **update, V value);
+
+    // 节点的值能否原地修改：没有无锁读者，且节点对当前视图不可见
+    bool can_assign_in_place(const Node<K, V, Features> *node) const;
+
+    // 在写锁内打开视图；节点不带版本号时不登记视图，而是接管 lock，持有写锁直到 close_view
+    void open_view(ViewState &view, std::unique_lock<LockPolicy> &lock);
+
+    // 注销视图并退休视图保管的节点
+    void close_view(ViewState &view);
+
+    // 在视图上按键递增访问 [lo, hi) 内的可见元素，live 是链上第一个可能落在区间内的节点；lo/hi 为空表示不设界
+    template<typename Callback>
+    size_t view_for_each(ViewState &view, Node<K, V, Features> *live, const K *lo, const K *hi, Callback &callback);
+
+    // 把 for_each 访问到的键值对写成一个快照文件(先写 .tmp 再替换)；filter 非空时一并写出过滤器段
+    template<typename ForEach>
+    bool write_snapshot_file(const std::string &file_name, ForEach for_each, CountingBloomFilter *filter, SnapshotHeader &header);
+
+    /**
+     * @brief 写锁外使用分配器的作用域
+     *
+     * 在写锁内调用 acquire() 登记，离开作用域时注销；登记与 clear() 的检查由写锁排序，
+     * 已登记的操作结束之前 clear() 不会整块归还它正在使用的内存块。
+     */
+    class AllocatorUse
+    {
+    public:
+        AllocatorUse() = default;
+        AllocatorUse(const AllocatorUse &) = delete;
+        AllocatorUse &operator=(const AllocatorUse &) = delete;
+
+        ~AllocatorUse()
+        {
+            if (_users != nullptr)
+            {
+                _users->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        void acquire(std::atomic<int> &users)
+        {
+            users.fetch_add(1, std::memory_order_relaxed);
+            _users = &users;
+        }
+
+    private:
+        std::atomic<int> *_users = nullptr;
+    };
+
+    /**
+     * @brief 分区快照中一个段构建出的有序链，尚未接入跳表
+     */
+    struct SortedRun
+    {
+        std::vector<Node<K, V, Features>*> head;  // 各层的第一个节点，该层没有节点时为空
+        std::vector<Node<K, V, Features>*> tail;  // 各层的最后一个节点
+        std::vector<int> head_rank;     // head[i] 在段内的排名，从 1 开始
+        std::vector<int> tail_rank;     // tail[i] 在段内的排名
+        int count = 0;                  // 节点数
+        size_t charge = 0;              // 节点计入内存预算的字节数之和
+    };
+
+    // 映射并校验一个段，把记录构建为有序链；只分配节点、不访问跳表的链，不需要持有写锁，
+    // 多个线程可以同时为不同的段调用。levels 是调用者复制的层级生成器，构建期间修改晋升概率不影响它
+    bool build_sorted_run(const std::string &file_name, const SnapshotSegmentInfo &segment, const LevelGenerator &levels, SortedRun &run);
+
+    // 把已校验的记录区解码为有序链，遇到无法解码的记录返回 false，已构建的节点留在 run 中由调用者释放
+    bool decode_sorted_run(const char *payload, size_t payload_bytes, const LevelGenerator &levels, SortedRun &run);
+
+    // 把写锁外构建好的有序链导入跳表：加锁后跳表为空时整段拼接，否则取出键值对走有序插入路径。返回插入个数，runs 被消费。
+    // filter 非空且整段拼接时，用它替换当前的布隆过滤器
+    int import_sorted_runs(std::vector<SortedRun> &runs, WalTicket<K, V> &ticket, std::unique_ptr<CountingBloomFilter> *filter = nullptr);
+
+    // 在写锁内把各段的有序链按顺序首尾相接，接入空跳表，返回接入的节点数；调用者同时持有 _view_gate
+    int stitch_sorted_runs(std::vector<SortedRun> &runs, WalTicket<K, V> &ticket);
+
+    // 释放尚未接入跳表的有序链
+    void free_sorted_run(SortedRun &run);
+
+    // 在写锁内追加一条日志记录；end_key 只用于区间删除
+    WalTicket<K, V> log_operation(WalOp op, const K *key, const V *value, const K *end_key = nullptr);
+
+    // 摘除 [lo, hi) 或 [lo, hi] 内的整段节点，并在写锁外释放
+    template<typename Lo, typename Hi>
+    int remove_range(const Lo &lo, const Hi &hi, bool inclusive);
+
+    // 分配并构造节点，不登记版本号；尚未接入跳表的节点可以在写锁外创建
+    Node<K, V, Features> *allocate_node(K k, V v, int level);
+
+    // 析构节点并将内存归还分配器
+    void destroy_node(Node<K, V, Features> *node);
+
+    // 映射快照文件并校验文件头与记录区校验和，记录区位于 file.data() + sizeof(header)
+    bool map_snapshot(const std::string &file_name, MappedFile &file, SnapshotHeader &header);
+
+    // 析构或 clear() 独占分配器时释放从头节点开始的整条第 0 层链；分配器支持整块释放时只析构节点，最后统一归还内存
+    void free_chain(Node<K, V, Features> *first);
+
+    // 退休回调：释放节点，context 为节点所属的跳表
+    static void free_node(void *node, void *context);
+
+    // 释放或延迟释放一个已从所有层摘除的节点
+    void retire_node(Node<K, V, Features> *node);
+
+    // 在 update[] 之后链入新节点并维护跨度；update_rank[i] 是 update[i] 的排名，list_level 是插入前的层数
+    void link_node(Node<K, V, Features> *node, Node<K, V, Features> **update, int *update_rank, int list_level);
+
+    // 沿跨度下降到排名为 rank 的节点(从 1 开始)，rank 越界时返回 nullptr；调用者持有写锁或在 rank_query 内调用
+    Node<K, V, Features> *node_at_rank(int rank);
+
+    // 统计键小于 key 的节点数；调用者持有写锁或在 rank_query 内调用
+    template<typename Key>
+    int count_less(const Key &key);
+
+    // 从 node 开始沿最底层顺序访问，visit 返回 false 时停止
+    template<bool Prefetch, typename Visitor>
+    static void walk_from(Node<K, V, Features> *node, Visitor visit);
+
+    // 在写锁内按顺序插入一段按键有序的键值对，返回插入个数
+    template<typename ForwardIt>
+    int insert_sorted(ForwardIt first, ForwardIt last, WalTicket<K, V> &ticket);
+
+    // 空跳表的批量构建：按层维护尾指针顺序追加
+    template<typename ForwardIt>
+    int bulk_build(ForwardIt first, ForwardIt last, WalTicket<K, V> &ticket);
+};
+
+// 创建一个新节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+Node<K, V, Features>* SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::create_node(K k, V v, int level)
+{
+    Node<K, V, Features> *n = allocate_node(std::move(k), std::move(v), level);
+    if constexpr (Features::kViews)
+    {
+        n->version = _version;  //  在写锁内创建，打开视图之后创建的节点对该视图不可见
+    }
+    return n;
+}
+
+// 分配并构造节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+Node<K, V, Features>* SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::allocate_node(K k, V v, int level)
+{
+    // 节点与尾部指针数组一次分配，原位构造
+    void *memory = _allocator.allocate(Node<K, V, Features>::storage_size(level));
+    Node<K, V, Features> *n = new (memory) Node<K, V, Features>(std::move(k), std::move(v), level);
+    if constexpr (Features::kMemoryBudget)
+    {
+        n->charge = node_charge(n);
+    }
+    return n;
+}
+
+// 置位访问位，节点不带访问位时什么也不做
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::mark_referenced(Node<K, V, Features> *node)
+{
+    if constexpr (Features::kMemoryBudget)
+    {
+        if (!node->referenced.load(std::memory_order_relaxed))
+        {
+            node->referenced.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+// 节点本身加上键和值的堆内存
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+size_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::node_charge(const Node<K, V, Features> *node)
+{
+    return Node<K, V, Features>::storage_size(node->node_level)
+        + HeapUsage<K>::bytes(node->get_key())
+        + HeapUsage<V>::bytes(node->get_value());
+}
+
+// 析构节点并归还内存
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::destroy_node(Node<K, V, Features> *node)
+{
+    size_t bytes = Node<K, V, Features>::storage_size(node->node_level);
+    node->~Node<K, V, Features>();
+    _allocator.deallocate(node, bytes);
+}
+
+// 释放整条第 0 层链
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::free_chain(Node<K, V, Features> *first)
+{
+    if constexpr (Alloc::kBulkRelease)
+    {
+        // 分配器整块回收内存，只需要为非平凡类型调用析构函数
+        if constexpr (!std::is_trivially_destructible<Node<K, V, Features>>::value)
+        {
+            while (first != nullptr)
+            {
+                Node<K, V, Features> *next = first->get_next(0);
+                first->~Node<K, V, Features>();
+                first = next;
+            }
+        }
+        _allocator.release();
+    }
+    else
+    {
+        while (first != nullptr)
+        {
+            Node<K, V, Features> *next = first->get_next(0);
+            destroy_node(first);
+            first = next;
+        }
+    }
+}
+
+// 根据给定键值对，将元素插入到跳表中
+// return 1 意味着 元素已在跳表中
+// return 0 意味着 元素插入成功
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::insert_element(K key, V value)
+{
+    return emplace(std::move(key), std::move(value));
+}
+
+// 插入带过期时间的键值对
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::insert_element(K key, V value, std::chrono::milliseconds ttl)
+{
+    static_assert(Features::kExpiry, "TTL requires Features::kExpiry");
+    uint64_t deadline = now_ms() + static_cast<uint64_t>(std::max<int64_t>(ttl.count(), 0));
+    return emplace_until(deadline, std::move(key), std::move(value));
+}
+
+// 键不存在时由 args 构造值并插入
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename... Args>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::emplace(K key, Args &&...args)
+{
+    return emplace_until(0, std::move(key), std::forward<Args>(args)...);
+}
+
+// 插入节点并设置过期时间
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename... Args>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::emplace_until(uint64_t expire_at, K key, Args &&...args)
+{
+
+    WalTicket<K, V> ticket;
+    _lock.lock(); // 加互斥锁，保障并发安全
+
+    //  有索引时已存在且未过期的键直接返回，不必下降
+    if (HashIndex *index = _hash_index.load(std::memory_order_relaxed))
+    {
+        if (index_find(index, key) != nullptr)
+        {
+            _lock.unlock();
+            return 1;
+        }
+    }
+
+    Node<K, V, Features> *current = this->_header;
+
+    //  update数组保存插入节点的前一个节点
+    Node<K, V, Features> *update[_max_level+1];
+    memset(update, 0, sizeof(Node<K, V, Features>*)*(_max_level+1));  //  初始化NULL
+    int update_rank[_max_level+1];  //  update[i] 的排名，头节点为 0
+
+    // 从跳表的最高层级开始
+    int top_level = _skip_list_level.load(std::memory_order_relaxed);
+    for(int i = top_level; i >= 0; i--)
+    {
+        update_rank[i] = i == top_level ? 0 : update_rank[i + 1];
+        //  当前层下一节点存在 且 下一节点的key 小于 参数key
+        while(current->get_next(i) != NULL && key_less(current->get_next(i)->get_key(), key))
+        {
+            //  向右走
+            if constexpr (Features::kRank)
+            {
+                update_rank[i] += current->get_span(i);
+            }
+            current = current->get_next(i);
+        }
+        update[i] = current;    //  更新update数组 当前层的节点
+    }
+
+    // 达到最底层，将current指向插入位置右侧节点
+    current = current->get_next(0);
+
+    //  键已过期但尚未被过期服务删除：先摘除旧节点，前驱与排名不变，随后在同一位置插入
+    if (key_matches(current, key) && is_expired(current))
+    {
+        unlink_node(current, update, ticket);
+        current = update[0]->get_next(0);
+    }
+
+    // 如果当前节点存在 且 key==传入的参数key
+    if (key_matches(current, key))
+    {
+        //std::cout << "key: " << key << ", exists" << std::endl;
+        _lock.unlock();   //  解锁互斥量
+        return 1;   //  元素已在跳表中(根据key判断)
+    }
+
+    // 如果 current 为 NULL ，说明到达当前层尾部
+    //  如果 current 的键值不等于 key，意味着 需要在 update[0] 和 current 节点之间插入新节点
+    if (!key_matches(current, key))
+    {
+
+        // 生成一个随机层级用于新节点
+        int random_level = get_random_level();
+
+        int list_level = _skip_list_level.load(std::memory_order_relaxed);
+
+        // 创建一个具有随机层级的新节点
+        Node<K, V, Features>* inserted_node = create_node(std::move(key), V(std::forward<Args>(args)...), random_level);
+        if constexpr (Features::kExpiry)
+        {
+            inserted_node->expire_at.store(expire_at, std::memory_order_relaxed);   //  随链接一起以 release 语义发布
+        }
+
+        // 插入节点：先填好新节点自身的后继，再自底向上发布，读者看到链接时节点内容已经完整
+        SpanWrite span_write(*this);    //  链接、层数与元素计数一起变化
+        link_node(inserted_node, update, update_rank, list_level);
+        if constexpr (Features::kExpiry)
+        {
+            if (expire_at != 0)
+            {
+                schedule_expiry(inserted_node->get_key(), expire_at);
+            }
+        }
+
+        if (random_level > list_level)
+        {
+            _skip_list_level.store(random_level, std::memory_order_release);    //  更新跳表层数
+        }
+        //std::cout << "Successfully inserted key:" << key << ", value:" << value << std::endl;
+        _element_count.fetch_add(1, std::memory_order_relaxed);
+        ticket = log_operation(WalOp::Insert, &inserted_node->get_key(), &inserted_node->get_value());
+        evict_to_budget(ticket, inserted_node);
+    }
+    _lock.unlock();
+    ticket.commit_or_throw();    //  释放写锁后再等待日志落盘，其他写者可以并发追加
+    return 0;   //  表示插入成功
+}
+
+// 批量插入键值对，有序输入直接插入，否则先排序
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename InputIt>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::insert_batch(InputIt first, InputIt last)
+{
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    auto pair_less = [this](const auto &a, const auto &b) { return key_less(a.first, b.first); };
+
+    // 可多次遍历且已按键有序的输入无需拷贝
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value)
+    {
+        if (std::is_sorted(first, last, pair_less))
+        {
+            WalTicket<K, V> ticket;
+            int inserted;
+            {
+                std::lock_guard<LockPolicy> lock(_lock);
+                inserted = insert_sorted(first, last, ticket);
+            }
+            ticket.commit_or_throw();    //  整批只等待一次落盘
+            return inserted;
+        }
+    }
+
+    // 排序在锁外完成，不阻塞其他写者
+    std::vector<std::pair<K, V>> items(first, last);
+    std::stable_sort(items.begin(), items.end(), pair_less);
+
+    WalTicket<K, V> ticket;
+    int inserted;
+    {
+        std::lock_guard<LockPolicy> lock(_lock);
+        inserted = insert_sorted(items.begin(), items.end(), ticket);
+    }
+    ticket.commit_or_throw();    //  整批只等待一次落盘
+    return inserted;
+}
+
+// 按键递增顺序插入，复用上一个键的 update[] 作为查找起点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename ForwardIt>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::insert_sorted(ForwardIt first, ForwardIt last, WalTicket<K, V> &ticket)
+{
+    SpanWrite span_write(*this);
+    if (_header->get_next(0) == nullptr)
+    {
+        return bulk_build(first, last, ticket);
+    }
+
+    Node<K, V, Features> *update[_max_level+1];
+    int update_rank[_max_level+1];
+    int list_level = _skip_list_level.load(std::memory_order_relaxed);
+    for (int i = 0; i <= _max_level; i++)
+    {
+        update[i] = _header;    //  头节点对任何键都是合法的前驱
+        update_rank[i] = 0;
+    }
+
+    int inserted = 0;
+    for (; first != last; ++first)
+    {
+        const K &key = first->first;
+
+        //  找到手指失效的层：该层前驱的后继仍小于 key，需要继续向右。
+        //  某层失效时其下所有层必然失效，因此失效层总是 [0, stale) 这一段
+        int stale = 0;
+        while (stale <= list_level)
+        {
+            Node<K, V, Features> *next = update[stale]->get_next(stale);
+            if (next == nullptr || !key_less(next->get_key(), key))
+            {
+                break;
+            }
+            stale++;
+        }
+
+        //  从最高的失效层开始下降，只重新定位失效的层
+        if (stale > 0)
+        {
+            Node<K, V, Features> *current = update[stale - 1];
+            int current_rank = update_rank[stale - 1];
+            for (int i = stale - 1; i >= 0; i--)
+            {
+                Node<K, V, Features> *next = current->get_next(i);
+                while (next != nullptr && key_less(next->get_key(), key))
+                {
+                    if constexpr (Features::kRank)
+                    {
+                        current_rank += current->get_span(i);
+                    }
+                    current = next;
+                    next = current->get_next(i);
+                }
+                update[i] = current;
+                update_rank[i] = current_rank;
+            }
+        }
+
+        Node<K, V, Features> *current = update[0]->get_next(0);
+        if (key_matches(current, key) && is_expired(current))
+        {
+            unlink_node(current, update, ticket);   //  与 insert_element 一致，过期的旧节点先摘除
+            list_level = _skip_list_level.load(std::memory_order_relaxed);
+            current = update[0]->get_next(0);
+        }
+        if (key_matches(current, key))
+        {
+            continue;   //  键已存在(包括批内重复的键)，与 insert_element 一致不覆盖
+        }
+
+        int random_level = get_random_level();
+        Node<K, V, Features> *inserted_node = create_node(key, first->second, random_level);
+
+        //  先填好新节点自身的后继，再自底向上发布
+        link_node(inserted_node, update, update_rank, list_level);
+        if (random_level > list_level)
+        {
+            list_level = random_level;
+            _skip_list_level.store(list_level, std::memory_order_release);
+        }
+        _element_count.fetch_add(1, std::memory_order_relaxed);
+        inserted++;
+        ticket = log_operation(WalOp::Insert, &key, &first->second);
+    }
+    evict_to_budget(ticket);    //  整批插入之后一次淘汰
+    return inserted;
+}
+
+// 空跳表的批量构建：每层记录当前尾节点，新节点直接接在各层尾部，不需要任何查找
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename ForwardIt>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::bulk_build(ForwardIt first, ForwardIt last, WalTicket<K, V> &ticket)
+{
+    Node<K, V, Features> *tail[_max_level+1];
+    int tail_rank[_max_level+1];    //  tail[i] 的排名，头节点为 0
+    for (int i = 0; i <= _max_level; i++)
+    {
+        tail[i] = _header;
+        tail_rank[i] = 0;
+    }
+
+    int list_level = _skip_list_level.load(std::memory_order_relaxed);
+    int inserted = 0;
+    for (; first != last; ++first)
+    {
+        //  输入有序，重复的键一定紧挨在一起
+        if (tail[0] != _header && !key_less(tail[0]->get_key(), first->first))
+        {
+            continue;
+        }
+
+        int random_level = get_random_level();
+        Node<K, V, Features> *inserted_node = create_node(first->first, first->second, random_level);
+        if (CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_relaxed))
+        {
+            filter->add(filter_hash(inserted_node->get_key()));
+        }
+        int rank = inserted + 1;
+        for (int i = 0; i <= random_level; i++)
+        {
+            if constexpr (Features::kRank)
+            {
+                tail[i]->set_span(i, rank - tail_rank[i]);
+            }
+            tail[i]->set_next(i, inserted_node);    //  新节点的后继在构造时已为空
+            tail[i] = inserted_node;
+            tail_rank[i] = rank;
+        }
+        if (random_level > list_level)
+        {
+            list_level = random_level;
+        }
+        inserted++;
+        if constexpr (Features::kMemoryBudget)
+        {
+            _memory_bytes.fetch_add(inserted_node->charge, std::memory_order_relaxed);
+        }
+        if (HashIndex *index = _hash_index.load(std::memory_order_relaxed))
+        {
+            index->insert(inserted_node);
+        }
+        ticket = log_operation(WalOp::Insert, &first->first, &first->second);
+    }
+
+    //  各层尾节点的后继为空，跨度为到表尾的节点数
+    if constexpr (Features::kRank)
+    {
+        for (int i = 0; i <= _max_level; i++)
+        {
+            tail[i]->set_span(i, inserted - tail_rank[i]);
+        }
+    }
+
+    //  所有链接发布之后再提升层数，读者从新层数下降时看到的都是完整的链
+    _skip_list_level.store(list_level, std::memory_order_release);
+    _element_count.fetch_add(inserted, std::memory_order_relaxed);
+    evict_to_budget(ticket);
+    return inserted;
+}
+
+// 更新跳表中键为key的节点的值为value
+// 如果跳表中不存在该键，则返回false
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::update_element(const Key &key, V value)
+{
+    const auto &k = lookup_key(key);
+    WalTicket<K, V> ticket;
+    {
+        // 修改值与删除互斥，避免节点在写入过程中被释放
+        std::lock_guard<LockPolicy> lock(_lock);
+        Node<K, V, Features> *update[_max_level+1];   //  各层的前驱，替换节点时使用
+        Node<K, V, Features> *current = find_for_update(k, update);
+
+        // 如果跳表中不存在该键或键已过期，则返回false
+        if (current == nullptr)
+        {
+            return false;
+        }
+
+        // 当前节点的键与搜索的键匹配，先记录日志，再把值移动进节点
+        ticket = log_operation(WalOp::Update, &current->get_key(), &value);
+        assign_value(current, update, std::move(value));
+        evict_to_budget(ticket);
+    }
+    ticket.commit_or_throw();
+    return true;
+}
+
+//更新跳表中键位key的节点的值，并显示详细信息
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::update_element_value(const Key &key, V new_value, V &old_value)
+{
+    const auto &k = lookup_key(key);
+    WalTicket<K, V> ticket;
+    {
+        std::lock_guard<LockPolicy> lock(_lock);  // 与删除互斥，保证找到的节点在修改期间有效
+        Node<K, V, Features> *update[_max_level+1];
+        Node<K, V, Features> *current = find_for_update(k, update);
+
+        if (current == nullptr)
+        {
+            return false; // 未找到元素
+        }
+        old_value = current->get_value();  // 存储旧值
+        ticket = log_operation(WalOp::Update, &current->get_key(), &new_value);  //  节点被替换之前记录
+        assign_value(current, update, new_value);  // 更新为新值
+        evict_to_budget(ticket);
+    }
+    ticket.commit_or_throw();
+
+    // 如有需要，可以在这里输出详细信息
+    std::cout << "Updated key " << key 
+              << " from: " << old_value 
+              << " to: " << new_value << std::endl;
+
+    return true; // 成功找到并更新了元素
+}
+
+// 可视化跳表
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::display_list()
+{
+    LOG_INFO << "Beginning display of SkipList.";
+    std::vector<std::string> lines; // 用于存储每一层的字符串
+    auto guard = read_guard();
+  
+    // 遍历所有层级
+    for (int level = _skip_list_level.load(std::memory_order_acquire); level >= 0; --level)
+    {
+        std::ostringstream oss;
+        oss << "Level " << level << ": ";
+
+        Node<K, V, Features> *node = this->_header->get_next(level);
+        while (node != nullptr)
+        {
+            oss << "|" << node->get_key() << ":" << node->get_value() << " ";
+            node = node->get_next(level);
+        }
+        oss << "|"; // 每层最后添加 "|"
+        lines.push_back(oss.str()); // 将每层的字符串添加到lines中
+    }
+
+    // 找到最长的行
+    std::string title = "***** Skip List *****";
+    size_t max_length = title.size();
+    for (const auto& line : lines)
+    {
+        if (line.size() > max_length)
+        {
+            max_length = line.size();
+        }
+    }
+
+    // 创建标题，并确保它与最长行一样长且居中
+    size_t title_padding = (max_length - title.size()) / 2;
+    std::string full_title = std::string(title_padding, ' ') + title;
+
+    // 如果标题不够长，确保它至少与最长行一样长
+    while (full_title.size() < max_length)
+    {
+        full_title += " "; // 在标题末尾添加空格以确保长度足够
+    }
+
+    std::cout << full_title << '\n';
+
+    // 输出每一层
+    for (const auto& line : lines)
+    {
+        std::cout << line << '\n';
+    }
+    LOG_INFO << "Display of SkipList completed.";
+}
+
+// 内存中数据持久化到本地磁盘中的文件
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::dump_file()
+{
+    LOG_INFO << "Starting dump of SkipList to " << STORE_FILE;
+    std::cout << "dump_file-----------------" << std::endl;
+    //  打开文件
+    _file_writer.open(STORE_FILE);
+    auto guard = read_guard();
+    //  从跳表最底层开始遍历节点，并将键值写入文件
+    for (const Node<K, V, Features> &node : *this)
+    {
+        _file_writer << node.get_key() << ":" << node.get_value() << "\n";
+        std::cout << node.get_key() << ":" << node.get_value() << ";\n";
+    }
+
+    _file_writer.flush();   //  刷新文件输出流
+    _file_writer.close();   //  关闭文件
+}
+
+// 加载本地磁盘 文件中的数据
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::load_file()
+{
+    LOG_INFO << "Starting load data from SkipList " << STORE_FILE;
+    _file_reader.open(STORE_FILE);
+    std::cout << "load_file-----------------" << std::endl;
+    //  保存从文件中读取的数据
+    std::string line;
+
+    /*std::string* key = new std::string();
+    std::string* value = new std::string();*/
+
+    //  使用智能指针管理，防止内存泄露
+    std::unique_ptr<std::string> key(new std::string());
+    std::unique_ptr<std::string> value(new std::string());
+    //  读取到的键值对，读完后整批插入
+    std::vector<std::pair<K, V>> batch;
+    //  逐行读取文件的内容
+    while (getline(_file_reader, line))
+    {
+        get_key_value_from_string(line, key.get(), value.get());    // 从每一行数据中提取键和值
+        // 如果键或值为空，跳过该行数据
+        if (key->empty() || value->empty())
+        {
+            continue;
+        }
+        batch.emplace_back(*key, *value);
+        std::cout << "key:" << *key << "value:" << *value << std::endl;
+    }
+
+    //关闭文件输入流
+    _file_reader.close();
+
+    insert_batch(batch.begin(), batch.end());
+}
+
+//  获取跳表中元素的数量
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::size()
+{
+    return _element_count.load(std::memory_order_relaxed);
+}
+
+//  从字符串中提取key:value
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::get_key_value_from_string(const std::string& str, std::string* key, std::string* value)
+{
+    //  验证字符串是否有效
+    if(!is_valid_string(str))
+    {
+        return;
+    }
+    *key = str.substr(0, str.find(delimiter));  //  获取key部分
+    *value = str.substr(str.find(delimiter)+1, str.length());   //  获取value部分
+}
+
+//  验证字符串是否有效
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::is_valid_string(const std::string& str)
+{
+    // str为空
+    if (str.empty())
+    {
+        return false;
+    }
+    //  str中不包含 : 分隔符
+    if (str.find(delimiter) == std::string::npos)
+    {
+        return false;
+    }
+    return true;
+}
+
+// 从跳表中删除元素
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::delete_element(const Key &key)
+{
+
+    const auto &k = lookup_key(key);
+    WalTicket<K, V> ticket;
+    _lock.lock(); //  互斥锁，保障并发安全性
+
+    //  有索引时不存在的键直接返回；存在时仍需下降找到各层前驱才能摘除
+    HashIndex *index = _hash_index.load(std::memory_order_relaxed);
+    if (index != nullptr && index->find(k, [this](const Node<K, V, Features> *node, const auto &key) {
+            return !key_less(node->get_key(), key) && !key_less(key, node->get_key()); }) == nullptr)
+    {
+        _lock.unlock();
+        return;
+    }
+    //  没有索引时由过滤器排除不存在的键
+    const CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_relaxed);
+    if (index == nullptr && filter != nullptr && !filter->may_contain(filter_hash(k)))
+    {
+        _lock.unlock();
+        return;
+    }
+
+    Node<K, V, Features> *current = this->_header;
+    Node<K, V, Features> *update[_max_level+1];   //  存储需要删除的节点前一个节点
+    memset(update, 0, sizeof(Node<K, V, Features>*)*(_max_level+1));  //初始化为NULL
+
+    // 从跳表的最高层级开始查找需要删除的元素
+    for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+    {
+        //  当前层下一节点存在 且 下一节点key值 小于目标key值
+        while (current->get_next(i) !=NULL && key_less(current->get_next(i)->get_key(), k))
+        {
+            current = current->get_next(i);  //向右走
+        }
+        update[i] = current;    //  更新update数组
+    }
+
+    current = current->get_next(0);
+    //  不为空且键值相等 找到要删除的节点
+    if (key_matches(current, k))
+    {
+        std::cout << "Successfully deleted key "<< current->get_key() << std::endl;
+        unlink_node(current, update, ticket);
+    }
+    _lock.unlock();   //  解锁互斥量
+    ticket.commit_or_throw();
+}
+
+// 摘除一个节点并退休
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::unlink_node(Node<K, V, Features> *node, Node<K, V, Features> **update, WalTicket<K, V> &ticket)
+{
+    SpanWrite span_write(*this);
+    //  有视图时先交给视图保管，再摘除：读者读到摘除后的链接时一定能在视图中找到该节点
+    bool preserved = preserve_for_view(node);
+    if (HashIndex *index = _hash_index.load(std::memory_order_relaxed))
+    {
+        index->erase(node);
+    }
+
+    //  从删除节点的层级开始删除，向更低层级遍历，保证在更低的层级一定满足删除条件
+    //  被摘除节点自身的 forward 保持不变，正停留在它上面的读者仍能继续向右走
+    for(int i=node->node_level;i>=0;i--)
+    {
+        if constexpr (Features::kRank)
+        {
+            update[i]->set_span(i, update[i]->get_span(i) + node->get_span(i) - 1);
+        }
+        update[i]->set_next(i, node->get_next(i));
+    }
+
+    // 删除无元素的层级,从最高层级开始遍历
+    int list_level = _skip_list_level.load(std::memory_order_relaxed);
+    if constexpr (Features::kRank)
+    {
+        for (int i = node->node_level + 1; i <= list_level; i++)
+        {
+            update[i]->set_span(i, update[i]->get_span(i) - 1);   //  更高层跨过被删节点的链接少跨一个节点
+        }
+    }
+    while (list_level > 0 && _header->get_next(list_level) == nullptr)
+    {
+        list_level --;
+    }
+    _skip_list_level.store(list_level, std::memory_order_release);
+
+    //  摘除之后再从过滤器删除，节点仍可达时过滤器不会把它排除
+    if (CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_relaxed))
+    {
+        filter->remove(filter_hash(node->get_key()));
+    }
+    if constexpr (Features::kMemoryBudget)
+    {
+        _memory_bytes.fetch_sub(node->charge, std::memory_order_relaxed);
+    }
+    ticket = log_operation(WalOp::Delete, &node->get_key(), nullptr);    //  节点释放之前记录
+    if (!preserved)
+    {
+        retire_node(node);   // 释放删除的节点的内存(无锁读模式下延迟到读者离开之后)
+    }
+    _element_count.fetch_sub(1, std::memory_order_relaxed);  // 元素计数减一
+}
+
+// 删除 [lo, hi) 区间内的所有元素
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::delete_range(const Key &lo, const Key &hi)
+{
+    const auto &lo_key = lookup_key(lo);
+    const auto &hi_key = lookup_key(hi);
+    if (!key_less(lo_key, hi_key))
+    {
+        return 0;
+    }
+    return remove_range(lo_key, hi_key, false);
+}
+
+// 摘除区间内的整段节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Lo, typename Hi>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::remove_range(const Lo &lo, const Hi &hi, bool inclusive)
+{
+    WalTicket<K, V> ticket;
+    AllocatorUse use;
+    Node<K, V, Features> *first = nullptr;    //  摘下的整段中的第一个节点，需要在写锁外释放时非空
+    int removed = 0;
+    {
+        std::lock_guard<LockPolicy> lock(_lock);
+        SpanWrite span_write(*this);
+        int list_level = _skip_list_level.load(std::memory_order_relaxed);
+        Node<K, V, Features> *before[_max_level+1];   //  每层区间之前的最后一个节点
+        Node<K, V, Features> *last[_max_level+1];     //  每层区间内的最后一个节点，该层没有区间内的节点时等于 before
+        int before_rank[_max_level+1];
+        int last_rank[_max_level+1];
+
+        Node<K, V, Features> *current = _header;
+        int current_rank = 0;
+        for (int i = list_level; i >= 0; i--)
+        {
+            Node<K, V, Features> *next = current->get_next(i);
+            while (next != nullptr && key_less(next->get_key(), lo))
+            {
+                if constexpr (Features::kRank)
+                {
+                    current_rank += current->get_span(i);
+                }
+                current = next;
+                next = current->get_next(i);
+            }
+            before[i] = current;
+            before_rank[i] = current_rank;
+        }
+
+        //  区间终点：每层从上一层的终点与本层的起点中靠右的一个出发，不必回到头节点。
+        //  上一层的终点仍在区间之前时，它不会在本层的起点右侧
+        auto in_range = [&](const K &key) { return inclusive ? !key_less(hi, key) : key_less(key, hi); };
+        current = _header;
+        current_rank = 0;
+        for (int i = list_level; i >= 0; i--)
+        {
+            if (current == _header || key_less(current->get_key(), lo))
+            {
+                current = before[i];
+                current_rank = before_rank[i];
+            }
+            Node<K, V, Features> *next = current->get_next(i);
+            while (next != nullptr && in_range(next->get_key()))
+            {
+                if constexpr (Features::kRank)
+                {
+                    current_rank += current->get_span(i);
+                }
+                current = next;
+                next = current->get_next(i);
+            }
+            last[i] = current;
+            last_rank[i] = current_rank;
+        }
+
+        if constexpr (Features::kRank)
+        {
+            removed = last_rank[0] - before_rank[0];
+        }
+        else
+        {
+            //  没有跨度时沿第 0 层数出区间长度
+            for (Node<K, V, Features> *node = before[0]; node != last[0]; node = node->get_next(0))
+            {
+                removed++;
+            }
+        }
+        if (removed == 0)
+        {
+            return 0;
+        }
+        first = before[0]->get_next(0);
+        ticket = log_operation(WalOp::DeleteRange, &first->get_key(), nullptr, &last[0]->get_key());
+
+        //  在写锁内汇总区间的内存占用并注销索引与过滤器，这是区间删除在写锁内唯一与区间长度成正比的部分。
+        //  占用在摘除时立即扣除，写锁外延迟释放期间 memory_usage() 与淘汰看到的都是摘除后的值。
+        //  区间整段摘除之前注销，并发查询可能提前看不到区间内的键，与删除并发的查询本来就可以返回任一结果
+        HashIndex *index = _hash_index.load(std::memory_order_relaxed);
+        CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_relaxed);
+        size_t charge = 0;
+        Node<K, V, Features> *node = first;
+        for (int n = 0; n < removed; n++)
+        {
+            if constexpr (Features::kMemoryBudget)
+            {
+                charge += node->charge;
+            }
+            if (index != nullptr)
+            {
+                index->erase(node);
+            }
+            if (filter != nullptr)
+            {
+                filter->remove(filter_hash(node->get_key()));
+            }
+            node = node->get_next(0);
+        }
+
+        //  有视图时先交给视图保管，再摘除
+        if (_view != nullptr)
+        {
+            Node<K, V, Features> *node = first;
+            for (int n = 0; n < removed; n++)
+            {
+                Node<K, V, Features> *next = node->get_next(0);
+                preserve_for_view(node);
+                node = next;
+            }
+            first = nullptr;
+        }
+
+        //  自上而下每层改写一个链接；被摘下的节点之间的链接保持不变，停留在其中的读者仍能走出区间
+        for (int i = list_level; i >= 0; i--)
+        {
+            if (last[i] != before[i])
+            {
+                before[i]->set_next(i, last[i]->get_next(i));
+            }
+            if constexpr (Features::kRank)
+            {
+                before[i]->set_span(i, last_rank[i] + last[i]->get_span(i) - before_rank[i] - removed);
+            }
+        }
+        while (list_level > 0 && _header->get_next(list_level) == nullptr)
+        {
+            list_level--;
+        }
+        _skip_list_level.store(list_level, std::memory_order_release);
+        _element_count.fetch_sub(removed, std::memory_order_relaxed);
+        if constexpr (Features::kMemoryBudget)
+        {
+            _memory_bytes.fetch_sub(charge, std::memory_order_relaxed);
+        }
+
+        //  持有守卫的线程不能等待读者离开，只能逐个退休
+        if (first != nullptr && _lock_free_read && _epoch.in_critical_section())
+        {
+            Node<K, V, Features> *node = first;
+            for (int n = 0; n < removed; n++)
+            {
+                Node<K, V, Features> *next = node->get_next(0);
+                retire_node(node);
+                node = next;
+            }
+            first = nullptr;
+        }
+        if (first != nullptr)
+        {
+            use.acquire(_allocator_users);
+        }
+    }
+
+    //  写锁外释放：等待摘除之前进入的读者离开后，整段节点不会再被访问
+    if (first != nullptr)
+    {
+        if (_lock_free_read)
+        {
+            _epoch.wait_for_readers();
+        }
+        for (int n = 0; n < removed; n++)
+        {
+            Node<K, V, Features> *next = first->get_next(0);
+            destroy_node(first);
+            first = next;
+        }
+    }
+    ticket.commit_or_throw();
+    return removed;
+}
+
+// 设置已有键的过期时间
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::expire(const Key &key, std::chrono::milliseconds ttl)
+{
+    static_assert(Features::kExpiry, "TTL requires Features::kExpiry");
+    const auto &k = lookup_key(key);
+    uint64_t deadline = now_ms() + static_cast<uint64_t>(std::max<int64_t>(ttl.count(), 0));
+    std::lock_guard<LockPolicy> lock(_lock);
+    Node<K, V, Features> *current = _header;
+    for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+    {
+        while (current->get_next(i) != nullptr && key_less(current->get_next(i)->get_key(), k))
+        {
+            current = current->get_next(i);
+        }
+    }
+    current = current->get_next(0);
+    if (!key_matches(current, k) || is_expired(current))
+    {
+        return false;
+    }
+    current->expire_at.store(deadline, std::memory_order_relaxed);
+    schedule_expiry(current->get_key(), deadline);  //  原来的条目到期时与新的过期时间不符，自动失效
+    return true;
+}
+
+// 取消已有键的过期时间
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::persist(const Key &key)
+{
+    static_assert(Features::kExpiry, "TTL requires Features::kExpiry");
+    const auto &k = lookup_key(key);
+    std::lock_guard<LockPolicy> lock(_lock);
+    Node<K, V, Features> *current = _header;
+    for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+    {
+        while (current->get_next(i) != nullptr && key_less(current->get_next(i)->get_key(), k))
+        {
+            current = current->get_next(i);
+        }
+    }
+    current = current->get_next(0);
+    if (!key_matches(current, k) || is_expired(current))
+    {
+        return false;
+    }
+    current->expire_at.store(0, std::memory_order_relaxed);     //  时间轮中的条目到期时被忽略
+    return true;
+}
+
+// 推进时间轮并删除到期的键
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+size_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::expire_due()
+{
+    static_assert(Features::kExpiry, "TTL requires Features::kExpiry");
+    uint64_t now = now_ms();
+    std::vector<std::pair<K, uint64_t>> due;
+    {
+        std::lock_guard<std::mutex> wheel_lock(_wheel_mutex);
+        if (!_wheel)
+        {
+            return 0;
+        }
+        _wheel->advance(now, [&due](const K &key, uint64_t deadline) { due.emplace_back(key, deadline); });
+    }
+
+    size_t removed = 0;
+    bool durable = true;
+    uint64_t failed_lsn = 0;    //  第一批没有持久化的日志序号；已从时间轮取出的条目全部处理完再报告
+    for (size_t begin = 0; begin < due.size(); begin += kExpireBatch)
+    {
+        size_t end = std::min(due.size(), begin + kExpireBatch);
+        WalTicket<K, V> ticket;
+        {
+            std::lock_guard<LockPolicy> lock(_lock);
+            Node<K, V, Features> *update[_max_level+1];
+            for (size_t j = begin; j < end; j++)
+            {
+                const K &key = due[j].first;
+                Node<K, V, Features> *current = _header;
+                for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+                {
+                    while (current->get_next(i) != nullptr && key_less(current->get_next(i)->get_key(), key))
+                    {
+                        current = current->get_next(i);
+                    }
+                    update[i] = current;
+                }
+                current = current->get_next(0);
+
+                //  节点的过期时间与条目一致才删除：键被删除后重新插入、被 expire() 延期或 persist() 时条目已失效
+                if (key_matches(current, key)
+                    && current->expire_at.load(std::memory_order_relaxed) == due[j].second
+                    && due[j].second <= now)
+                {
+                    unlink_node(current, update, ticket);
+                    removed++;
+                }
+            }
+        }
+        if (durable && !ticket.commit())
+        {
+            durable = false;
+            failed_lsn = ticket.lsn;
+        }
+    }
+    if (removed > 0)
+    {
+        LOG_DEBUG << "Expired " << removed << " keys";
+    }
+    if (!durable)
+    {
+        throw WalCommitError(failed_lsn);
+    }
+    return removed;
+}
+
+// 向线程池提交过期服务
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Pool>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::start_expiry_service(Pool &pool, std::chrono::milliseconds interval)
+{
+    static_assert(Features::kExpiry, "TTL requires Features::kExpiry");
+    {
+        std::lock_guard<std::mutex> lock(_expiry_mutex);
+        if (_expiry_running)
+        {
+            return;
+        }
+        _expiry_running = true;
+        _expiry_stop = false;
+    }
+    LOG_INFO << "Starting expiry service, interval " << interval.count() << " ms";
+    if constexpr (skiplist_detail::has_enqueue<Pool>::value)
+    {
+        pool.enqueue([this, interval] { expiry_loop(interval); });
+    }
+    else
+    {
+        pool.push([this, interval](int) { expiry_loop(interval); });
+    }
+}
+
+// 停止过期服务
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::stop_expiry_service()
+{
+    std::unique_lock<std::mutex> lock(_expiry_mutex);
+    if (!_expiry_running)
+    {
+        return;
+    }
+    _expiry_stop = true;
+    _expiry_cv.notify_all();
+    _expiry_cv.wait(lock, [this] { return !_expiry_running; });    //  任务可能还在线程池队列中，等它开始运行并退出
+    LOG_INFO << "Expiry service stopped";
+}
+
+// 过期服务主循环：周期性删除到期的键，直到收到停止请求
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::expiry_loop(std::chrono::milliseconds interval)
+{
+    std::unique_lock<std::mutex> lock(_expiry_mutex);
+    while (!_expiry_stop)
+    {
+        lock.unlock();
+        try
+        {
+            expire_due();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR << "Expiry service error: " << e.what();
+        }
+        lock.lock();
+        _expiry_cv.wait_for(lock, interval, [this] { return _expiry_stop; });
+    }
+    _expiry_running = false;
+    _expiry_cv.notify_all();
+}
+
+// 当前时间(毫秒)
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+uint64_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::now_ms()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// 节点是否已经过期，未设置过期时间的节点不读取时钟，节点不带过期时间时恒为 false
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::is_expired(const Node<K, V, Features> *node)
+{
+    if constexpr (Features::kExpiry)
+    {
+        uint64_t expire_at = node->expire_at.load(std::memory_order_relaxed);
+        return expire_at != 0 && expire_at <= now_ms();
+    }
+    else
+    {
+        return false;
+    }
+}
+
+// 登记过期时间，时间轮在第一次使用时创建
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::schedule_expiry(const K &key, uint64_t deadline)
+{
+    std::lock_guard<std::mutex> wheel_lock(_wheel_mutex);
+    if (!_wheel)
+    {
+        _wheel = std::make_unique<TimingWheel<K>>(1, now_ms());   //  1 毫秒一个 tick，五层覆盖约 12 天，更远的到期时间在最高层轮转
+    }
+    _wheel->schedule(key, deadline);
+}
+
+// 设置内存预算，超出时立即淘汰
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::set_memory_budget(size_t bytes)
+{
+    static_assert(Features::kMemoryBudget, "memory budget requires Features::kMemoryBudget");
+    LOG_INFO << "Setting SkipList memory budget to " << bytes << " bytes";
+    WalTicket<K, V> ticket;
+    {
+        std::lock_guard<LockPolicy> lock(_lock);
+        _memory_budget.store(bytes, std::memory_order_relaxed);
+        evict_to_budget(ticket);
+    }
+    ticket.commit_or_throw();
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+size_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::memory_budget() const
+{
+    return _memory_budget.load(std::memory_order_relaxed);
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+size_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::memory_usage() const
+{
+    static_assert(Features::kMemoryBudget, "memory accounting requires Features::kMemoryBudget");
+    return _memory_bytes.load(std::memory_order_relaxed);
+}
+
+// 开启哈希索引：遍历现有节点建立索引后再发布
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::enable_hash_index()
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    if (_hash_index.load(std::memory_order_relaxed) != nullptr)
+    {
+        return;
+    }
+    LOG_INFO << "Building hash index for " << _element_count.load(std::memory_order_relaxed) << " keys";
+    HashIndex *index = new HashIndex(_lock_free_read ? &_epoch : nullptr);
+    for (Node<K, V, Features> *node = _header->get_next(0); node != nullptr; node = node->get_next(0))
+    {
+        index->insert(node);
+    }
+    _hash_index.store(index, std::memory_order_release);
+}
+
+// 关闭哈希索引，仍在索引上查找的读者离开后再释放
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::disable_hash_index()
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    HashIndex *index = _hash_index.exchange(nullptr, std::memory_order_acq_rel);
+    if (index == nullptr)
+    {
+        return;
+    }
+    if (_lock_free_read)
+    {
+        _epoch.retire(index, &SkipList::free_index, nullptr);
+    }
+    else
+    {
+        delete index;
+    }
+    LOG_INFO << "Hash index disabled";
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::has_hash_index() const
+{
+    return _hash_index.load(std::memory_order_acquire) != nullptr;
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::free_index(void *index, void *)
+{
+    delete static_cast<HashIndex *>(index);
+}
+
+// 开启布隆过滤器：加入现有的所有键后再发布
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::enable_bloom_filter(size_t expected_keys, size_t counters_per_key)
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    if (expected_keys == 0)
+    {
+        expected_keys = std::max<size_t>(static_cast<size_t>(_element_count.load(std::memory_order_relaxed)), 1024);
+    }
+    CountingBloomFilter *filter = new CountingBloomFilter(CountingBloomFilter::blocks_for(expected_keys, counters_per_key),
+                                                          CountingBloomFilter::hashes_for(counters_per_key));
+    LOG_INFO << "Building bloom filter for " << _element_count.load(std::memory_order_relaxed) << " keys, " << filter->block_count() * CountingBloomFilter::kBlockBytes << " bytes";
+    for (Node<K, V, Features> *node = _header->get_next(0); node != nullptr; node = node->get_next(0))
+    {
+        filter->add(filter_hash(node->get_key()));
+    }
+    install_bloom_filter(filter);
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::disable_bloom_filter()
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    if (_bloom_filter.load(std::memory_order_relaxed) != nullptr)
+    {
+        install_bloom_filter(nullptr);
+        LOG_INFO << "Bloom filter disabled";
+    }
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::has_bloom_filter() const
+{
+    return _bloom_filter.load(std::memory_order_acquire) != nullptr;
+}
+
+// 统计信息随过滤器一起释放，读取时需要持有读临界区
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+BloomFilterStats SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::bloom_filter_stats()
+{
+    auto guard = read_guard();
+    const CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_acquire);
+    return filter != nullptr ? filter->stats() : BloomFilterStats();
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+uint64_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::filter_hash(const Key &key)
+{
+    return static_cast<uint64_t>(hash_index_detail::hash_key<K>(Hash(), key));
+}
+
+// 写锁内替换过滤器，仍在旧过滤器上判定的读者离开后再释放
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::install_bloom_filter(CountingBloomFilter *filter)
+{
+    CountingBloomFilter *old_filter = _bloom_filter.exchange(filter, std::memory_order_acq_rel);
+    if (old_filter == nullptr)
+    {
+        return;
+    }
+    if (_lock_free_read)
+    {
+        _epoch.retire(old_filter, &SkipList::free_bloom_filter, nullptr);
+    }
+    else
+    {
+        delete old_filter;
+    }
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::free_bloom_filter(void *filter, void *)
+{
+    delete static_cast<CountingBloomFilter *>(filter);
+}
+
+// 索引查找，键的等价关系沿用比较器
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+Node<K, V, Features> *SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::index_find(const HashIndex *index, const Key &key) const
+{
+    Node<K, V, Features> *node = index->find(key, [this](const Node<K, V, Features> *candidate, const Key &k) {
+        return !key_less(candidate->get_key(), k) && !key_less(k, candidate->get_key());
+    });
+    return node != nullptr && !is_expired(node) ? node : nullptr;
+}
+
+// 写锁内定位待修改的节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+Node<K, V, Features> *SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::find_for_update(const Key &key, Node<K, V, Features> **update)
+{
+    if (const HashIndex *index = _hash_index.load(std::memory_order_relaxed))
+    {
+        Node<K, V, Features> *node = index_find(index, key);
+        if (node == nullptr || can_assign_in_place(node))
+        {
+            return node;    //  原地修改不需要前驱
+        }
+    }
+
+    Node<K, V, Features> *current = _header;
+    for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+    {
+        while (current->get_next(i) != nullptr && key_less(current->get_next(i)->get_key(), key))
+        {
+            current = current->get_next(i);
+        }
+        update[i] = current;
+    }
+    current = current->get_next(0);
+    return key_matches(current, key) && !is_expired(current) ? current : nullptr;
+}
+
+// CLOCK 淘汰：从时钟指针处沿最底层前进，同时维护各层前驱，摘除节点不需要重新下降
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::evict_to_budget(WalTicket<K, V> &ticket, const Node<K, V, Features> *protect)
+{
+    if constexpr (Features::kMemoryBudget)
+    {
+        size_t budget = _memory_budget.load(std::memory_order_relaxed);
+        if (budget == 0 || _memory_bytes.load(std::memory_order_relaxed) <= budget)
+        {
+            return;
+        }
+
+        //  定位时钟指针：update[i] 是第 i 层最后一个键小于指针键的节点。淘汰只会降低层数，
+        //  unlink_node 只访问当前层数以内的 update[i]，从当前层数开始下降即可
+        Node<K, V, Features> *update[_max_level+1];
+        Node<K, V, Features> *current = _header;
+        for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+        {
+            while (_clock_hand_valid && current->get_next(i) != nullptr && key_less(current->get_next(i)->get_key(), _clock_hand))
+            {
+                current = current->get_next(i);
+            }
+            update[i] = current;
+        }
+
+        //  第一圈清除所有访问位，第二圈一定能淘汰，最多走两圈
+        Node<K, V, Features> *node = update[0]->get_next(0);
+        size_t steps = 2 * static_cast<size_t>(_element_count.load(std::memory_order_relaxed)) + 1;
+        int evicted = 0;
+        while (_memory_bytes.load(std::memory_order_relaxed) > budget && _element_count.load(std::memory_order_relaxed) > 0 && steps-- > 0)
+        {
+            if (node == nullptr)
+            {
+                //  走到表尾，回到表头继续
+                for (int i = 0; i <= _max_level; i++)
+                {
+                    update[i] = _header;
+                }
+                node = _header->get_next(0);
+                continue;
+            }
+
+            Node<K, V, Features> *next = node->get_next(0);
+            if (node == protect || node->referenced.load(std::memory_order_relaxed))
+            {
+                node->referenced.store(false, std::memory_order_relaxed);   //  给最近访问过的节点第二次机会
+                for (int i = 0; i <= node->node_level; i++)
+                {
+                    update[i] = node;
+                }
+            }
+            else
+            {
+                unlink_node(node, update, ticket);  //  前驱不变，继续从后继处前进
+                evicted++;
+            }
+            node = next;
+        }
+
+        _clock_hand_valid = node != nullptr;
+        if (_clock_hand_valid)
+        {
+            _clock_hand = node->get_key();
+        }
+        if (evicted > 0)
+        {
+            LOG_DEBUG << "Evicted " << evicted << " keys to fit memory budget of " << budget << " bytes";
+        }
+    }
+}
+
+// 在跳表中根据给定key值搜索元素
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::search_element(const Key &key)
+{
+    const auto &k = lookup_key(key);    //  比较器透明时不构造临时键
+    auto guard = read_guard();      //  进入无锁读临界区，期间节点不会被释放
+
+    //  开启哈希索引时由索引直接定位
+    if (const HashIndex *index = _hash_index.load(std::memory_order_acquire))
+    {
+        Node<K, V, Features> *node = index_find(index, k);
+        if (node != nullptr)
+        {
+            mark_referenced(node);
+        }
+        return node != nullptr;
+    }
+
+    //  过滤器判定不存在时不必下降
+    CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_acquire);
+    if (filter != nullptr && !filter->may_contain(filter_hash(k)))
+    {
+        filter->record_negative();
+        return false;
+    }
+
+    Node<K, V, Features> *current = _header;  //  初始化current为跳表头节点
+    Node<K, V, Features> *next = nullptr;
+
+    // 从跳表最高层级开始遍历
+    for (int i = _skip_list_level.load(std::memory_order_acquire); i >= 0; i--)
+    {
+        //  如果当前层 下一节点存在 且 key值<参数key值
+        next = current->get_next(i);
+        while (next && key_less(next->get_key(), k))
+        {
+            current = next;  //向右走
+            next = current->get_next(i);
+        }
+    }
+
+    //  到达最底层，next 是比较过的第一个不小于 k 的节点
+    //  不能再次读取 current 的后继：期间并发插入的节点可能小于 k，而 key_matches 只判断 k 不小于节点键
+    current = next;
+
+    // 如果当前节点的key值与参数key值相等且未过期，我们就找到了要搜索的节点
+    if (key_matches(current, k) && !is_expired(current))
+    {
+        mark_referenced(current);
+        return true;
+    }
+    if (filter != nullptr)
+    {
+        filter->record_false_positive();
+    }
+    return false;
+}
+
+// 在跳表中根据给定key值搜索元素，并将对应值返回
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+V* SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::search_element_value(const Key &key)
+{
+    const auto &k = lookup_key(key);
+    auto guard = read_guard();
+
+    if (const HashIndex *index = _hash_index.load(std::memory_order_acquire))
+    {
+        Node<K, V, Features> *node = index_find(index, k);
+        if (node == nullptr)
+        {
+            return nullptr;
+        }
+        mark_referenced(node);
+        return &node->get_value();
+    }
+
+    CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_acquire);
+    if (filter != nullptr && !filter->may_contain(filter_hash(k)))
+    {
+        filter->record_negative();
+        return nullptr;
+    }
+
+    Node<K, V, Features> *current = _header;
+    Node<K, V, Features> *next = nullptr;
+
+    for (int i = _skip_list_level.load(std::memory_order_acquire); i >= 0; i--)
+    {
+        next = current->get_next(i);
+        while (next && key_less(next->get_key(), k))
+        {
+            current = next;
+            next = current->get_next(i);
+        }
+    }
+
+    current = next;     //  与 search_element 相同，使用比较过的后继
+
+    //  过期的键在被后台删除之前就对查询不可见，只有设置了过期时间的节点才读取时钟
+    if (key_matches(current, k) && !is_expired(current)) {
+        mark_referenced(current);
+        return &(current->get_value()); //返回指向找到的元素值的指针
+    }
+    if (filter != nullptr)
+    {
+        filter->record_false_positive();
+    }
+    return nullptr; // 如果未找到，返回null指针
+}
+
+// 批量查找，多个键的下降过程交错推进
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+size_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::multi_get(const Key *keys, size_t count, V **values)
+{
+    if constexpr (!std::is_same<Key, K>::value && !skiplist_detail::is_transparent<Compare>::value)
+    {
+        //  比较器不透明时一次性转换为 K，下降过程中不再逐次转换
+        std::vector<K> converted(keys, keys + count);
+        return multi_get(converted.data(), count, values);
+    }
+    else
+    {
+        //  一个进行中的查找：当前停在 current 的 level 层，next 是该层的后继(已预取)
+        struct Lane
+        {
+            Node<K, V, Features> *current;
+            Node<K, V, Features> *next;
+            int level;
+            size_t index;   //  对应 keys 中的下标
+        };
+
+        auto guard = read_guard();
+
+        //  开启哈希索引时，每组键先预取各自的探测起点，再逐个探测
+        if (const HashIndex *index = _hash_index.load(std::memory_order_acquire))
+        {
+            size_t found = 0;
+            for (size_t base = 0; base < count; base += kMultiGetLanes)
+            {
+                size_t end = std::min(count, base + kMultiGetLanes);
+                for (size_t i = base; i < end; i++)
+                {
+                    index->prefetch(keys[i]);
+                }
+                for (size_t i = base; i < end; i++)
+                {
+                    Node<K, V, Features> *node = index_find(index, keys[i]);
+                    values[i] = node != nullptr ? &node->get_value() : nullptr;
+                    if (node != nullptr)
+                    {
+                        mark_referenced(node);
+                        found++;
+                    }
+                }
+            }
+            return found;
+        }
+
+        const int top_level = _skip_list_level.load(std::memory_order_acquire);
+        CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_acquire);
+        Lane lanes[kMultiGetLanes];
+        size_t active = 0;
+        size_t issued = 0;
+        size_t found = 0;
+
+        //  取下一个需要下降的键开始查找，过滤器排除的键直接填空；没有剩余的键时返回 false
+        auto start = [&](Lane &lane) {
+            while (filter != nullptr && issued < count && !filter->may_contain(filter_hash(keys[issued])))
+            {
+                filter->record_negative();
+                values[issued++] = nullptr;
+            }
+            if (issued == count)
+            {
+                return false;
+            }
+            lane.current = _header;
+            lane.level = top_level;
+            lane.index = issued++;
+            lane.next = _header->get_next(top_level);
+            if (lane.next != nullptr)
+            {
+                prefetch_for_read(lane.next);
+            }
+            return true;
+        };
+
+        while (active < kMultiGetLanes && start(lanes[active]))
+        {
+            active++;
+        }
+
+        while (active > 0)
+        {
+            size_t i = 0;
+            while (i < active)
+            {
+                Lane &lane = lanes[i];
+                const Key &key = keys[lane.index];
+
+                //  每个查找只走一步：向右，或下降一层
+                if (lane.next != nullptr && key_less(lane.next->get_key(), key))
+                {
+                    lane.current = lane.next;
+                }
+                else if (lane.level > 0)
+                {
+                    lane.level--;
+                }
+                else
+                {
+                    //  到达最底层，next 是第一个不小于 key 的节点
+                    if (key_matches(lane.next, key) && !is_expired(lane.next))
+                    {
+                        mark_referenced(lane.next);
+                        values[lane.index] = &lane.next->get_value();
+                        found++;
+                    }
+                    else
+                    {
+                        values[lane.index] = nullptr;
+                        if (filter != nullptr)
+                        {
+                            filter->record_false_positive();
+                        }
+                    }
+
+                    if (start(lane))
+                    {
+                        i++;
+                    }
+                    else
+                    {
+                        lane = lanes[--active];     //  用最后一个查找填补空位，本位置下一步继续处理它
+                    }
+                    continue;
+                }
+
+                //  current 已在缓存中，读出下一步的节点并预取，然后转去推进其他查找
+                lane.next = lane.current->get_next(lane.level);
+                if (lane.next != nullptr)
+                {
+                    prefetch_for_read(lane.next);
+                }
+                i++;
+            }
+        }
+        return found;
+    }
+}
+
+// 查找第一个键不小于 key 的节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+Node<K, V, Features>* SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::seek_node(const Key &key)
+{
+    const auto &k = lookup_key(key);
+    Node<K, V, Features> *current = _header;
+    Node<K, V, Features> *next = nullptr;
+
+    for (int i = _skip_list_level.load(std::memory_order_acquire); i >= 0; i--)
+    {
+        next = current->get_next(i);
+        while (next && key_less(next->get_key(), k))
+        {
+            current = next;
+            next = current->get_next(i);
+        }
+    }
+    return next;    //  比较过的后继，重新读取可能得到并发插入的更小的键
+}
+
+// 获取最底层的第一个节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+Node<K, V, Features>* SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::first_node()
+{
+    return _header->get_next(0);
+}
+
+// 指向键最小元素的迭代器
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::iterator SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::begin()
+{
+    return iterator(_header->get_next(0));
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::const_iterator SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::begin() const
+{
+    return const_iterator(_header->get_next(0));
+}
+
+// 尾后迭代器
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::iterator SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::end()
+{
+    return iterator();
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::const_iterator SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::end() const
+{
+    return const_iterator();
+}
+
+// 指向第一个键不小于 key 的元素的迭代器
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::iterator SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::lower_bound(const Key &key)
+{
+    return iterator(seek_node(key));
+}
+
+// 统计键小于 key 的元素个数
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::rank(const Key &key)
+{
+    static_assert(Features::kRank, "rank queries require Features::kRank");
+    const auto &k = lookup_key(key);
+    return rank_query([&]() { return count_less(k); });
+}
+
+// 按排名取元素
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::iterator SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::select(int index)
+{
+    static_assert(Features::kRank, "rank queries require Features::kRank");
+    return iterator(rank_query([&]() { return node_at_rank(index + 1); }));
+}
+
+// 统计 [lo, hi) 区间内的元素个数
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::count_range(const Key &lo, const Key &hi)
+{
+    static_assert(Features::kRank, "rank queries require Features::kRank");
+    const auto &lo_key = lookup_key(lo);
+    const auto &hi_key = lookup_key(hi);
+    if (!key_less(lo_key, hi_key))
+    {
+        return 0;
+    }
+    return rank_query([&]() { return count_less(hi_key) - count_less(lo_key); });
+}
+
+// 取分位数处的元素
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::iterator SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::percentile(double p)
+{
+    static_assert(Features::kRank, "rank queries require Features::kRank");
+    p = std::min(std::max(p, 0.0), 1.0);
+    return iterator(rank_query([&]() -> Node<K, V, Features> * {
+        int count = _element_count.load(std::memory_order_relaxed);
+        if (count == 0)
+        {
+            return nullptr;
+        }
+        int target = static_cast<int>(std::ceil(p * count));
+        return node_at_rank(std::max(target, 1));
+    }));
+}
+
+// 在跨度一致的快照上执行排名查询
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Query>
+auto SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::rank_query(Query query)
+{
+    //  节点会被立即释放且没有共享锁时无法在锁外读取
+    if (_lock_free_read || LockPolicy::kSharedRead)
+    {
+        //  共享读的锁策略下守卫持有共享锁(本线程已持有时不重复加锁)，写者被排除，第一次尝试一定成功
+        auto guard = read_guard();
+        for (int attempt = 0; attempt < kRankQueryAttempts; attempt++)
+        {
+            uint64_t before = _span_seq.load(std::memory_order_acquire);
+            if ((before & 1) == 0)
+            {
+                auto result = query();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (_span_seq.load(std::memory_order_relaxed) == before)
+                {
+                    return result;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<LockPolicy> lock(_lock);
+    return query();
+}
+
+// 从 node 开始沿最底层顺序访问
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<bool Prefetch, typename Visitor>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::walk_from(Node<K, V, Features> *node, Visitor visit)
+{
+    while (node != nullptr)
+    {
+        Node<K, V, Features> *next = node->get_next(0);
+        if constexpr (Prefetch)
+        {
+            //  下一个节点的缓存行在处理当前节点期间载入
+            if (next != nullptr)
+            {
+                prefetch_for_read(next);
+            }
+        }
+        if (!visit(node))
+        {
+            return;
+        }
+        node = next;
+    }
+}
+
+// 访问 [lo, hi) 区间内的元素
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<bool Prefetch, typename Key, typename Callback>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::range(const Key &lo, const Key &hi, Callback callback)
+{
+    const auto &hi_key = lookup_key(hi);
+    auto guard = read_guard();
+    int count = 0;
+    walk_from<Prefetch>(seek_node(lo), [&](Node<K, V, Features> *node) {
+        if (!key_less(node->get_key(), hi_key))
+        {
+            return false;
+        }
+        const Node<K, V, Features> *visible = node;   //  回调只能读取值，写者也不会原地改写它
+        callback(visible->get_key(), visible->get_value());
+        count++;
+        return true;
+    });
+    return count;
+}
+
+// 从 lo 开始取出最多 limit 个键值对
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<bool Prefetch, typename Key>
+std::vector<std::pair<K, V>> SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::scan(const Key &lo, size_t limit)
+{
+    std::vector<std::pair<K, V>> result;
+    if (limit == 0)
+    {
+        return result;
+    }
+    auto guard = read_guard();
+    walk_from<Prefetch>(seek_node(lo), [&](Node<K, V, Features> *node) {
+        result.emplace_back(node->get_key(), node->get_value());
+        return result.size() < limit;
+    });
+    return result;
+}
+
+// 按一致性视图遍历：合并链上可见的节点与视图保管的节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Callback>
+size_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::consistent_for_each(Callback callback)
+{
+    std::lock_guard<std::mutex> gate(_view_gate);
+    ViewState view;
+    Node<K, V, Features> *live;
+    {
+        //  打开视图：之后创建的节点版本号都大于 view.version
+        std::unique_lock<LockPolicy> lock(_lock);
+        open_view(view, lock);
+        live = _header->get_next(0);
+    }
+
+    size_t visited;
+    try
+    {
+        visited = view_for_each(view, live, nullptr, nullptr, callback);
+    }
+    catch (...)
+    {
+        close_view(view);
+        throw;
+    }
+    close_view(view);
+    return visited;
+}
+
+//  视图打开期间被摘除的节点都由视图保管，链上和摘除后冻结的 forward 指向的节点在关闭前都不会被释放，
+//  因此遍历不需要持有读守卫；多个线程可以同时在同一视图的不同区间上遍历
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Callback>
+size_t SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::view_for_each(ViewState &view, Node<K, V, Features> *live, const K *lo, const K *hi, Callback &callback)
+{
+    size_t visited = 0;
+    Node<K, V, Features> *pending = nullptr;  //  preserved 中第一个键大于 last(尚未访问时为第一个不小于 lo)的节点
+    size_t seen = 0;                //  查找 pending 时 preserved 的元素个数
+    bool stale = true;              //  pending 已被消费或尚未查找，需要重新查找
+    const K *last = nullptr;        //  上一个访问的键，所在节点在视图关闭前不会被释放
+    while (true)
+    {
+        //  跳过视图打开之后插入或替换出来的节点
+        if constexpr (Features::kViews)
+        {
+            while (live != nullptr && live->version > view.version)
+            {
+                live = live->get_next(0);
+            }
+        }
+
+        //  先读链接再读计数：读到摘除之后的链接时，计数一定已经包含被摘除的节点
+        size_t count = view.preserved_count.load(std::memory_order_acquire);
+        if (stale || count != seen)
+        {
+            std::lock_guard<std::mutex> lock(view.mutex);
+            auto it = last ? view.preserved.upper_bound(*last) : (lo ? view.preserved.lower_bound(*lo) : view.preserved.begin());
+            pending = it != view.preserved.end() ? it->second : nullptr;
+            seen = count;
+            stale = false;
+        }
+
+        Node<K, V, Features> *node;
+        if (live == nullptr && pending == nullptr)
+        {
+            break;
+        }
+        else if (pending == nullptr || (live != nullptr && key_less(live->get_key(), pending->get_key())))
+        {
+            node = live;
+            live = live->get_next(0);
+        }
+        else
+        {
+            //  键相同时两者是同一个节点：读者先走到了它，写者随后才将其摘除
+            if (live != nullptr && !key_less(pending->get_key(), live->get_key()))
+            {
+                live = live->get_next(0);
+            }
+            node = pending;
+            stale = true;
+        }
+        if (hi != nullptr && !key_less(node->get_key(), *hi))
+        {
+            break;  //  按键递增访问，之后的节点都不在区间内
+        }
+        last = &node->get_key();
+        callback(*last, node->get_value());
+        visited++;
+    }
+    return visited;
+}
+
+// 跳表 构造函数
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::SkipList(int max_level, bool lock_free_read)
+    : _level_generator(max_level)
+{
+
+    this->_max_level = max_level;   // 设置跳表的最大层级数
+    this->_skip_list_level = 0;     // 初始化跳表的层级数为0
+    this->_element_count = 0;       // 初始化跳表的元素计数为0
+    this->_lock_free_read = lock_free_read; // 设置是否启用无锁读模式
+    this->_wal = nullptr;           // 默认不写日志
+    this->_delta_chain = 0;         // 没有增量链
+    this->_delta_sequence = 0;
+    this->_delta_bytes = 0;
+    this->_delta_base_bytes = 0;
+    this->_version = 0;             // 初始版本号
+    this->_view = nullptr;          // 没有打开的视图
+    this->_allocator_users = 0;     // 没有在写锁外使用分配器的操作
+    this->_span_seq = 0;            // 没有正在修改跨度的写操作
+    this->_span_write_depth = 0;
+    this->_expiry_running = false;  // 过期服务未启动
+    this->_expiry_stop = false;
+    this->_memory_budget = 0;       // 默认不限制内存
+    this->_memory_bytes = 0;
+    this->_clock_hand_valid = false;
+    this->_hash_index = nullptr;    // 默认不建哈希索引
+    this->_bloom_filter = nullptr;  // 默认不建布隆过滤器
+
+    // 创建头节点并将键和值初始化为 null
+    // 头节点不从分配器分配，分配器整块释放时头节点不受影响
+    void *memory = ::operator new(Node<K, V, Features>::storage_size(_max_level));
+    this->_header = new (memory) Node<K, V, Features>(K(), V(), _max_level);   // 创建头节点，指定最大层级数
+};
+
+//  跳表 析构函数，回收内存空间
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::~SkipList()
+{
+    LOG_INFO << "Destroying skiplist";
+    stop_expiry_service();  //  后台任务仍在访问跳表，先等它退出
+    if (_file_writer.is_open())
+    {
+        _file_writer.close();
+    }
+    if (_file_reader.is_open())
+    {
+        _file_reader.close();
+    }
+
+    //  先释放已摘除但尚未回收的节点，它们的内存可能属于即将整块归还的内存块
+    _epoch.reclaim_all();
+    delete _hash_index.load(std::memory_order_relaxed);
+    delete _bloom_filter.load(std::memory_order_relaxed);
+
+    //  循环删除节点
+    free_chain(_header->get_next(0));
+
+    //  删除头节点
+    _header->~Node<K, V, Features>();
+    ::operator delete(_header);
+}
+
+//  进入无锁读临界区
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+typename SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::ReadGuard SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::read_guard()
+{
+    return ReadGuard(_lock_free_read ? &_epoch : nullptr, &_lock);
+}
+
+//  获取节点分配器
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+Alloc &SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::get_allocator()
+{
+    return _allocator;
+}
+
+//  退休回调，释放节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::free_node(void *node, void *context)
+{
+    static_cast<SkipList *>(context)->destroy_node(static_cast<Node<K, V, Features>*>(node));
+}
+
+//  无锁读模式下延迟释放，否则立即释放
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::retire_node(Node<K, V, Features> *node)
+{
+    if (_lock_free_read)
+    {
+        _epoch.retire(node, &SkipList::free_node, this);
+    }
+    else
+    {
+        destroy_node(node);
+    }
+}
+
+//  链入新节点：新节点在第 i 层接过 update[i] 原跨度中排在它之后的部分，更高层跨过它的链接跨度加一
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::link_node(Node<K, V, Features> *node, Node<K, V, Features> **update, int *update_rank, int list_level)
+{
+    SpanWrite span_write(*this);
+    //  先加入过滤器再链入，读者能找到的节点一定能通过过滤器
+    if (CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_relaxed))
+    {
+        filter->add(filter_hash(node->get_key()));
+    }
+
+    //  新节点高于当前层数时，新增的层以头节点为前驱，头节点在这些层的链接跨到表尾
+    for (int i = list_level + 1; i <= node->node_level; i++)
+    {
+        update[i] = _header;
+        update_rank[i] = 0;
+        if constexpr (Features::kRank)
+        {
+            _header->set_span(i, _element_count.load(std::memory_order_relaxed));
+        }
+    }
+
+    for (int i = 0; i <= node->node_level; i++)
+    {
+        node->forward[i].store(update[i]->get_next(i), std::memory_order_relaxed);
+        if constexpr (Features::kRank)
+        {
+            int offset = update_rank[0] - update_rank[i];   //  update[i] 与新节点前驱之间的节点数
+            node->set_span(i, update[i]->get_span(i) - offset);
+            update[i]->set_span(i, offset + 1);
+        }
+        update[i]->set_next(i, node);
+    }
+    if constexpr (Features::kRank)
+    {
+        for (int i = node->node_level + 1; i <= list_level; i++)
+        {
+            update[i]->set_span(i, update[i]->get_span(i) + 1);
+        }
+    }
+    if constexpr (Features::kMemoryBudget)
+    {
+        _memory_bytes.fetch_add(node->charge, std::memory_order_relaxed);
+    }
+    if (HashIndex *index = _hash_index.load(std::memory_order_relaxed))
+    {
+        index->insert(node);    //  节点已链入跳表，索引读者与逐层查找的读者看到的内容一致
+    }
+}
+
+//  沿跨度下降到排名为 rank 的节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+Node<K, V, Features> *SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::node_at_rank(int rank)
+{
+    if (rank < 1 || rank > _element_count.load(std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+    Node<K, V, Features> *current = _header;
+    int traversed = 0;
+    for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+    {
+        while (current->get_next(i) != nullptr && traversed + current->get_span(i) <= rank)
+        {
+            traversed += current->get_span(i);
+            current = current->get_next(i);
+        }
+        if (traversed == rank)
+        {
+            return current;
+        }
+    }
+    return nullptr;
+}
+
+//  统计键小于 key 的节点数：累加下降时向右走过的跨度
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::count_less(const Key &key)
+{
+    Node<K, V, Features> *current = _header;
+    int traversed = 0;
+    for (int i = _skip_list_level.load(std::memory_order_relaxed); i >= 0; i--)
+    {
+        Node<K, V, Features> *next = current->get_next(i);
+        while (next != nullptr && key_less(next->get_key(), key))
+        {
+            traversed += current->get_span(i);
+            current = next;
+            next = current->get_next(i);
+        }
+    }
+    return traversed;
+}
+
+//  按比较器判断 a < b
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename A, typename B>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::key_less(const A &a, const B &b) const
+{
+    return _compare(a, b);
+}
+
+//  node 不小于 key 时，key 不小于 node 即两者等价，只需再比较一次
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::key_matches(const Node<K, V, Features> *node, const Key &key) const
+{
+    return node != nullptr && !_compare(key, node->get_key());
+}
+
+//  查找用的键
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Key>
+decltype(auto) SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::lookup_key(const Key &key) const
+{
+    if constexpr (std::is_same<Key, K>::value || skiplist_detail::is_transparent<Compare>::value)
+    {
+        return (key);   //  带括号返回 const Key&，不拷贝
+    }
+    else
+    {
+        return K(key);
+    }
+}
+
+//  有视图时由视图保管将被摘除的节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::preserve_for_view(Node<K, V, Features> *node)
+{
+    if constexpr (Features::kViews)
+    {
+        if (_view == nullptr)
+        {
+            return false;
+        }
+        if (node->version <= _view->version)
+        {
+            std::lock_guard<std::mutex> lock(_view->mutex);
+            _view->preserved.emplace(node->get_key(), node);
+            _view->preserved_count.fetch_add(1, std::memory_order_release);
+        }
+        else
+        {
+            _view->retained.push_back(node);
+        }
+        return true;
+    }
+    else
+    {
+        return false;   //  视图打开期间持有写锁，不会有节点被摘除
+    }
+}
+
+//  没有读者能同时读取这个节点的值时才原地修改
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::can_assign_in_place(const Node<K, V, Features> *node) const
+{
+    //  无锁读者只持有纪元守卫，可能正在拷贝或引用这个值；查询持有共享锁时与写者互斥
+    bool no_concurrent_readers = !_lock_free_read || LockPolicy::kSharedRead;
+    if constexpr (Features::kViews)
+    {
+        return no_concurrent_readers && (_view == nullptr || node->version > _view->version);
+    }
+    else
+    {
+        return no_concurrent_readers;
+    }
+}
+
+//  修改节点的值：可能被并发读取的节点写时复制，旧节点由视图保管或延迟释放
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::assign_value(Node<K, V, Features> *node, Node<K, V, Features> **update, V value)
+{
+    if (can_assign_in_place(node))
+    {
+        node->set_value(std::move(value));
+        if constexpr (Features::kMemoryBudget)
+        {
+            size_t charge = node_charge(node);
+            _memory_bytes.fetch_add(charge, std::memory_order_relaxed);
+            _memory_bytes.fetch_sub(node->charge, std::memory_order_relaxed);
+            node->charge = charge;
+        }
+        return;
+    }
+
+    //  新节点与旧节点同层，沿用旧节点的后继，自底向上替换各层链接。
+    //  已经停在旧节点上的读者看到的仍是完整的旧值，并能沿旧节点的后继继续前进
+    Node<K, V, Features> *replacement = create_node(node->get_key(), std::move(value), node->node_level);
+    for (int i = 0; i <= node->node_level; i++)
+    {
+        replacement->forward[i].store(node->get_next(i), std::memory_order_relaxed);
+        if constexpr (Features::kRank)
+        {
+            replacement->set_span(i, node->get_span(i));
+        }
+    }
+    if constexpr (Features::kExpiry)
+    {
+        replacement->expire_at.store(node->expire_at.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    if constexpr (Features::kMemoryBudget)
+    {
+        _memory_bytes.fetch_add(replacement->charge, std::memory_order_relaxed);
+        _memory_bytes.fetch_sub(node->charge, std::memory_order_relaxed);
+    }
+    if (HashIndex *index = _hash_index.load(std::memory_order_relaxed))
+    {
+        index->replace(node, replacement);
+    }
+    for (int i = 0; i <= node->node_level; i++)
+    {
+        update[i]->set_next(i, replacement);
+    }
+    if (!preserve_for_view(node))
+    {
+        retire_node(node);  //  读者离开后才释放
+    }
+}
+
+//  打开视图：之后创建的节点版本号都大于 view.version
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::open_view(ViewState &view, std::unique_lock<LockPolicy> &lock)
+{
+    if constexpr (Features::kViews)
+    {
+        view.version = _version++;
+        _view = &view;
+    }
+    else
+    {
+        lock.release();     //  没有版本号无法区分视图打开之后创建的节点，遍历期间阻塞写操作
+    }
+}
+
+//  注销视图，视图保管的节点此时才退休
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::close_view(ViewState &view)
+{
+    if constexpr (Features::kViews)
+    {
+        std::lock_guard<LockPolicy> lock(_lock);
+        _view = nullptr;
+    }
+    else
+    {
+        _lock.unlock();     //  open_view 接管的写锁，视图不保管任何节点
+        return;
+    }
+
+    //  注销之后写者不再访问 view；调用者仍持有 _view_gate，clear() 不会与这里的退休并发
+    for (auto &entry : view.preserved)
+    {
+        retire_node(entry.second);
+    }
+    for (Node<K, V, Features> *node : view.retained)
+    {
+        retire_node(node);
+    }
+}
+
+//  随机生成层级数
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::get_random_level()
+{
+    return _level_generator.generate();    //  生成器内部已将层级数限制在 _max_level 范围内
+};
+
+//  设置晋升概率，与插入互斥
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::set_level_probability(double probability)
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    _level_generator.reset(_max_level, probability);
+}
+
+//  获取晋升概率
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+double SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::get_level_probability() const
+{
+    return _level_generator.probability();
+}
+
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::clear()
+{
+    LOG_INFO << "Starting SkipList clear operation.";
+    WalTicket<K, V> ticket;
+    AllocatorUse use;
+    Node<K, V, Features> *detached;
+    {
+        std::lock_guard<std::mutex> gate(_view_gate);   //  视图可能停留在旧链上，等它关闭后再摘下整条链
+        std::lock_guard<LockPolicy> lock(_lock);
+        SpanWrite span_write(*this);
+        detached = _header->get_next(0);
+
+        // 先重置头节点的每一层指向，之后进入的读者看到的是空表
+        for (int i = 0; i <= _max_level; ++i)
+        {
+            _header->set_next(i, nullptr);
+            if constexpr (Features::kRank)
+            {
+                _header->set_span(i, 0);
+            }
+        }
+        if (HashIndex *index = _hash_index.load(std::memory_order_relaxed))
+        {
+            index->clear();
+        }
+        if (CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_relaxed))
+        {
+            filter->clear();
+        }
+
+        // 重置跳表的当前层级和元素计数
+        _skip_list_level = 0; // 假设跳表初始化时至少有一层
+        _element_count.store(0, std::memory_order_relaxed);
+        _clock_hand_valid = false;
+        _memory_bytes = 0;  //  区间删除在摘除时已扣除，写锁外尚未释放完的区间不再计入
+
+        //  没有其他线程在写锁外使用分配器、读者也很快离开时，回收所有退休节点后整块归还内存。
+        //  持有守卫的线程可能正在等待写锁，这里只做有限次等待，等不到就改为写锁外逐个释放；
+        //  退休只发生在写锁内、视图关闭时(已由 _view_gate 排除)或已登记的锁外释放中，回收期间不会有并发的退休
+        if constexpr (Alloc::kBulkRelease)
+        {
+            bool in_guard = _lock_free_read && _epoch.in_critical_section();
+            if (!in_guard && _allocator_users.load(std::memory_order_acquire) == 0
+                && (!_lock_free_read || _epoch.try_wait_for_readers(kBulkReleaseAttempts)))
+            {
+                if (_lock_free_read)
+                {
+                    _epoch.reclaim_all();
+                }
+                free_chain(detached);
+                detached = nullptr;
+            }
+        }
+        if (detached != nullptr)
+        {
+            use.acquire(_allocator_users);
+        }
+        ticket = log_operation(WalOp::Clear, nullptr, nullptr);
+
+        // 时间轮中的条目都已失效
+        std::lock_guard<std::mutex> wheel_lock(_wheel_mutex);
+        if (_wheel)
+        {
+            _wheel->clear();
+        }
+    }
+
+    //  写锁外释放：等待摘除之前进入的读者离开后，整条旧链不会再被访问；持有守卫的线程不能等待，只能逐个退休
+    bool retire = _lock_free_read && _epoch.in_critical_section();
+    if (_lock_free_read && !retire)
+    {
+        _epoch.wait_for_readers();
+    }
+    while (detached != nullptr)
+    {
+        Node<K, V, Features> *next = detached->get_next(0);
+        if (retire)
+        {
+            retire_node(detached);
+        }
+        else
+        {
+            destroy_node(detached);
+        }
+        detached = next;
+    }
+    ticket.commit_or_throw();
+    LOG_INFO << "SkipList cleared successfully.";
+}
 
-// 创建一个新节点
-template<typename K, typename V>
-Node<K, V>* SkipList<K, V>::create_node(const K k, const V v, int level)
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::load_from_json(const std::string& file_name)
 {
-    Node<K, V> *n = new Node<K, V>(k, v, level);
-    return n;
+    LOG_INFO << "Loading SkipList from JSON file: " << file_name;
+    MappedFile file;
+    if (!file.open(file_name, true))   //  写时复制映射，原地解析的修改不会写回文件
+    {
+        LOG_ERROR << "Error: Cannot open file " << file_name;
+        std::cerr << "Error: Cannot open file " << file_name << std::endl;
+        return;
+    }
+
+    //  键值对攒够一批就插入，save_to_json 按键递增写出，批内有序时直接走有序插入路径
+    BoundedInsituStream stream(file.writable_data(), file.size());
+    std::vector<std::pair<K, V>> batch;
+    batch.reserve(kJsonLoadBatch);
+    int inserted = 0;
+    auto flush = [&]() {
+        inserted += insert_batch(batch.begin(), batch.end());
+        batch.clear();
+        file.discard(stream.Tell());    //  批内的键值对已经复制出来，之前的映射页不再访问
+    };
+    auto handler = make_key_value_handler<K, V>([&](K &&key, V &&value) {
+        batch.emplace_back(std::move(key), std::move(value));
+        if (batch.size() >= kJsonLoadBatch)
+        {
+            flush();
+        }
+    });
+
+    rapidjson::Reader reader;
+    reader.Parse<rapidjson::kParseInsituFlag>(stream, handler);
+    if (!handler.root_is_array())
+    {
+        LOG_ERROR << "Error: JSON file must contain an array of key-value pairs.";
+        std::cerr << "Error: JSON file must contain an array of key-value pairs" << std::endl;
+        return;
+    }
+    flush();
+
+    if (reader.HasParseError())
+    {
+        LOG_ERROR << "Error: JSON parse error at offset " << reader.GetErrorOffset() << ": "
+                  << rapidjson::GetParseError_En(reader.GetParseErrorCode()) << ", " << inserted << " elements loaded.";
+        std::cerr << "Error: JSON parse error at offset " << reader.GetErrorOffset() << ": "
+                  << rapidjson::GetParseError_En(reader.GetParseErrorCode()) << std::endl;
+        return;
+    }
+    LOG_INFO << "Successfully loaded " << inserted << " of " << handler.elements() << " elements from JSON.";
 }
 
-// 根据给定键值对，将元素插入到跳表中
-// return 1 意味着 元素已在跳表中
-// return 0 意味着 元素插入成功
-template<typename K, typename V>
-int SkipList<K, V>::insert_element(const K key, const V value)
+// 在写锁内追加一条日志记录，未挂接日志时返回空凭据
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+WalTicket<K, V> SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::log_operation(WalOp op, const K *key, const V *value, const K *end_key)
 {
+    WalTicket<K, V> ticket;
+    //  键或值没有编解码器的跳表不能挂接日志，也就不实例化日志的写入路径
+    if constexpr (has_snapshot_codec<K>::value && has_snapshot_codec<V>::value)
+    {
+        if (_wal != nullptr)
+        {
+            ticket.wal = _wal;
+            ticket.lsn = _wal->append(op, key, value, end_key);
+        }
+        if (_change_log != nullptr)
+        {
+            _change_log->record(op, key, value, end_key);
+        }
+    }
+    return ticket;
+}
 
-    mtx.lock(); // 加互斥锁，保障并发安全
-    Node<K, V> *current = this->_header;
+// 挂接预写日志
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::attach_wal(WriteAheadLog<K, V> *wal)
+{
+    static_assert(has_snapshot_codec<K>::value && has_snapshot_codec<V>::value,
+                  "attaching a write-ahead log requires SnapshotCodec for both K and V");
+    std::lock_guard<LockPolicy> lock(_lock);
+    _wal = wal;
+}
 
-    //  update数组保存插入节点的前一个节点
-    Node<K, V> *update[_max_level+1];
-    memset(update, 0, sizeof(Node<K, V>*)*(_max_level+1));  //  初始化NULL
+// 加载快照并重放日志
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::recover(const std::string& snapshot_file, WriteAheadLog<K, V> &wal)
+{
+    LOG_INFO << "Recovering SkipList from snapshot " << snapshot_file << " and WAL.";
+    attach_wal(nullptr);    //  重放的操作不能再次写入日志
 
-    // 从跳表的最高层级开始
-    for(int i = _skip_list_level; i >= 0; i--)
+    if (std::ifstream(snapshot_file, std::ios::binary).good() && !load_snapshot(snapshot_file))
     {
-        //  当前层下一节点存在 且 下一节点的key 小于 参数key
-        while(current->forward[i] != NULL && current->forward[i]->get_key() < key)
+        LOG_ERROR << "Error: Recovery aborted, snapshot " << snapshot_file << " cannot be loaded.";
+        return false;
+    }
+
+    wal.replay([this](WalOp op, const K &key, const V &value, const K &end_key) {
+        switch (op)
         {
-            //  向右走
-            current = current->forward[i];
+            case WalOp::Insert:
+                insert_element(key, value);
+                break;
+            case WalOp::Update:
+                update_element(key, value);
+                break;
+            case WalOp::Delete:
+                delete_element(key);
+                break;
+            case WalOp::Clear:
+                clear();
+                break;
+            case WalOp::DeleteRange:
+                remove_range(key, end_key, true);
+                break;
         }
-        update[i] = current;    //  更新update数组 当前层的节点
-    }
+    });
 
-    // 达到最底层，将current指向插入位置右侧节点
-    current = current->forward[0];
+    if (!wal.open())
+    {
+        return false;
+    }
+    attach_wal(&wal);
+    LOG_INFO << "Recovery finished with " << size() << " elements.";
+    return true;
+}
 
-    // 如果当前节点存在 且 key==传入的参数key
-    if (current != NULL && current->get_key() == key)
+// 检查点：切换日志段 -> 保存快照 -> 删除旧日志段
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::checkpoint(const std::string& snapshot_file)
+{
+    WriteAheadLog<K, V> *wal;
     {
-        //std::cout << "key: " << key << ", exists" << std::endl;
-        mtx.unlock();   //  解锁互斥量
-        return 1;   //  元素已在跳表中(根据key判断)
+        std::lock_guard<LockPolicy> lock(_lock);
+        wal = _wal;
     }
 
-    // 如果 current 为 NULL ，说明到达当前层尾部
-    //  如果 current 的键值不等于 key，意味着 需要在 update[0] 和 current 节点之间插入新节点
-    if (current == NULL || current->get_key() != key )
+    //  切换之后的写入进入新段；切换之前的写入已全部生效，一定包含在随后保存的快照中
+    uint64_t segment = 0;
+    if (wal != nullptr && (segment = wal->rotate()) == 0)
+    {
+        return false;
+    }
+    if (!save_snapshot(snapshot_file))
+    {
+        return false;
+    }
+    if (wal != nullptr)
     {
+        wal->remove_segments_before(segment);
+    }
+    return true;
+}
 
-        // 生成一个随机层级用于新节点
-        int random_level = get_random_level();
+// 保存二进制快照
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::save_snapshot(const std::string& file_name)
+{
+    LOG_INFO << "Saving SkipList snapshot to " << file_name;
 
-        // 如果随机层级大于跳表的当前层级，将 update 数组的值初始化为指向头节点
-        if (random_level > _skip_list_level)
+    //  开启了过滤器时按写出的键另建一个同样大小的过滤器，它与快照内容完全一致，不受保存期间写操作的影响
+    std::unique_ptr<CountingBloomFilter> snapshot_filter;
+    {
+        auto guard = read_guard();
+        if (const CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_acquire))
         {
-            for (int i = _skip_list_level+1; i < random_level+1; i++)
-            {
-                update[i] = _header;
-            }
-            _skip_list_level = random_level;    //  更新跳表层数
+            snapshot_filter.reset(new CountingBloomFilter(filter->block_count(), filter->hash_count()));
         }
+    }
 
-        // 创建一个具有随机层级的新节点
-        Node<K, V>* inserted_node = create_node(key, value, random_level);
+    //  按一致性视图写出，保存期间写操作不被阻塞
+    SnapshotHeader header;
+    if (!write_snapshot_file(file_name, [this](auto &visit) { consistent_for_each(visit); }, snapshot_filter.get(), header))
+    {
+        return false;
+    }
+    LOG_INFO << "Successfully saved " << header.count << " elements to snapshot.";
+    return true;
+}
 
-        // 插入节点
-        for (int i = 0; i <= random_level; i++)
+// 写出一个快照文件
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename ForEach>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::write_snapshot_file(const std::string &file_name, ForEach for_each, CountingBloomFilter *filter, SnapshotHeader &header)
+{
+    const std::string tmp_file_name = file_name + ".tmp";
+    std::ofstream ofs(tmp_file_name, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open())
+    {
+        LOG_ERROR << "Error: Cannot open file " << tmp_file_name;
+        std::cerr << "Error: Cannot open file " << tmp_file_name << std::endl;
+        return false;
+    }
+
+    header = {};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.max_level = static_cast<uint32_t>(_max_level);
+    header.checksum = kFnvOffsetBasis;
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));    //  先占位，写完记录后回填
+
+    //  记录先编码到缓冲区，攒够 1MB 再整块写出并累加校验和
+    const size_t flush_threshold = 1 << 20;
+    std::string buffer;
+    buffer.reserve(flush_threshold + 4096);
+    auto flush = [&]() {
+        header.checksum = fnv1a64(buffer.data(), buffer.size(), header.checksum);
+        header.payload_bytes += buffer.size();
+        ofs.write(buffer.data(), buffer.size());
+        buffer.clear();
+    };
+
+    uint64_t first_key_hash = 0;
+    auto visit = [&](const K &key, const V &value) {
+        append_snapshot_record(key, value, buffer);
+        if (filter != nullptr)
         {
-            inserted_node->forward[i] = update[i]->forward[i];
-            update[i]->forward[i] = inserted_node;
+            uint64_t hash = filter_hash(key);
+            first_key_hash = header.count == 0 ? hash : first_key_hash;
+            filter->add(hash);
         }
-        //std::cout << "Successfully inserted key:" << key << ", value:" << value << std::endl;
-        _element_count ++;
+        header.count++;
+        if (buffer.size() >= flush_threshold)
+        {
+            flush();
+        }
+    };
+    for_each(visit);
+    flush();
+
+    //  过滤器段在记录区之后，不计入记录区的字节数与校验和
+    if (filter != nullptr)
+    {
+        append_snapshot_filter(*filter, first_key_hash, buffer);
+        ofs.write(buffer.data(), buffer.size());
     }
-    mtx.unlock();
-    return 0;   //  表示插入成功
+
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    ofs.close();
+    if (!ofs)
+    {
+        LOG_ERROR << "Error: Failed to write snapshot " << tmp_file_name;
+        std::cerr << "Error: Failed to write snapshot " << tmp_file_name << std::endl;
+        std::remove(tmp_file_name.c_str());
+        return false;
+    }
+
+    //  Windows 下 rename 不能覆盖已有文件，先删除旧快照
+    std::remove(file_name.c_str());
+    if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0)
+    {
+        LOG_ERROR << "Error: Cannot rename " << tmp_file_name << " to " << file_name;
+        std::cerr << "Error: Cannot rename " << tmp_file_name << " to " << file_name << std::endl;
+        return false;
+    }
+    return true;
 }
 
-// 更新跳表中键为key的节点的值为value
-// 如果跳表中不存在该键，则返回false
-template<typename K, typename V>
-bool SkipList<K, V>::update_element(K key, V value)
+// 并行保存分区快照
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Pool>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::save_partitioned_snapshot(const std::string &manifest_file, Pool &pool, size_t partitions)
 {
-    Node<K, V> *current = _header;
+    if (partitions == 0)
+    {
+        partitions = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    LOG_INFO << "Saving SkipList partitioned snapshot to " << manifest_file << " with up to " << partitions << " partitions";
+
+    //  新一代的段不覆盖旧清单引用的段，旧清单不存在或已损坏时从第 1 代开始
+    SnapshotManifest previous;
+    bool has_previous = false;
+    {
+        MappedFile file;
+        has_previous = file.open(manifest_file) && decode_snapshot_manifest(file.data(), file.size(), previous);
+    }
+    SnapshotManifest manifest;
+    manifest.generation = has_previous ? previous.generation + 1 : 1;
+
+    std::lock_guard<std::mutex> gate(_view_gate);
+    ViewState view;
+    std::vector<Node<K, V, Features> *> starts;   //  每个区间的第一个节点，第 0 个区间从表头开始
+    {
+        //  打开视图并在同一次加锁内选出分界节点：它们此刻在链上，之后被删除或替换时由视图保管，视图关闭前不会被释放
+        std::unique_lock<LockPolicy> lock(_lock);
+        open_view(view, lock);
+        size_t n = static_cast<size_t>(_element_count.load(std::memory_order_relaxed));
+        partitions = std::max<size_t>(std::min(partitions, n), 1);
+        starts.push_back(_header->get_next(0));
+        if (partitions > 1)
+        {
+            //  每层节点是下一层的随机抽样：从最高层往下找第一个节点数够用的层，只走过 O(K) 个节点，不必沿第 0 层走完整个跳表
+            std::vector<Node<K, V, Features> *> samples;
+            for (int level = _skip_list_level.load(std::memory_order_relaxed); level >= 0; level--)
+            {
+                samples.clear();
+                for (Node<K, V, Features> *node = _header->get_next(level); node != nullptr; node = node->get_next(level))
+                {
+                    samples.push_back(node);
+                }
+                if (samples.size() >= partitions * kPartitionSamples)
+                {
+                    break;
+                }
+            }
+            //  在样本中等距取分界节点，样本数不少于 K 时下标严格递增且不为 0，各区间互不相同且非空
+            for (size_t i = 1; i < partitions; i++)
+            {
+                starts.push_back(samples[i * samples.size() / partitions]);
+            }
+        }
+    }
+
+    //  第 i 个区间为 [starts[i] 的键, starts[i + 1] 的键)，所有段合起来恰好是视图的内容
+    manifest.segments.resize(partitions);
+    std::vector<std::future<bool>> results;
+    try
+    {
+        for (size_t i = 0; i < partitions; i++)
+        {
+            manifest.segments[i].file = snapshot_segment_name(manifest_file, manifest.generation, i);
+            auto task = [this, &view, &starts, &manifest, &manifest_file, i, partitions]() -> bool {
+                const K *lo = i == 0 ? nullptr : &starts[i]->get_key();
+                const K *hi = i + 1 == partitions ? nullptr : &starts[i + 1]->get_key();
+                SnapshotSegmentInfo &segment = manifest.segments[i];
+                SnapshotHeader header;
+                try
+                {
+                    auto for_each = [&](auto &visit) { view_for_each(view, starts[i], lo, hi, visit); };
+                    if (!write_snapshot_file(snapshot_segment_path(manifest_file, segment.file), for_each, nullptr, header))
+                    {
+                        return false;
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    LOG_ERROR << "Error: Failed to write snapshot segment " << segment.file << ": " << e.what();
+                    return false;
+                }
+                segment.count = header.count;
+                segment.payload_bytes = header.payload_bytes;
+                segment.checksum = header.checksum;
+                return true;
+            };
+            if constexpr (skiplist_detail::has_enqueue<Pool>::value)
+            {
+                results.push_back(pool.enqueue(task));
+            }
+            else
+            {
+                results.push_back(pool.push([task](int) { return task(); }));
+            }
+        }
+    }
+    catch (...)
+    {
+        //  已提交的任务仍在访问视图，等它们结束后再关闭
+        for (auto &result : results)
+        {
+            result.wait();
+        }
+        close_view(view);
+        throw;
+    }
 
-    // 从最高层开始向下搜索需要更新的节点
-    for (int i = _skip_list_level; i >= 0; i--)
+    //  等所有任务结束后才能关闭视图，任务抛出的异常只记为失败
+    bool ok = true;
+    for (auto &result : results)
     {
-        while (current->forward[i] && current->forward[i]->get_key() < key)
+        try
+        {
+            ok = result.get() && ok;
+        }
+        catch (...)
         {
-            current = current->forward[i];
+            ok = false;
         }
     }
-    
-    // 到达第0层，前进到下一个节点
-    current = current->forward[0];
+    close_view(view);
 
-    // 如果当前节点的键与搜索的键匹配，则更新值
-    if (current != nullptr && current->get_key() == key)
+    std::string encoded;
+    encode_snapshot_manifest(manifest, encoded);
+    const std::string tmp_file_name = manifest_file + ".tmp";
+    if (ok)
     {
-        current->set_value(value);
-        return true;
+        std::ofstream ofs(tmp_file_name, std::ios::binary | std::ios::trunc);
+        ofs.write(encoded.data(), encoded.size());
+        ofs.close();
+        if (!ofs)
+        {
+            LOG_ERROR << "Error: Failed to write snapshot manifest " << tmp_file_name;
+            std::cerr << "Error: Failed to write snapshot manifest " << tmp_file_name << std::endl;
+            std::remove(tmp_file_name.c_str());
+            ok = false;
+        }
     }
 
-    // 如果跳表中不存在该键，则返回false
-    return false;
+    //  替换清单即提交；Windows 下 rename 不能覆盖已有文件，先删除旧清单
+    if (ok)
+    {
+        std::remove(manifest_file.c_str());
+        if (std::rename(tmp_file_name.c_str(), manifest_file.c_str()) != 0)
+        {
+            LOG_ERROR << "Error: Cannot rename " << tmp_file_name << " to " << manifest_file;
+            std::cerr << "Error: Cannot rename " << tmp_file_name << " to " << manifest_file << std::endl;
+            ok = false;
+        }
+    }
+
+    //  失败时删除本次写出的段，旧快照保持不变；成功时删除上一代的段
+    const SnapshotManifest &obsolete = ok ? previous : manifest;
+    for (const SnapshotSegmentInfo &segment : obsolete.segments)
+    {
+        std::remove(snapshot_segment_path(manifest_file, segment.file).c_str());
+    }
+    if (!ok)
+    {
+        return false;
+    }
+    LOG_INFO << "Successfully saved " << manifest.count() << " elements to " << partitions << " snapshot segments.";
+    return true;
 }
 
-//更新跳表中键位key的节点的值，并显示详细信息
-template<typename K, typename V>
-bool SkipList<K, V>::update_element_value(K key, V new_value, V &old_value)
+// 映射快照并校验
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::map_snapshot(const std::string &file_name, MappedFile &file, SnapshotHeader &header)
 {
-    V* found_value = this->search_element_value(key); // 使用search_element_value方法来定位旧值
+    if (!file.open(file_name))
+    {
+        LOG_ERROR << "Error: Cannot open file " << file_name;
+        std::cerr << "Error: Cannot open file " << file_name << std::endl;
+        return false;
+    }
+    if (file.size() < sizeof(header))
+    {
+        LOG_ERROR << "Error: Snapshot " << file_name << " is truncated.";
+        std::cerr << "Error: Snapshot " << file_name << " is truncated." << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 || header.version < 1 || header.version > kSnapshotVersion)
+    {
+        LOG_ERROR << "Error: " << file_name << " is not a supported snapshot.";
+        std::cerr << "Error: " << file_name << " is not a supported snapshot." << std::endl;
+        return false;
+    }
+
+    //  版本 1 的文件只有记录区，版本 2 的记录区之后可能还有过滤器段
+    const char *payload = file.data() + sizeof(header);
+    size_t available = file.size() - sizeof(header);
+    bool size_matches = header.version == 1 ? header.payload_bytes == available : header.payload_bytes <= available;
+    if (!size_matches || fnv1a64(payload, static_cast<size_t>(header.payload_bytes)) != header.checksum)
+    {
+        LOG_ERROR << "Error: Snapshot " << file_name << " failed checksum verification.";
+        std::cerr << "Error: Snapshot " << file_name << " failed checksum verification." << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    if (found_value != nullptr)
+// 从二进制快照加载
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::load_snapshot(const std::string& file_name)
+{
+    LOG_INFO << "Loading SkipList from snapshot: " << file_name;
+    MappedFile file;
+    SnapshotHeader header;
+    if (!map_snapshot(file_name, file, header))
     {
-        old_value = *found_value;  // 存储旧值
-        *found_value = new_value;  // 更新为新值
+        return false;
+    }
 
-        // 如有需要，可以在这里输出详细信息
-        std::cout << "Updated key " << key 
-                  << " from: " << old_value 
-                  << " to: " << new_value << std::endl;
+    //  版本 1 的文件只有记录区，版本 2 的记录区之后可能还有过滤器段
+    const char *payload = file.data() + sizeof(header);
+    size_t available = file.size() - sizeof(header);
+    size_t payload_bytes = static_cast<size_t>(header.payload_bytes);
+
+    //  记录由 save_snapshot 按键递增写出且已通过校验，在写锁外解码为暂存的有序链，全部成功后才发布
+    LevelGenerator levels(_max_level);
+    AllocatorUse use;
+    {
+        std::lock_guard<LockPolicy> lock(_lock);
+        levels = _level_generator;
+        use.acquire(_allocator_users);
+    }
+    std::vector<SortedRun> runs(1);
+    if (!decode_sorted_run(payload, payload_bytes, levels, runs[0]))
+    {
+        free_sorted_run(runs[0]);
+        LOG_ERROR << "Error: Snapshot " << file_name << " contains a malformed record.";
+        std::cerr << "Error: Snapshot " << file_name << " contains a malformed record." << std::endl;
+        return false;
+    }
 
-        return true; // 成功找到并更新了元素
+    std::unique_ptr<CountingBloomFilter> saved_filter;
+    if (available > payload_bytes)
+    {
+        const Node<K, V, Features> *first = runs[0].count > 0 ? runs[0].head[0] : nullptr;
+        saved_filter = read_snapshot_filter(payload + payload_bytes, available - payload_bytes, first != nullptr ? filter_hash(first->get_key()) : 0);
+        if (!saved_filter)
+        {
+            LOG_WARN << "Bloom filter in snapshot " << file_name << " is corrupt or was built with a different hash, ignored.";
+        }
     }
 
-    return false; // 未找到元素
+    //  跳表为空时整条接入并恢复快照中的过滤器，否则合并，已存在的键保持不变
+    WalTicket<K, V> ticket;
+    int inserted = import_sorted_runs(runs, ticket, &saved_filter);
+    ticket.commit_or_throw();
+    LOG_INFO << "Successfully loaded " << inserted << " of " << header.count << " elements from snapshot.";
+    return true;
 }
 
-// 可视化跳表
-template<typename K, typename V>
-void SkipList<K, V>::display_list()
+// 并行加载分区快照
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+template<typename Pool>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::load_partitioned_snapshot(const std::string &manifest_file, Pool &pool)
 {
-    LOG_INFO << "Beginning display of SkipList.";
-    std::vector<std::string> lines; // 用于存储每一层的字符串
-  
-    // 遍历所有层级
-    for (int level = _skip_list_level; level >= 0; --level)
+    LOG_INFO << "Loading SkipList from partitioned snapshot: " << manifest_file;
+    SnapshotManifest manifest;
     {
-        std::ostringstream oss;
-        oss << "Level " << level << ": ";
-
-        Node<K, V> *node = this->_header->forward[level];
-        while (node != nullptr)
+        MappedFile file;
+        if (!file.open(manifest_file))
         {
-            oss << "|" << node->get_key() << ":" << node->get_value() << " ";
-            node = node->forward[level];
+            LOG_ERROR << "Error: Cannot open file " << manifest_file;
+            std::cerr << "Error: Cannot open file " << manifest_file << std::endl;
+            return false;
+        }
+        if (!decode_snapshot_manifest(file.data(), file.size(), manifest))
+        {
+            LOG_ERROR << "Error: " << manifest_file << " is not a valid snapshot manifest.";
+            std::cerr << "Error: " << manifest_file << " is not a valid snapshot manifest." << std::endl;
+            return false;
         }
-        oss << "|"; // 每层最后添加 "|"
-        lines.push_back(oss.str()); // 将每层的字符串添加到lines中
     }
 
-    // 找到最长的行
-    std::string title = "***** Skip List *****";
-    size_t max_length = title.size();
-    for (const auto& line : lines)
+    //  层级生成器在写锁内复制一份，构建任务在锁外使用
+    LevelGenerator levels(_max_level);
+    AllocatorUse use;
     {
-        if (line.size() > max_length)
+        std::lock_guard<LockPolicy> lock(_lock);
+        levels = _level_generator;
+        use.acquire(_allocator_users);
+    }
+
+    //  每个段由一个任务在写锁外构建，任务只分配节点、不访问跳表的链；
+    //  等待期间不持有任何锁，线程池中需要写锁的其他任务与前台写者照常进行
+    const size_t segments = manifest.segments.size();
+    std::vector<SortedRun> runs(segments);
+    std::vector<std::future<bool>> results;
+    try
+    {
+        for (size_t i = 0; i < segments; i++)
         {
-            max_length = line.size();
+            auto task = [this, &manifest, &manifest_file, &levels, &runs, i]() -> bool {
+                const SnapshotSegmentInfo &segment = manifest.segments[i];
+                try
+                {
+                    return build_sorted_run(snapshot_segment_path(manifest_file, segment.file), segment, levels, runs[i]);
+                }
+                catch (const std::exception &e)
+                {
+                    LOG_ERROR << "Error: Failed to load snapshot segment " << segment.file << ": " << e.what();
+                    return false;
+                }
+            };
+            if constexpr (skiplist_detail::has_enqueue<Pool>::value)
+            {
+                results.push_back(pool.enqueue(task));
+            }
+            else
+            {
+                results.push_back(pool.push([task](int) { return task(); }));
+            }
+        }
+    }
+    catch (...)
+    {
+        //  已提交的任务仍在写 runs，等它们结束后再释放
+        for (auto &result : results)
+        {
+            result.wait();
+        }
+        for (SortedRun &run : runs)
+        {
+            free_sorted_run(run);
+        }
+        throw;
+    }
+    bool ok = true;
+    for (auto &result : results)
+    {
+        try
+        {
+            ok = result.get() && ok;
+        }
+        catch (...)
+        {
+            ok = false;
         }
     }
 
-    // 创建标题，并确保它与最长行一样长且居中
-    size_t title_padding = (max_length - title.size()) / 2;
-    std::string full_title = std::string(title_padding, ' ') + title;
-
-    // 如果标题不够长，确保它至少与最长行一样长
-    while (full_title.size() < max_length)
+    //  段之间的键区间必须递增且互不重叠，否则拼接出的链无序
+    const Node<K, V, Features> *previous = nullptr;
+    for (size_t i = 0; ok && i < segments; i++)
     {
-        full_title += " "; // 在标题末尾添加空格以确保长度足够
+        if (runs[i].count == 0)
+        {
+            continue;
+        }
+        if (previous != nullptr && !key_less(previous->get_key(), runs[i].head[0]->get_key()))
+        {
+            LOG_ERROR << "Error: Snapshot segments in " << manifest_file << " overlap.";
+            std::cerr << "Error: Snapshot segments in " << manifest_file << " overlap." << std::endl;
+            ok = false;
+        }
+        previous = runs[i].tail[0];
     }
-
-    std::cout << full_title << '\n';
-
-    // 输出每一层
-    for (const auto& line : lines)
+    if (!ok)
     {
-        std::cout << line << '\n';
+        for (SortedRun &run : runs)
+        {
+            free_sorted_run(run);
+        }
+        return false;
     }
-    LOG_INFO << "Display of SkipList completed.";
+
+    //  只有拼接(或跳表非空时的有序插入)持有写锁
+    WalTicket<K, V> ticket;
+    int inserted = import_sorted_runs(runs, ticket);
+    ticket.commit_or_throw();
+    LOG_INFO << "Successfully loaded " << inserted << " of " << manifest.count() << " elements from " << segments << " snapshot segments.";
+    return true;
 }
 
-// 内存中数据持久化到本地磁盘中的文件
-template<typename K, typename V>
-void SkipList<K, V>::dump_file()
+// 构建一个段的有序链：映射并校验段文件，再解码记录区
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::build_sorted_run(const std::string &file_name, const SnapshotSegmentInfo &segment, const LevelGenerator &levels, SortedRun &run)
 {
-    LOG_INFO << "Starting dump of SkipList to " << STORE_FILE;
-    std::cout << "dump_file-----------------" << std::endl;
-    //  打开文件
-    _file_writer.open(STORE_FILE);
-    //  从跳表最底层开始遍历节点
-    Node<K, V> *node = this->_header->forward[0];
-
-    //  遍历节点并将键值写入文件
-    while (node != NULL)
+    MappedFile file;
+    SnapshotHeader header;
+    if (!map_snapshot(file_name, file, header))
     {
-        _file_writer << node->get_key() << ":" << node->get_value() << "\n";
-        std::cout << node->get_key() << ":" << node->get_value() << ";\n";
-        node = node->forward[0];
+        return false;
     }
 
-    _file_writer.flush();   //  刷新文件输出流
-    _file_writer.close();   //  关闭文件
+    //  段文件头必须与清单中的条目一致，混入其他快照的段时校验失败
+    if (header.count != segment.count || header.payload_bytes != segment.payload_bytes || header.checksum != segment.checksum)
+    {
+        LOG_ERROR << "Error: Snapshot segment " << file_name << " does not match the manifest.";
+        std::cerr << "Error: Snapshot segment " << file_name << " does not match the manifest." << std::endl;
+        return false;
+    }
+    const char *payload = file.data() + sizeof(header);
+    size_t payload_bytes = static_cast<size_t>(header.payload_bytes);
+    if (!decode_sorted_run(payload, payload_bytes, levels, run))
+    {
+        LOG_ERROR << "Error: Snapshot " << file_name << " contains a malformed record.";
+        std::cerr << "Error: Snapshot " << file_name << " contains a malformed record." << std::endl;
+        return false;
+    }
+    return true;
 }
 
-// 加载本地磁盘 文件中的数据
-template<typename K, typename V>
-void SkipList<K, V>::load_file()
+// 解码记录区为有序链：与 bulk_build 相同，新节点直接接在各层尾部，但链的起点是 run 自己而不是头节点
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::decode_sorted_run(const char *payload, size_t payload_bytes, const LevelGenerator &levels, SortedRun &run)
 {
-    LOG_INFO << "Starting load data from SkipList " << STORE_FILE;
-    _file_reader.open(STORE_FILE);
-    std::cout << "load_file-----------------" << std::endl;
-    //  保存从文件中读取的数据
-    std::string line;
-
-    /*std::string* key = new std::string();
-    std::string* value = new std::string();*/
-
-    //  使用智能指针管理，防止内存泄露
-    std::unique_ptr<std::string> key(new std::string());
-    std::unique_ptr<std::string> value(new std::string());
-    //  逐行读取文件的内容
-    while (getline(_file_reader, line))
+    run.head.assign(_max_level + 1, nullptr);
+    run.tail.assign(_max_level + 1, nullptr);
+    run.head_rank.assign(_max_level + 1, 0);
+    run.tail_rank.assign(_max_level + 1, 0);
+
+    bool failed = false;
+    SnapshotRecordIterator<K, V> first(payload, payload + payload_bytes, &failed);
+    SnapshotRecordIterator<K, V> last;
+    for (; first != last; ++first)
     {
-        get_key_value_from_string(line, key, value);    // 从每一行数据中提取键和值
-        // 如果键或值为空，跳过该行数据
-        if (key->empty() || value->empty())
+        //  记录有序，重复的键一定紧挨在一起
+        if (run.count > 0 && !key_less(run.tail[0]->get_key(), first->first))
         {
             continue;
         }
-        insert_element(*key, *value);
-        std::cout << "key:" << *key << "value:" << *value << std::endl;
-    }
-
-    //关闭文件输入流
-    _file_reader.close();
-}
 
-//  获取跳表中元素的数量
-template<typename K, typename V>
-int SkipList<K, V>::size()
-{
-    return _element_count;
+        //  版本号由拼接时的 _view_gate 保证，构建期间不读取 _version
+        int random_level = levels.generate();
+        Node<K, V, Features> *node = allocate_node(first->first, first->second, random_level);
+        int rank = ++run.count;
+        for (int i = 0; i <= random_level; i++)
+        {
+            if (run.tail[i] == nullptr)
+            {
+                run.head[i] = node;
+                run.head_rank[i] = rank;
+            }
+            else
+            {
+                if constexpr (Features::kRank)
+                {
+                    run.tail[i]->set_span(i, rank - run.tail_rank[i]);
+                }
+                run.tail[i]->set_next(i, node);
+            }
+            run.tail[i] = node;
+            run.tail_rank[i] = rank;
+        }
+        if constexpr (Features::kMemoryBudget)
+        {
+            run.charge += node->charge;
+        }
+    }
+    return !failed;
 }
 
-//  从字符串中提取key:value
-template<typename K, typename V>
-void SkipList<K, V>::get_key_value_from_string(const std::string& str, std::string* key, std::string* value)
+// 导入写锁外构建好的有序链
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::import_sorted_runs(std::vector<SortedRun> &runs, WalTicket<K, V> &ticket, std::unique_ptr<CountingBloomFilter> *filter)
 {
-    //  验证字符串是否有效
-    if(!is_valid_string(str))
+    //  构建出的节点版本号为 0，持有 _view_gate 保证拼接时没有打开的视图，它们对之后打开的视图都可见
+    std::lock_guard<std::mutex> gate(_view_gate);
+    std::lock_guard<LockPolicy> lock(_lock);
+    if (_header->get_next(0) == nullptr)
     {
-        return;
+        //  恢复快照中的过滤器：拼接期间先撤下过滤器，拼接完成后发布，过滤器中的键不少于跳表中的键
+        bool restore_filter = filter != nullptr && *filter;
+        if (restore_filter)
+        {
+            install_bloom_filter(nullptr);
+        }
+        int inserted = stitch_sorted_runs(runs, ticket);
+        runs.clear();   //  节点已属于跳表
+        if (restore_filter)
+        {
+            install_bloom_filter(filter->release());
+            LOG_INFO << "Restored bloom filter from snapshot.";
+        }
+        return inserted;
     }
-    *key = str.substr(0, str.find(delimiter));  //  获取key部分
-    *value = str.substr(str.find(delimiter)+1, str.length());   //  获取value部分
-}
 
-//  验证字符串是否有效
-template<typename K, typename V>
-bool SkipList<K, V>::is_valid_string(const std::string& str)
-{
-    // str为空
-    if (str.empty())
+    //  构建期间跳表变为非空，不能整段拼接，按段的顺序取出键值对走有序插入路径，已存在的键保持不变
+    size_t total = 0;
+    for (const SortedRun &run : runs)
     {
-        return false;
+        total += static_cast<size_t>(run.count);
     }
-    //  str中不包含 : 分隔符
-    if (str.find(delimiter) == std::string::npos)
+    std::vector<std::pair<K, V>> items;
+    items.reserve(total);
+    for (SortedRun &run : runs)
     {
-        return false;
+        for (Node<K, V, Features> *node = run.count > 0 ? run.head[0] : nullptr; node != nullptr; node = node->get_next(0))
+        {
+            items.emplace_back(node->get_key(), std::move(node->get_value()));
+        }
+        free_sorted_run(run);
     }
-    return true;
+    runs.clear();
+    return insert_sorted(items.begin(), items.end(), ticket);
 }
 
-// 从跳表中删除元素
-template<typename K, typename V>
-void SkipList<K, V>::delete_element(K key)
+// 拼接各段的有序链：每一层把上一段的尾节点接到下一段的首节点，跨度按段的排名偏移换算
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+int SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::stitch_sorted_runs(std::vector<SortedRun> &runs, WalTicket<K, V> &ticket)
 {
-
-    mtx.lock(); //  互斥锁，保障并发安全性
-    Node<K, V> *current = this->_header;
-    Node<K, V> *update[_max_level+1];   //  存储需要删除的节点前一个节点
-    memset(update, 0, sizeof(Node<K, V>*)*(_max_level+1));  //初始化为NULL
-
-    // 从跳表的最高层级开始查找需要删除的元素
-    for (int i = _skip_list_level; i >= 0; i--)
+    SpanWrite span_write(*this);
+    //  过滤器先于链接加入键，与 link_node 一致，读者能找到的键一定能通过过滤器
+    if (CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_relaxed))
     {
-        //  当前层下一节点存在 且 下一节点key值 小于目标key值
-        while (current->forward[i] !=NULL && current->forward[i]->get_key() < key)
+        for (SortedRun &run : runs)
         {
-            current = current->forward[i];  //向右走
+            for (Node<K, V, Features> *node = run.count > 0 ? run.head[0] : nullptr; node != nullptr; node = node->get_next(0))
+            {
+                filter->add(filter_hash(node->get_key()));
+            }
         }
-        update[i] = current;    //  更新update数组
     }
 
-    current = current->forward[0];
-    //  不为空且键值相等 找到要删除的节点
-    if (current != NULL && current->get_key() == key)
+    Node<K, V, Features> *tail[_max_level+1];
+    int tail_rank[_max_level+1];    //  tail[i] 的排名，头节点为 0
+    for (int i = 0; i <= _max_level; i++)
     {
+        tail[i] = _header;
+        tail_rank[i] = 0;
+    }
 
-        //  从删除节点的层级开始删除，向更低层级遍历，保证在更低的层级一定满足删除条件
-        for(int i=current->node_level;i>=0;i--)
+    int list_level = _skip_list_level.load(std::memory_order_relaxed);
+    int offset = 0;     //  已接入的节点数，即当前段的排名偏移
+    size_t charge = 0;
+    for (SortedRun &run : runs)
+    {
+        //  某层没有节点时更高层也没有
+        for (int i = 0; i <= _max_level && run.count > 0 && run.head[i] != nullptr; i++)
         {
-            update[i]->forward[i] = current->forward[i];
+            if constexpr (Features::kRank)
+            {
+                tail[i]->set_span(i, offset + run.head_rank[i] - tail_rank[i]);
+            }
+            tail[i]->set_next(i, run.head[i]);
+            tail[i] = run.tail[i];
+            tail_rank[i] = offset + run.tail_rank[i];
+            if (i > list_level)
+            {
+                list_level = i;
+            }
         }
+        offset += run.count;
+        charge += run.charge;
+    }
 
-        // 删除无元素的层级,从最高层级开始遍历
-        while (_skip_list_level > 0 && _header->forward[_skip_list_level] == 0)
+    //  各层尾节点的后继为空，跨度为到表尾的节点数
+    if constexpr (Features::kRank)
+    {
+        for (int i = 0; i <= _max_level; i++)
         {
-            _skip_list_level --;
+            tail[i]->set_span(i, offset - tail_rank[i]);
         }
-
-        std::cout << "Successfully deleted key "<< key << std::endl;
-        delete current;     // 释放删除的节点的内存
-        _element_count --;  // 元素计数减一
     }
-    mtx.unlock();   //  解锁互斥量
-}
 
-// 在跳表中根据给定key值搜索元素
-template<typename K, typename V>
-bool SkipList<K, V>::search_element(K key)
-{
-    Node<K, V> *current = _header;  //  初始化current为跳表头节点
+    //  所有链接发布之后再提升层数，读者从新层数下降时看到的都是完整的链
+    _skip_list_level.store(list_level, std::memory_order_release);
+    _element_count.fetch_add(offset, std::memory_order_relaxed);
+    if constexpr (Features::kMemoryBudget)
+    {
+        _memory_bytes.fetch_add(charge, std::memory_order_relaxed);
+    }
 
-    // 从跳表最高层级开始遍历
-    for (int i = _skip_list_level; i >= 0; i--)
+    //  索引、日志与增量快照的变更日志只能由一个写者维护，拼接之后沿第 0 层顺序补上
+    HashIndex *index = _hash_index.load(std::memory_order_relaxed);
+    bool logged = _wal != nullptr || _change_log != nullptr;
+    if (index != nullptr || logged)
     {
-        //  如果当前层 下一节点存在 且 key值<参数key值
-        while (current->forward[i] && current->forward[i]->get_key() < key)
+        for (Node<K, V, Features> *node = _header->get_next(0); node != nullptr; node = node->get_next(0))
         {
-            current = current->forward[i];  //向右走
+            if (index != nullptr)
+            {
+                index->insert(node);
+            }
+            if (logged)
+            {
+                ticket = log_operation(WalOp::Insert, &node->get_key(), &node->get_value());
+            }
         }
     }
+    evict_to_budget(ticket);
+    return offset;
+}
 
-    //  到达最底层，将节点移动到搜索元素的位置
-    current = current->forward[0];
-
-    // 如果当前节点的key值与参数key值相等，我们就找到了要搜索的节点
-    if (current and current->get_key() == key)
+// 释放尚未接入跳表的有序链
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::free_sorted_run(SortedRun &run)
+{
+    Node<K, V, Features> *node = run.count > 0 ? run.head[0] : nullptr;
+    while (node != nullptr)
     {
-        return true;
+        Node<K, V, Features> *next = node->get_next(0);
+        destroy_node(node);
+        node = next;
     }
-    return false;
+    run = SortedRun();
 }
 
-// 在跳表中根据给定key值搜索元素，并将对应值返回
-template<typename K, typename V>
-V* SkipList<K, V>::search_element_value(K key)
+// 增量保存：换出变更日志并写成链上的下一个增量
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::save_incremental_snapshot(const std::string &file_name, size_t max_deltas)
 {
-    Node<K, V> *current = _header;
+    static_assert(has_snapshot_codec<K>::value && has_snapshot_codec<V>::value,
+                  "incremental snapshots require SnapshotCodec for both K and V");
+    std::lock_guard<std::mutex> saving(_delta_mutex);
+
+    //  增量太多或累计太大时，重放它们不比重写基准便宜
+    if (_delta_chain == 0 || _delta_file != file_name || _delta_sequence >= max_deltas || _delta_bytes * 2 > _delta_base_bytes)
+    {
+        return write_delta_base(file_name);
+    }
 
-    for (int i = _skip_list_level; i >= 0; i--)
+    ChangeLog<K, V, Compare> changes;
     {
-        while (current->forward[i] && current->forward[i]->get_key() < key)
+        std::lock_guard<LockPolicy> lock(_lock);
+        if (_change_log->empty())
         {
-            current = current->forward[i];
+            return true;    //  没有变化，不写文件
         }
+        std::swap(changes, *_change_log);
     }
 
-    current = current->forward[0];
-
-    if (current != nullptr && current->get_key() == key) {
-        return &(current->get_value()); //返回指向找到的元素值的指针
+    std::string encoded;
+    changes.encode(_delta_chain, _delta_sequence + 1, encoded);
+    if (!write_file_replacing(delta_file_path(file_name, _delta_chain, _delta_sequence + 1), encoded))
+    {
+        //  换出的变化已不在变更日志中，这条链不能再接续，下一次保存重写基准
+        _delta_chain = 0;
+        return false;
     }
-    return nullptr; // 如果未找到，返回null指针
+    _delta_sequence++;
+    _delta_bytes += encoded.size();
+    LOG_INFO << "Saved incremental snapshot delta " << _delta_sequence << " of chain " << _delta_chain << " with "
+             << changes.size() << " changed keys (" << encoded.size() << " bytes).";
+    return true;
 }
 
-// 跳表 构造函数
-template<typename K, typename V>
-SkipList<K, V>::SkipList(int max_level)
+// 压缩增量快照
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::compact_incremental_snapshot(const std::string &file_name)
 {
+    static_assert(has_snapshot_codec<K>::value && has_snapshot_codec<V>::value,
+                  "incremental snapshots require SnapshotCodec for both K and V");
+    std::lock_guard<std::mutex> saving(_delta_mutex);
+    return write_delta_base(file_name);
+}
 
-    this->_max_level = max_level;   // 设置跳表的最大层级数
-    this->_skip_list_level = 0;     // 初始化跳表的层级数为0
-    this->_element_count = 0;       // 初始化跳表的元素计数为0
-
-    // 创建头节点并将键和值初始化为 null
-    K k;
-    V v;
-    this->_header = new Node<K, V>(k, v, _max_level);   // 创建头节点，指定最大层级数
-};
-
-//  跳表 析构函数，回收内存空间
-template<typename K, typename V>
-SkipList<K, V>::~SkipList()
+// 写基准快照 -> 提交清单 -> 删除旧链
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::write_delta_base(const std::string &file_name)
 {
-    LOG_INFO << "Destroying skiplist";
-    if (_file_writer.is_open())
+    LOG_INFO << "Compacting SkipList incremental snapshot " << file_name;
+
+    //  新链的编号大于清单中的链，旧链的增量不会被误用到新基准上；清单不存在或已损坏时从 1 开始
+    uint64_t previous = 0;
     {
-        _file_writer.close();
+        MappedFile file;
+        if (file.open(file_name))
+        {
+            previous = decode_incremental_manifest(file.data(), file.size());
+        }
     }
-    if (_file_reader.is_open())
+    uint64_t chain = previous + 1;
+    _delta_chain = 0;
+
+    //  清单丢失后编号可能重复，先删除同编号的残留增量
+    for (uint64_t sequence = 1; std::remove(delta_file_path(file_name, chain, sequence).c_str()) == 0; sequence++)
     {
-        _file_reader.close();
     }
 
-    //  循环删除节点
-    Node<K, V>* current = _header->forward[0];
-    while(current) {
-        Node<K, V>* tmp = current->forward[0];
-        delete current;
-        current = tmp;
+    //  与 save_snapshot 相同，开启了过滤器时另建一个与基准内容一致的过滤器
+    std::unique_ptr<CountingBloomFilter> snapshot_filter;
+    {
+        auto guard = read_guard();
+        if (const CountingBloomFilter *filter = _bloom_filter.load(std::memory_order_acquire))
+        {
+            snapshot_filter.reset(new CountingBloomFilter(filter->block_count(), filter->hash_count()));
+        }
     }
-    delete _header; //  删除头节点
-}
 
-//  随机生成层级数
-template<typename K, typename V>
-int SkipList<K, V>::get_random_level()
-{
-
-    int k = 0;  //  初始化层级为0
-    while (rand() % 2)
+    std::lock_guard<std::mutex> gate(_view_gate);
+    ViewState view;
+    Node<K, V, Features> *live;
     {
-        k++;
+        //  打开视图并在同一次加锁内清空变更日志：视图之后的写操作全部记入变更日志，之前的全部包含在基准中
+        std::unique_lock<LockPolicy> lock(_lock);
+        open_view(view, lock);
+        live = _header->get_next(0);
+        if (_change_log == nullptr)
+        {
+            _change_log.reset(new ChangeLog<K, V, Compare>());
+        }
+        else
+        {
+            _change_log->clear();
+        }
     }
-    k = (k < _max_level) ? k : _max_level;  // 将层级数限制在 _max_level 范围内
-    return k;
-};
 
-template <typename K, typename V>
-void SkipList<K, V>::clear()
-{
-    LOG_INFO << "Starting SkipList clear operation.";
-    // 遍历跳表的每一层，从最底层开始
-    Node<K, V>* current = _header->forward[0];
-    while (current != nullptr)
+    const std::string base_file = delta_base_path(file_name, chain);
+    SnapshotHeader header;
+    bool ok;
+    try
     {
-        Node<K, V>* temp = current;
-        current = current->forward[0]; // 移动到下一个节点
-        delete temp; // 删除当前节点
+        ok = write_snapshot_file(base_file, [&](auto &visit) { view_for_each(view, live, nullptr, nullptr, visit); },
+                                 snapshot_filter.get(), header);
     }
-
-    // 重置头节点的每一层指向
-    for (int i = 0; i < _max_level; ++i)
+    catch (...)
     {
-        _header->forward[i] = nullptr;
+        close_view(view);
+        throw;
     }
+    close_view(view);
 
-    // 重置跳表的当前层级和元素计数
-    _skip_list_level = 0; // 假设跳表初始化时至少有一层
-    _element_count = 0;
-    LOG_INFO << "SkipList cleared successfully.";
+    //  替换清单即提交新链
+    if (!ok || !write_file_replacing(file_name, encode_incremental_manifest(chain)))
+    {
+        std::remove(base_file.c_str());
+        return false;
+    }
+    remove_delta_files(file_name, chain);
+
+    _delta_file = file_name;
+    _delta_chain = chain;
+    _delta_sequence = 0;
+    _delta_bytes = 0;
+    _delta_base_bytes = header.payload_bytes;
+    LOG_INFO << "Successfully saved " << header.count << " elements to incremental snapshot base of chain " << chain << ".";
+    return true;
 }
 
-template<typename K, typename V>
-void SkipList<K, V>::load_from_json(const std::string& file_name)
+// 加载基准快照，再依次应用链上的增量
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::load_incremental_snapshot(const std::string &file_name)
 {
-    LOG_INFO << "Loading SkipList from JSON file: " << file_name;
-    std::ifstream ifs(file_name);
-    if (!ifs.is_open())
+    static_assert(has_snapshot_codec<K>::value && has_snapshot_codec<V>::value,
+                  "incremental snapshots require SnapshotCodec for both K and V");
+    LOG_INFO << "Loading SkipList incremental snapshot from " << file_name;
+
+    uint64_t chain = 0;
     {
-        LOG_ERROR << "Error: Cannot open file " << file_name;
-        std::cerr << "Error: Cannot open file " << file_name << std::endl;
-        return;
+        MappedFile file;
+        if (file.open(file_name))
+        {
+            chain = decode_incremental_manifest(file.data(), file.size());
+        }
     }
-
-    rapidjson::IStreamWrapper isw(ifs);
-    rapidjson::Document doc;
-    doc.ParseStream(isw);
-    ifs.close();
-
-    if (!doc.IsArray())
+    if (chain == 0)
     {
-        LOG_ERROR << "Error: JSON file must contain an array of key-value pairs.";
-        std::cerr << "Error: JSON file must contain an array of key-value pairs" << std::endl;
-        return;
+        LOG_ERROR << "Error: Cannot read incremental snapshot manifest " << file_name;
+        std::cerr << "Error: Cannot read incremental snapshot manifest " << file_name << std::endl;
+        return false;
+    }
+    if (size() != 0)
+    {
+        LOG_ERROR << "Error: Incremental snapshot can only be loaded into an empty SkipList.";
+        std::cerr << "Error: Incremental snapshot can only be loaded into an empty SkipList." << std::endl;
+        return false;
+    }
+    MappedFile base;
+    SnapshotHeader header;
+    if (!map_snapshot(delta_base_path(file_name, chain), base, header))
+    {
+        return false;
     }
 
-    for (rapidjson::SizeType i = 0; i < doc.Size(); i++)
+    //  先校验所有增量并按序折叠，任何一个损坏都不导入数据。序号连续，第一个不存在的增量就是链的末尾
+    ChangeLog<K, V, Compare> changes;
+    uint64_t sequence = 1;
+    for (;; sequence++)
     {
-        if (!doc[i].IsObject() || !doc[i].HasMember("key") || !doc[i].HasMember("value"))
+        MappedFile file;
+        if (!file.open(delta_file_path(file_name, chain, sequence)))
         {
-            std::cerr << "Error: Each key-value pair must be an object with 'key' and 'value'." << std::endl;
-            continue;
+            break;
+        }
+        DeltaContents<K, V> contents;
+        if (!decode_delta(file.data(), file.size(), chain, sequence, contents))
+        {
+            LOG_ERROR << "Error: Incremental snapshot delta " << sequence << " of chain " << chain << " is corrupted";
+            std::cerr << "Error: Incremental snapshot delta " << sequence << " of chain " << chain << " is corrupted" << std::endl;
+            return false;
         }
-        try {
-            if (!doc[i]["key"].IsInt() || !doc[i]["value"].IsString()) {
-                std::cerr << "Error: Key or value type mismatch in element " << i << "." << std::endl;
-                continue;
-            }
 
-            K key = doc[i]["key"].GetInt();
-            V value = doc[i]["value"].GetString();
-            insert_element(key, value);
+        if (contents.cleared)
+        {
+            changes.record(WalOp::Clear, nullptr, nullptr, nullptr);
         }
-        catch (const std::exception& e)
+        for (const auto &range : contents.ranges)
         {
-            std::cerr << "Error: Exception caught while processing key-value pair at index " << i << ": " << e.what() << std::endl;
-            continue;
+            changes.record(WalOp::DeleteRange, &range.first, nullptr, &range.second);
+        }
+        for (const auto &entry : contents.entries)
+        {
+            if (entry.second)
+            {
+                changes.record(WalOp::Insert, &entry.first, &*entry.second, nullptr);
+            }
+            else
+            {
+                changes.record(WalOp::Delete, &entry.first, nullptr, nullptr);
+            }
+        }
+    }
+
+    //  折叠后的变化与基准的有序记录归并，基准中无法解码的记录同样使加载失败
+    const char *payload = base.data() + sizeof(header);
+    bool failed = false;
+    SnapshotRecordIterator<K, V> first(payload, payload + header.payload_bytes, &failed);
+    SnapshotRecordIterator<K, V> last;
+    std::vector<std::pair<K, V>> items;
+    items.reserve(static_cast<size_t>(header.count));
+    changes.apply_to(first, last, items);
+    if (failed)
+    {
+        LOG_ERROR << "Error: Snapshot " << delta_base_path(file_name, chain) << " contains a malformed record.";
+        std::cerr << "Error: Snapshot " << delta_base_path(file_name, chain) << " contains a malformed record." << std::endl;
+        return false;
+    }
+
+    //  一次写锁内从空跳表顺序构建
+    WalTicket<K, V> ticket;
+    {
+        std::lock_guard<LockPolicy> lock(_lock);
+        if (_header->get_next(0) != nullptr)
+        {
+            LOG_ERROR << "Error: Incremental snapshot can only be loaded into an empty SkipList.";
+            std::cerr << "Error: Incremental snapshot can only be loaded into an empty SkipList." << std::endl;
+            return false;
         }
+        insert_sorted(items.begin(), items.end(), ticket);
     }
-    LOG_INFO << "Successfully loaded " << doc.Size() << " elements from JSON.";
+    ticket.commit_or_throw();
+    LOG_INFO << "Successfully loaded incremental snapshot chain " << chain << " with " << sequence - 1 << " deltas, "
+             << size() << " elements.";
+    return true;
 }
 
-template<typename K, typename V>
-void SkipList<K, V>::save_to_json(const std::string& basic_file_name)
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+void SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::save_to_json(const std::string& basic_file_name)
 {
     // 获取当前时间点
     auto now = std::chrono::system_clock::now();
@@ -961,66 +5221,71 @@ void SkipList<K, V>::save_to_json(const std::string& basic_file_name)
     std::string file_name_with_time = "C:/SoftWare/VScode-dir/KVengine_cpp/store/" + basic_file_name + "_" + time_str + ".json";
     LOG_INFO << "Saving SkipList to JSON file: " << file_name_with_time;
 
-    // 使用新的文件名打开文件输出流
-    std::ofstream ofs(file_name_with_time);
-    if (!ofs.is_open())
+    // 使用新的文件名打开文件，二进制模式下不做换行转换
+    std::FILE *fp = std::fopen(file_name_with_time.c_str(), "wb");
+    if (fp == nullptr)
     {
         LOG_ERROR << "Error: Cannot open file " << file_name_with_time;
         std::cerr << "Error: Cannot open file " << file_name_with_time << std::endl;
         return;
     }
 
-    // 写JSON数据到文件
-    rapidjson::OStreamWrapper osw(ofs);
-    rapidjson::Document doc;
-    doc.SetArray();
-    rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
-
-    // 遍历跳表节点，并将它们存储到JSON文件中
-    Node<K, V>* node = this->_header->forward[0];
-    while (node != nullptr)
+    // Writer 直接写入带缓冲的文件流，缓冲区写满时整块写出，不在内存中构建整个文档
+    std::unique_ptr<char[]> buffer(new char[kJsonWriteBufferSize]);
+    rapidjson::FileWriteStream os(fp, buffer.get(), kJsonWriteBufferSize);
+    rapidjson::Writer<rapidjson::FileWriteStream> writer(os);
+
+    // 按一致性视图遍历跳表节点，边遍历边写出；保存期间写操作不被阻塞
+    size_t count = 0;
+    writer.StartArray();
+    consistent_for_each([&](const K &key, const V &value) {
+        writer.StartObject();
+        writer.Key("key", 3);
+        writer.Int(key);
+        writer.Key("value", 5);
+        writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+        writer.EndObject();
+        count++;
+    });
+    writer.EndArray();
+    os.Flush();
+
+    // FileWriteStream 忽略 fwrite 的返回值，写入错误由文件的错误标志与 fclose 的返回值反映
+    bool failed = std::ferror(fp) != 0;
+    failed = std::fclose(fp) != 0 || failed;
+    if (failed)
     {
-        rapidjson::Value obj(rapidjson::kObjectType);
-
-        obj.AddMember("key", rapidjson::Value().SetInt(node->get_key()), allocator);
-        obj.AddMember("value", rapidjson::Value().SetString(node->get_value().c_str(), allocator), allocator);
-
-        doc.PushBack(obj, allocator);
-        node = node->forward[0];
+        LOG_ERROR << "Error: Failed to write " << file_name_with_time;
+        std::cerr << "Error: Failed to write " << file_name_with_time << std::endl;
+        return;
     }
 
-    // 利用Writer类快速写入数据到文档流中
-    rapidjson::Writer<rapidjson::OStreamWrapper> writer(osw);
-    doc.Accept(writer);
-
-    // 关闭文件流
-    ofs.close();
-
-    LOG_INFO << "SkipList successfully saved to JSON.";
+    LOG_INFO << "SkipList successfully saved " << count << " elements to JSON.";
 }
 
-template<typename K, typename V>
-bool SkipList<K, V>::skiplist_equals(const SkipList<K, V>& other) const
+template<typename K, typename V, typename LockPolicy, typename Alloc, typename Compare, typename Hash, typename Features>
+bool SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>::skiplist_equals(const SkipList<K, V, LockPolicy, Alloc, Compare, Hash, Features>& other) const
 {
-    Node<K, V>* currentThis = this->_header->forward[0];
-    Node<K, V>* currentOther = other._header->forward[0];
+    const_iterator currentThis = this->begin();
+    const_iterator currentOther = other.begin();
 
     // 同时遍历两个跳表的最低层
-    while (currentThis != nullptr && currentOther != nullptr)
+    while (currentThis != this->end() && currentOther != other.end())
     {
         // 检查键和值是否一致
-        if (currentThis->get_key() != currentOther->get_key() || currentThis->get_value() != currentOther->get_value())
+        if (key_less(currentThis->get_key(), currentOther->get_key()) || key_less(currentOther->get_key(), currentThis->get_key())
+            || currentThis->get_value() != currentOther->get_value())
         {
             return false; // 发现不一致的键值对，立即返回false
         }
         
         // 移动到下一个节点
-        currentThis = currentThis->forward[0];
-        currentOther = currentOther->forward[0];
+        ++currentThis;
+        ++currentOther;
     }
 
     // 如果两个跳表的最低层同时遍历完毕，则它们一致；否则，不一致
-    return currentThis == nullptr && currentOther == nullptr;
+    return currentThis == this->end() && currentOther == other.end();
 }
 
 /**
@@ -1043,7 +5308,7 @@ public:
 
     /**
      * run方法启动命令行接口并接受用户命令，直到用户选择退出。
-     * 目前支持的命令包括INSERT, DELETE, UPDATE, SEARCH, DISPLAY, SIZE, CLEAR, EXIT。
+     * 目前支持的命令包括INSERT, DELETE, UPDATE, SEARCH, DISPLAY, SIZE, CLEAR, SAVE, LOAD, EXIT。
      */
     void run()
     {
@@ -1051,7 +5316,7 @@ public:
         K key;
         V value;
         std::cout << "SkipList Console Interface" << std::endl;
-        std::cout << "Available commands: INSERT <key> <value>, DELETE <key>, UPDATE <key> <value>, SEARCH <key>, DISPLAY, SIZE, CLEAR, EXIT" << std::endl;
+        std::cout << "Available commands: INSERT <key> <value>, DELETE <key>, UPDATE <key> <value>, SEARCH <key>, DISPLAY, SIZE, CLEAR, SAVE <file>, LOAD <file>, EXIT" << std::endl;
         
         while (true)
         {
@@ -1121,6 +5386,18 @@ public:
                 _list.clear();
                 std::cout << "List cleared.\n";
             }
+            else if (command == "SAVE")
+            {
+                std::string file_name;
+                iss >> file_name;
+                _list.save_snapshot(file_name) ? std::cout << "Snapshot saved.\n" : std::cout << "Failed to save snapshot.\n";
+            }
+            else if (command == "LOAD")
+            {
+                std::string file_name;
+                iss >> file_name;
+                _list.load_snapshot(file_name) ? std::cout << "Snapshot loaded.\n" : std::cout << "Failed to load snapshot.\n";
+            }
             else if (command == "EXIT")
             {
                 std::cout << "Exiting...\n";
@@ -1155,32 +5432,56 @@ private:
     }
 };
 
+/**
+ * @brief 自动保存的文件格式
+ */
+enum class AutoSaveFormat
+{
+    Json,           // 每次把整个跳表写成带时间标签的 JSON 文件(save_to_json)
+    Incremental     // 增量快照(save_incremental_snapshot)，只写出修改过的键，键与值需要 SnapshotCodec
+};
+
 /**
  * @class AutoSaveSkipList
  * @brief 继承自SkipList，增加了自动保存功能的跳表。
  * @details 该类扩展了SkipList，通过后台线程定期将跳表数据自动保存到JSON文件，以实现数据的持久化。
+ *          每次保存都基于 consistent_for_each 的一致性视图：文件内容是保存开始那一刻的跳表，
+ *          保存期间前台写操作不需要等待，只有视图打开时第一次修改的键需要额外复制一个节点。
+ *          Format 为 AutoSaveFormat::Incremental 时改为保存增量快照：第一次保存写出完整的基准，
+ *          之后只写出这段时间内被修改的键，没有修改时不写文件，可以用 load_incremental_snapshot 加载。
  * @tparam K SkipList中键的类型。
  * @tparam V SkipList中值的类型。
+ * @tparam Format 自动保存的文件格式，默认 JSON。
+ * @note 节点使用 ViewNodeFeatures：保存依赖版本号在不阻塞写操作的情况下遍历一致性视图。
  */
-template<typename K, typename V>
-class AutoSaveSkipList : public SkipList<K, V>
+template<typename K, typename V, AutoSaveFormat Format = AutoSaveFormat::Json>
+class AutoSaveSkipList : public SkipList<K, V, MutexLock, DefaultNodeAllocator, std::less<>, std::hash<K>, ViewNodeFeatures>
 {
+    using Base = SkipList<K, V, MutexLock, DefaultNodeAllocator, std::less<>, std::hash<K>, ViewNodeFeatures>;
+
     std::thread autoSaveThread;
     std::atomic<bool> stopAutoSaveThread = false;
 
     /**
-     * @class AutoSaveSkipList
-     * @brief 继承自SkipList，增加了自动保存功能的跳表。
-     * @details 该类扩展了SkipList，通过后台线程定期将跳表数据自动保存到JSON文件，以实现数据的持久化。
-     * @tparam K SkipList中键的类型。
-     * @tparam V SkipList中值的类型。
+     * @brief 自动保存线程的主循环。
+     * @details 每隔 intervalSeconds 秒保存一次。增量快照的清单为 <STORE_FILE 所在目录>/<filename>_autosave.snap。
+     * @param filename 保存文件的基础文件名。
+     * @param intervalSeconds 自动保存的时间间隔（秒）。
      */
     void autoSaveRoutine(const std::string& filename, unsigned int intervalSeconds)
     {
+        const std::string snapshot_file = (std::filesystem::path(STORE_FILE).parent_path() / (filename + "_autosave.snap")).string();
         while (!stopAutoSaveThread.load())
         {
             std::this_thread::sleep_for(std::chrono::seconds(intervalSeconds));
-            this->save_to_json(filename + "_autosave");
+            if constexpr (Format == AutoSaveFormat::Incremental)
+            {
+                this->save_incremental_snapshot(snapshot_file);
+            }
+            else
+            {
+                this->save_to_json(filename + "_autosave");
+            }
         }
     }
 
@@ -1193,7 +5494,7 @@ public:
      * @param intervalSeconds 自动保存到文件的时间间隔（秒）。
      */
     AutoSaveSkipList(int maxLevel, const std::string& filename, unsigned int intervalSeconds) 
-        : SkipList<K, V>(maxLevel) {
+        : Base(maxLevel) {
         autoSaveThread = std::thread(&AutoSaveSkipList::autoSaveRoutine, this, filename, intervalSeconds);
     }
 
@@ -0,0 +1,622 @@
+#ifndef KVENGINE_SNAPSHOT_H
+#define KVENGINE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "bloom_filter.h"
+
+/**
+ * @file snapshot.h
+ * @brief 跳表二进制快照格式。
+ *
+ * 文件布局(小端序)：
+ * - SnapshotHeader                     固定 40 字节的文件头
+ * - 记录 × count                       [u32 键长度][键字节][u32 值长度][值字节]，按键递增排列
+ * - 可选：SnapshotFilterSection + 过滤器  版本 2 起，保存时开启了布隆过滤器才写出
+ *
+ * 文件头中的 checksum 是所有记录字节的 FNV-1a 64 位哈希，加载前先校验，损坏或截断的快照不会被部分导入。
+ * 过滤器段有自己的校验和，段损坏时只丢弃过滤器，记录照常加载。
+ *
+ * 分区快照把键空间切成若干连续区间，每个区间是一个独立的快照文件(段)，另有一个清单文件按键序列出所有段：
+ * - SnapshotManifestHeader             固定 40 字节的清单头
+ * - 段条目 × segment_count             [u32 文件名长度][文件名][u64 记录数][u64 记录区字节数][u64 记录区校验和]
+ * 文件名相对于清单所在的目录。清单头中的 checksum 是所有段条目字节的 FNV-1a 64 位哈希。
+ */
+
+constexpr char kSnapshotMagic[8] = {'K', 'V', 'S', 'N', 'A', 'P', '0', '1'};
+constexpr uint32_t kSnapshotVersion = 2;
+
+/**
+ * @brief 快照文件头
+ */
+struct SnapshotHeader
+{
+    char magic[8];          // 文件标识 "KVSNAP01"
+    uint32_t version;       // 格式版本
+    uint32_t max_level;     // 写入时跳表的最大层级数
+    uint64_t count;         // 记录数量
+    uint64_t payload_bytes; // 记录区总字节数
+    uint64_t checksum;      // 记录区的 FNV-1a 64 位哈希
+};
+
+static_assert(sizeof(SnapshotHeader) == 40, "SnapshotHeader must be packed to 40 bytes");
+
+constexpr char kSnapshotFilterMagic[8] = {'K', 'V', 'B', 'L', 'O', 'O', 'M', '1'};
+
+/**
+ * @brief 快照中布隆过滤器段的段头，紧跟在记录区之后
+ *
+ * key_hash 是第一条记录的键的哈希值。加载时重新计算并比较，哈希函数的实现变化(例如更换标准库)后
+ * 旧过滤器与新哈希不再对应，此时丢弃过滤器而不是带着假阴性继续使用。
+ */
+struct SnapshotFilterSection
+{
+    char magic[8];          // 段标识 "KVBLOOM1"
+    uint64_t key_hash;      // 第一条记录的键的哈希值，没有记录时为 0
+    uint64_t bytes;         // 过滤器编码的字节数
+    uint64_t checksum;      // 过滤器编码的 FNV-1a 64 位哈希
+};
+
+static_assert(sizeof(SnapshotFilterSection) == 32, "SnapshotFilterSection must be packed to 32 bytes");
+
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+/**
+ * @brief 增量计算 FNV-1a 64 位哈希
+ *
+ * @param data 数据起始地址
+ * @param size 数据字节数
+ * @param hash 之前数据的哈希值，首次调用传入 kFnvOffsetBasis
+ * @return uint64_t 追加本段数据后的哈希值
+ */
+inline uint64_t fnv1a64(const void *data, size_t size, uint64_t hash = kFnvOffsetBasis)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+/**
+ * @brief 键/值与字节串之间的编解码
+ *
+ * 默认支持算术类型(按内存表示原样写入)与 std::string，其他类型需要特化本模板：
+ * - static void encode(const T &value, std::string &out)   将编码追加到 out
+ * - static bool decode(const char *data, size_t size, T &value)
+ */
+template<typename T, typename Enable = void>
+struct SnapshotCodec;
+
+template<typename T>
+struct SnapshotCodec<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+    static void encode(const T &value, std::string &out)
+    {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static bool decode(const char *data, size_t size, T &value)
+    {
+        if (size != sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        return true;
+    }
+};
+
+template<>
+struct SnapshotCodec<std::string>
+{
+    static void encode(const std::string &value, std::string &out)
+    {
+        out.append(value);
+    }
+
+    static bool decode(const char *data, size_t size, std::string &value)
+    {
+        value.assign(data, size);
+        return true;
+    }
+};
+
+/**
+ * @brief 判断类型 T 是否有可用的 SnapshotCodec
+ */
+template<typename T, typename = void>
+struct has_snapshot_codec : std::false_type {};
+
+template<typename T>
+struct has_snapshot_codec<T, decltype(SnapshotCodec<T>::encode(std::declval<const T &>(), std::declval<std::string &>()))>
+    : std::true_type {};
+
+/**
+ * @brief 将一个 [u32 长度][编码字节] 字段追加到缓冲区
+ */
+template<typename T>
+void append_snapshot_field(const T &field, std::string &out)
+{
+    size_t length_pos = out.size();
+    out.append(sizeof(uint32_t), '\0');     //  长度占位，编码后回填
+    SnapshotCodec<T>::encode(field, out);
+    uint32_t length = static_cast<uint32_t>(out.size() - length_pos - sizeof(uint32_t));
+    std::memcpy(&out[length_pos], &length, sizeof(length));
+}
+
+/**
+ * @brief 读取并解码一个 [u32 长度][编码字节] 字段
+ *
+ * @param cursor 字段起始位置，成功时前移到字段之后
+ * @param end 可读数据的结束位置
+ * @param field 解码结果
+ * @return bool 越界或解码失败时返回 false，cursor 不变
+ */
+template<typename T>
+bool read_snapshot_field(const char *&cursor, const char *end, T &field)
+{
+    uint32_t length;
+    if (static_cast<size_t>(end - cursor) < sizeof(length))
+    {
+        return false;
+    }
+    std::memcpy(&length, cursor, sizeof(length));
+    if (static_cast<size_t>(end - cursor) - sizeof(length) < length
+        || !SnapshotCodec<T>::decode(cursor + sizeof(length), length, field))
+    {
+        return false;
+    }
+    cursor += sizeof(length) + length;
+    return true;
+}
+
+/**
+ * @brief 将一条键值记录追加到缓冲区
+ */
+template<typename K, typename V>
+void append_snapshot_record(const K &key, const V &value, std::string &out)
+{
+    append_snapshot_field(key, out);
+    append_snapshot_field(value, out);
+}
+
+/**
+ * @brief 将过滤器段(段头 + 过滤器编码)追加到缓冲区
+ *
+ * @param key_hash 第一条记录的键的哈希值，没有记录时为 0
+ */
+inline void append_snapshot_filter(const CountingBloomFilter &filter, uint64_t key_hash, std::string &out)
+{
+    std::string encoded;
+    filter.encode(encoded);
+
+    SnapshotFilterSection section = {};
+    std::memcpy(section.magic, kSnapshotFilterMagic, sizeof(section.magic));
+    section.key_hash = key_hash;
+    section.bytes = encoded.size();
+    section.checksum = fnv1a64(encoded.data(), encoded.size());
+    out.append(reinterpret_cast<const char *>(&section), sizeof(section));
+    out.append(encoded);
+}
+
+/**
+ * @brief 解码记录区之后的过滤器段
+ *
+ * @param data 记录区之后的数据
+ * @param size 记录区之后的字节数
+ * @param key_hash 按当前哈希函数计算的第一条记录的键的哈希值，没有记录时为 0
+ * @return 段不存在、损坏或与当前哈希函数不一致时返回空指针
+ */
+inline std::unique_ptr<CountingBloomFilter> read_snapshot_filter(const char *data, size_t size, uint64_t key_hash)
+{
+    SnapshotFilterSection section;
+    if (size < sizeof(section))
+    {
+        return nullptr;
+    }
+    std::memcpy(&section, data, sizeof(section));
+    if (std::memcmp(section.magic, kSnapshotFilterMagic, sizeof(section.magic)) != 0 || section.key_hash != key_hash
+        || section.bytes != size - sizeof(section) || fnv1a64(data + sizeof(section), section.bytes) != section.checksum)
+    {
+        return nullptr;
+    }
+    return CountingBloomFilter::decode(data + sizeof(section), section.bytes);
+}
+
+constexpr char kSnapshotManifestMagic[8] = {'K', 'V', 'M', 'A', 'N', 'I', 'F', '1'};
+constexpr uint32_t kSnapshotManifestVersion = 1;
+
+/**
+ * @brief 分区快照清单头
+ *
+ * generation 每保存一次加一，段文件名中带有它，新一代的段不会覆盖旧清单仍在引用的段。
+ */
+struct SnapshotManifestHeader
+{
+    char magic[8];          // 文件标识 "KVMANIF1"
+    uint32_t version;       // 清单格式版本
+    uint32_t segment_count; // 段数
+    uint64_t generation;    // 快照代数
+    uint64_t count;         // 所有段的记录总数
+    uint64_t checksum;      // 段条目区的 FNV-1a 64 位哈希
+};
+
+static_assert(sizeof(SnapshotManifestHeader) == 40, "SnapshotManifestHeader must be packed to 40 bytes");
+
+/**
+ * @brief 清单中的一个段，段的记录数与校验和与段文件头一致
+ */
+struct SnapshotSegmentInfo
+{
+    std::string file;           // 段文件名，相对于清单所在的目录
+    uint64_t count = 0;         // 记录数
+    uint64_t payload_bytes = 0; // 记录区字节数
+    uint64_t checksum = 0;      // 记录区的 FNV-1a 64 位哈希
+};
+
+/**
+ * @brief 分区快照清单，段按键递增排列，段之间的键区间互不重叠
+ */
+struct SnapshotManifest
+{
+    uint64_t generation = 0;
+    std::vector<SnapshotSegmentInfo> segments;
+
+    /**
+     * @brief 所有段的记录总数
+     */
+    uint64_t count() const
+    {
+        uint64_t total = 0;
+        for (const SnapshotSegmentInfo &segment : segments)
+        {
+            total += segment.count;
+        }
+        return total;
+    }
+};
+
+/**
+ * @brief 将清单编码追加到缓冲区
+ */
+inline void encode_snapshot_manifest(const SnapshotManifest &manifest, std::string &out)
+{
+    std::string entries;
+    for (const SnapshotSegmentInfo &segment : manifest.segments)
+    {
+        append_snapshot_field(segment.file, entries);
+        entries.append(reinterpret_cast<const char *>(&segment.count), sizeof(segment.count));
+        entries.append(reinterpret_cast<const char *>(&segment.payload_bytes), sizeof(segment.payload_bytes));
+        entries.append(reinterpret_cast<const char *>(&segment.checksum), sizeof(segment.checksum));
+    }
+
+    SnapshotManifestHeader header = {};
+    std::memcpy(header.magic, kSnapshotManifestMagic, sizeof(header.magic));
+    header.version = kSnapshotManifestVersion;
+    header.segment_count = static_cast<uint32_t>(manifest.segments.size());
+    header.generation = manifest.generation;
+    header.count = manifest.count();
+    header.checksum = fnv1a64(entries.data(), entries.size());
+    out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.append(entries);
+}
+
+/**
+ * @brief 解码清单
+ *
+ * @return bool 格式不符、校验失败或记录总数不一致时返回 false
+ */
+inline bool decode_snapshot_manifest(const char *data, size_t size, SnapshotManifest &manifest)
+{
+    SnapshotManifestHeader header;
+    if (size < sizeof(header))
+    {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    const char *cursor = data + sizeof(header);
+    const char *end = data + size;
+    if (std::memcmp(header.magic, kSnapshotManifestMagic, sizeof(header.magic)) != 0 || header.version != kSnapshotManifestVersion
+        || fnv1a64(cursor, static_cast<size_t>(end - cursor)) != header.checksum)
+    {
+        return false;
+    }
+
+    manifest.generation = header.generation;
+    manifest.segments.clear();
+    for (uint32_t i = 0; i < header.segment_count; i++)
+    {
+        SnapshotSegmentInfo segment;
+        if (!read_snapshot_field(cursor, end, segment.file) || static_cast<size_t>(end - cursor) < 3 * sizeof(uint64_t))
+        {
+            return false;
+        }
+        std::memcpy(&segment.count, cursor, sizeof(segment.count));
+        std::memcpy(&segment.payload_bytes, cursor + 8, sizeof(segment.payload_bytes));
+        std::memcpy(&segment.checksum, cursor + 16, sizeof(segment.checksum));
+        cursor += 3 * sizeof(uint64_t);
+        manifest.segments.push_back(std::move(segment));
+    }
+    return cursor == end && manifest.count() == header.count;
+}
+
+/**
+ * @brief 段文件的路径：段文件名相对于清单所在的目录
+ */
+inline std::string snapshot_segment_path(const std::string &manifest_file, const std::string &segment_file)
+{
+    size_t slash = manifest_file.find_last_of("/\\");
+    return slash == std::string::npos ? segment_file : manifest_file.substr(0, slash + 1) + segment_file;
+}
+
+/**
+ * @brief 段文件名：<清单文件名>.<代数>-<序号>.seg，不含目录
+ */
+inline std::string snapshot_segment_name(const std::string &manifest_file, uint64_t generation, size_t index)
+{
+    size_t slash = manifest_file.find_last_of("/\\");
+    std::string base = slash == std::string::npos ? manifest_file : manifest_file.substr(slash + 1);
+    return base + "." + std::to_string(generation) + "-" + std::to_string(index) + ".seg";
+}
+
+/**
+ * @brief 只读内存映射文件
+ *
+ * 加载快照时直接在映射的内存上解码，不需要先把整个文件读入缓冲区。
+ * 以写时复制方式打开时映射可写，修改只落在进程私有的页副本上，不会写回文件，供原地(in-situ)解析使用。
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    /**
+     * @brief 以只读方式映射文件
+     *
+     * @param path 文件路径
+     * @param copy_on_write 为 true 时映射为写时复制，可以通过 writable_data() 修改
+     * @return bool 映射成功返回 true；文件不存在或为空时返回 false
+     */
+    bool open(const std::string &path, bool copy_on_write = false)
+    {
+        close();
+#ifdef _WIN32
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (_file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        _mapping = CreateFileMappingA(_file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping == nullptr)
+        {
+            close();
+            return false;
+        }
+        _data = static_cast<const char *>(MapViewOfFile(_mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+        if (_data == nullptr)
+        {
+            close();
+            return false;
+        }
+        _size = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        int protection = copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *data = mmap(nullptr, static_cast<size_t>(st.st_size), protection, MAP_PRIVATE, fd, 0);
+        ::close(fd);    //  映射建立后即可关闭描述符
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+        madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        _data = static_cast<const char *>(data);
+        _size = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    /**
+     * @brief 解除映射
+     */
+    void close()
+    {
+#ifdef _WIN32
+        if (_data != nullptr)
+        {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping != nullptr)
+        {
+            CloseHandle(_mapping);
+        }
+        if (_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(_file);
+        }
+        _mapping = nullptr;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        if (_data != nullptr)
+        {
+            munmap(const_cast<char *>(_data), _size);
+        }
+#endif
+        _data = nullptr;
+        _size = 0;
+        _discarded = 0;
+    }
+
+    const char *data() const
+    {
+        return _data;
+    }
+
+    /**
+     * @brief 可写的映射地址，只在以写时复制方式打开时可以写入
+     */
+    char *writable_data()
+    {
+        return const_cast<char *>(_data);
+    }
+
+    /**
+     * @brief 丢弃前 bytes 字节(按页向下取整)已经用完的内存
+     *
+     * 顺序处理大文件时，已处理部分的页(包括写时复制产生的私有副本)不必一直占用内存。
+     * 丢弃后再次访问会重新从文件读入，私有修改随之丢失，调用者只应丢弃之后不再访问的部分。
+     * Windows 下没有对应的操作，私有副本保留到解除映射。
+     */
+    void discard(size_t bytes)
+    {
+#ifndef _WIN32
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t end = (bytes < _size ? bytes : _size) / page * page;
+        if (end > _discarded)
+        {
+            madvise(const_cast<char *>(_data) + _discarded, end - _discarded, MADV_DONTNEED);
+            _discarded = end;
+        }
+#else
+        (void)bytes;
+#endif
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    const char *_data = nullptr;
+    size_t _size = 0;
+    size_t _discarded = 0;  // 已丢弃的前缀字节数，按页对齐
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#endif
+};
+
+/**
+ * @brief 快照记录区上的前向迭代器，逐条解码键值对
+ *
+ * 解引用得到 std::pair<K, V>，可以直接交给 SkipList 的有序批量插入。
+ * 遇到格式错误时迭代器提前变为 end()，并将构造时传入的 failed 标志置为 true。
+ */
+template<typename K, typename V>
+class SnapshotRecordIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    SnapshotRecordIterator() = default;
+
+    /**
+     * @param cursor 记录区起始地址
+     * @param end 记录区结束地址
+     * @param failed 可选，格式错误时被置为 true
+     */
+    SnapshotRecordIterator(const char *cursor, const char *end, bool *failed)
+        : _cursor(cursor), _end(end), _failed(failed)
+    {
+        decode();
+    }
+
+    reference operator*() const { return _record; }
+    pointer operator->() const { return &_record; }
+
+    SnapshotRecordIterator &operator++()
+    {
+        _cursor = _next;
+        decode();
+        return *this;
+    }
+
+    SnapshotRecordIterator operator++(int)
+    {
+        SnapshotRecordIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    //  end() 迭代器的游标为空
+    bool operator==(const SnapshotRecordIterator &other) const { return _cursor == other._cursor; }
+    bool operator!=(const SnapshotRecordIterator &other) const { return _cursor != other._cursor; }
+
+private:
+    void decode()
+    {
+        if (_cursor == nullptr || _cursor == _end)
+        {
+            _cursor = nullptr;
+            return;
+        }
+        const char *cursor = _cursor;
+        if (!read_snapshot_field(cursor, _end, _record.first) || !read_snapshot_field(cursor, _end, _record.second))
+        {
+            if (_failed != nullptr)
+            {
+                *_failed = true;
+            }
+            _cursor = nullptr;
+            return;
+        }
+        _next = cursor;
+    }
+
+    const char *_cursor = nullptr;  //  当前记录起始位置，nullptr 表示 end()
+    const char *_next = nullptr;    //  下一条记录起始位置
+    const char *_end = nullptr;     //  记录区结束位置
+    bool *_failed = nullptr;
+    std::pair<K, V> _record;        //  当前记录解码后的键值对
+};
+
+#endif // KVENGINE_SNAPSHOT_H
@@ -0,0 +1,17 @@
+#include <string>
+
+#include "SkipListTest.h"
+
+std::string delimiter = ":";    //  键值对之间的分隔符，主程序中定义在 benchmark.cpp
+
+/**
+ * @file test_main.cpp
+ * @brief 跳表行为测试的独立入口，供 ctest 调用。
+ *
+ * @return int 全部测试通过时返回 0，否则返回 1。
+ */
+int main()
+{
+    //  沿用日志库的默认输出(标准输出)，不写入主程序的日志目录
+    return run_skiplist_tests() ? 0 : 1;
+}
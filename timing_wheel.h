@@ -0,0 +1,201 @@
+#ifndef KVENGINE_TIMING_WHEEL_H
+#define KVENGINE_TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @file timing_wheel.h
+ * @brief 分层时间轮，为带过期时间的键安排到期检查。
+ *
+ * 时间以 tick 为单位，共 kLevels 层，每层 kSlots 个槽：第 0 层每个槽对应一个 tick，
+ * 第 l 层每个槽对应 kSlots^l 个 tick。到期时间离当前越远，登记的层越高；
+ * 当前 tick 走到高层某个槽覆盖的区间起点时，该槽内的条目按剩余时间重新分配到更低的层(级联)，
+ * 最终在第 0 层对应的 tick 到达时取出。登记与取出都是 O(1)，不需要为每个键维护定时器，也不扫描所有键。
+ *
+ * 时间轮不支持撤销：键被删除、重新插入或修改过期时间后，旧条目仍会按原时间取出，
+ * 由调用者对照键当前的过期时间判断条目是否仍然有效。
+ */
+
+/**
+ * @brief 分层时间轮
+ *
+ * @tparam K 条目携带的键类型
+ *
+ * @note 非线程安全，由调用者加锁。
+ */
+template<typename K>
+class TimingWheel
+{
+public:
+    static constexpr int kLevels = 5;                       // 层数
+    static constexpr int kSlotBits = 6;                     // 每层槽数的位数
+    static constexpr uint64_t kSlots = 1ULL << kSlotBits;   // 每层槽数
+
+    /**
+     * @param tick_ms 一个 tick 的毫秒数
+     * @param now_ms 当前时间(毫秒)，之后 advance 传入的时间不应早于它
+     */
+    explicit TimingWheel(uint64_t tick_ms = 1, uint64_t now_ms = 0);
+
+    /**
+     * @brief 登记一个到期时间
+     *
+     * 到期时间向上取整到 tick，条目不会早于 deadline_ms 取出；已经过期的时间在下一次 advance 时取出。
+     *
+     * @param key 键
+     * @param deadline_ms 到期时间(毫秒)，与 advance 使用同一时钟
+     */
+    void schedule(const K &key, uint64_t deadline_ms);
+
+    /**
+     * @brief 推进到 now_ms，取出期间到期的所有条目
+     *
+     * @tparam Callback 可调用对象，形如 void(const K &key, uint64_t deadline_ms)
+     * @param now_ms 当前时间(毫秒)
+     * @param on_due 对每个到期条目调用一次
+     * @return size_t 取出的条目数
+     */
+    template<typename Callback>
+    size_t advance(uint64_t now_ms, Callback on_due);
+
+    /**
+     * @brief 尚未取出的条目数(包括已失效的旧条目)
+     */
+    size_t size() const;
+
+    /**
+     * @brief 丢弃所有条目，当前时间不变
+     */
+    void clear();
+
+private:
+    struct Entry
+    {
+        K key;
+        uint64_t deadline_ms;   // 登记时的到期时间，取出时原样交给调用者
+    };
+
+    // 把条目放入与当前 tick 距离对应的层
+    void place(Entry entry);
+
+    // 把第 level 层的 slot 槽中的条目重新分配到更低的层
+    void cascade(int level, uint64_t slot);
+
+    std::vector<Entry> _slots[kLevels][kSlots];
+    uint64_t _tick_ms;  // 一个 tick 的毫秒数
+    uint64_t _current;  // 下一个待处理的 tick
+    size_t _size;       // 条目总数
+};
+
+template<typename K>
+TimingWheel<K>::TimingWheel(uint64_t tick_ms, uint64_t now_ms)
+    : _tick_ms(tick_ms == 0 ? 1 : tick_ms), _size(0)
+{
+    _current = now_ms / _tick_ms;
+}
+
+template<typename K>
+void TimingWheel<K>::schedule(const K &key, uint64_t deadline_ms)
+{
+    place(Entry{key, deadline_ms});
+    _size++;
+}
+
+//  逐个 tick 推进：先级联到达区间起点的高层槽，再取出第 0 层当前槽
+template<typename K>
+template<typename Callback>
+size_t TimingWheel<K>::advance(uint64_t now_ms, Callback on_due)
+{
+    uint64_t target = now_ms / _tick_ms;
+    size_t fired = 0;
+    while (_current <= target)
+    {
+        if (_size == 0)
+        {
+            _current = target + 1;  //  没有条目时直接跳到目标，不空转
+            break;
+        }
+
+        for (int level = kLevels - 1; level > 0; level--)
+        {
+            uint64_t shift = static_cast<uint64_t>(kSlotBits) * level;
+            if ((_current & ((1ULL << shift) - 1)) == 0)
+            {
+                cascade(level, (_current >> shift) & (kSlots - 1));
+            }
+        }
+
+        std::vector<Entry> due;
+        due.swap(_slots[0][_current & (kSlots - 1)]);
+        _current++;
+        _size -= due.size();
+        for (Entry &entry : due)
+        {
+            on_due(entry.key, entry.deadline_ms);
+        }
+        fired += due.size();
+    }
+    return fired;
+}
+
+template<typename K>
+size_t TimingWheel<K>::size() const
+{
+    return _size;
+}
+
+template<typename K>
+void TimingWheel<K>::clear()
+{
+    for (auto &level : _slots)
+    {
+        for (auto &slot : level)
+        {
+            std::vector<Entry>().swap(slot);
+        }
+    }
+    _size = 0;
+}
+
+//  条目放在第一个与当前 tick 高位相同的层：第 l 层要求两者在 l+1 层以上的位相同，槽号取第 l 层的 6 位
+template<typename K>
+void TimingWheel<K>::place(Entry entry)
+{
+    uint64_t tick = (entry.deadline_ms + _tick_ms - 1) / _tick_ms;
+    if (tick < _current)
+    {
+        tick = _current;    //  已过期的条目在下一个 tick 取出
+    }
+
+    for (int level = 0; level < kLevels; level++)
+    {
+        uint64_t shift = static_cast<uint64_t>(kSlotBits) * (level + 1);
+        if (shift >= 64 || (tick >> shift) == (_current >> shift))
+        {
+            uint64_t slot = (tick >> (kSlotBits * level)) & (kSlots - 1);
+            _slots[level][slot].push_back(std::move(entry));
+            return;
+        }
+    }
+
+    //  超出时间轮范围，放在最高层最后才会级联的槽，级联时再按剩余时间重新分配
+    uint64_t top_shift = static_cast<uint64_t>(kSlotBits) * (kLevels - 1);
+    uint64_t slot = ((_current >> top_shift) - 1) & (kSlots - 1);
+    _slots[kLevels - 1][slot].push_back(std::move(entry));
+}
+
+template<typename K>
+void TimingWheel<K>::cascade(int level, uint64_t slot)
+{
+    std::vector<Entry> entries;
+    entries.swap(_slots[level][slot]);
+    for (Entry &entry : entries)
+    {
+        place(std::move(entry));
+    }
+}
+
+#endif // KVENGINE_TIMING_WHEEL_H
@@ -0,0 +1,729 @@
+#ifndef KVENGINE_UNROLLED_SKIPLIST_H
+#define KVENGINE_UNROLLED_SKIPLIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define KVENGINE_UNROLLED_SIMD 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "logMod.h"
+#include "level_generator.h"
+#include "lock_policy.h"
+
+/**
+ * @file unrolled_skiplist.h
+ * @brief 整数键的展开跳表(胖节点跳表)。
+ *
+ * 普通跳表每个节点只有一个键，查找时每比较一个键就要读取一个新节点，几乎每一步都是一次缓存未命中。
+ * 展开跳表的每个节点保存一段连续的有序键(int 键默认 16 个，正好占满一条 64 字节缓存行)：
+ * - 跳表层只按各节点的最小键下降，节点数约为元素数的 1/10，向右走的步数与层数都随之减少；
+ * - 到达最底层后，在节点的键数组内用 SIMD 一次比较多个键，得到第一个不小于目标键的位置；
+ * - 插入时节点已满则对半分裂，删除后节点过空则与后继合并。
+ */
+
+namespace unrolled_detail
+{
+
+/**
+ * @brief 统计 32 位整数中 1 的个数
+ */
+inline int popcount32(uint32_t x)
+{
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt(x));
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+/**
+ * @brief 在升序键数组中查找第一个不小于 key 的位置
+ *
+ * 有符号 32 位键使用 SSE2/AVX2，有符号 64 位键使用 AVX2：把 key 广播到向量中，与整个数组逐块比较，
+ * 比较结果通过 movemask 压缩成位图，数组有序，因此小于 key 的个数就是所求位置。其他键类型逐个比较。
+ *
+ * @tparam K 键的类型
+ * @tparam Capacity 数组容量，SIMD 路径按容量整块比较，要求数组按 32 字节对齐
+ * @param keys 键数组，[0, count) 内按升序排列
+ * @param count 有效键的个数
+ * @param key 目标键
+ * @return int 取值 [0, count]
+ */
+template<typename K, int Capacity>
+inline int lower_bound_keys(const K *keys, int count, K key)
+{
+#if defined(KVENGINE_UNROLLED_SIMD)
+    if constexpr (std::is_signed<K>::value && sizeof(K) == 4)
+    {
+        uint32_t less = 0;
+#if defined(__AVX2__)
+        const __m256i needle = _mm256_set1_epi32(static_cast<int32_t>(key));
+        for (int i = 0; i < Capacity; i += 8)
+        {
+            __m256i block = _mm256_load_si256(reinterpret_cast<const __m256i *>(keys + i));
+            __m256i lt = _mm256_cmpgt_epi32(needle, block);
+            less |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(lt))) << i;
+        }
+#else
+        const __m128i needle = _mm_set1_epi32(static_cast<int32_t>(key));
+        for (int i = 0; i < Capacity; i += 4)
+        {
+            __m128i block = _mm_load_si128(reinterpret_cast<const __m128i *>(keys + i));
+            __m128i lt = _mm_cmplt_epi32(block, needle);
+            less |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(lt))) << i;
+        }
+#endif
+        uint32_t valid = count >= 32 ? ~0u : (1u << count) - 1;    //  只统计 [0, count) 内的键
+        return popcount32(less & valid);
+    }
+#if defined(__AVX2__)
+    if constexpr (std::is_signed<K>::value && sizeof(K) == 8)
+    {
+        uint32_t less = 0;
+        const __m256i needle = _mm256_set1_epi64x(static_cast<int64_t>(key));
+        for (int i = 0; i < Capacity; i += 4)
+        {
+            __m256i block = _mm256_load_si256(reinterpret_cast<const __m256i *>(keys + i));
+            __m256i lt = _mm256_cmpgt_epi64(needle, block);
+            less |= static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(lt))) << i;
+        }
+        uint32_t valid = count >= 32 ? ~0u : (1u << count) - 1;
+        return popcount32(less & valid);
+    }
+#endif
+#endif
+    //  无分支计数，编译器通常会自动向量化
+    int less = 0;
+    for (int i = 0; i < count; i++)
+    {
+        less += keys[i] < key;
+    }
+    return less;
+}
+
+} // namespace unrolled_detail
+
+/**
+ * @brief 展开跳表的胖节点
+ *
+ * 内存布局(整块按 64 字节对齐分配)：
+ * - keys[Capacity]                 升序键数组，位于节点的第一条缓存行
+ * - count、node_level、forward[]   元素个数、层级与柔性尾部的 node_level + 1 个后继指针
+ * - 值槽位 × Capacity              紧随后继指针之后，只有 [0, count) 内的槽位构造了对象
+ *
+ * 下降时读取 keys[0] 与 forward[i]，二者位于同一个 128 字节对齐块的两条相邻缓存行中，
+ * 值槽位只有在最终命中时才会被读取。
+ *
+ * @tparam K 键的类型，必须是整数
+ * @tparam V 值的类型
+ * @tparam Capacity 每个节点最多保存的键数
+ */
+template<typename K, typename V, int Capacity>
+struct alignas(64) UnrolledNode
+{
+    K keys[Capacity];                           // 升序键，[0, count) 有效
+    int count;                                  // 节点中的元素个数
+    int node_level;                             // 节点所在层
+    UnrolledNode<K, V, Capacity> *forward[1];   // 柔性尾部，实际长度为 node_level + 1，值槽位在其后
+
+    explicit UnrolledNode(int level) : count(0), node_level(level)
+    {
+        std::fill(keys, keys + Capacity, K());  //  SIMD 整块比较会读到未使用的槽位，先置零
+        for (int i = 0; i <= level; i++)
+        {
+            forward[i] = nullptr;
+        }
+    }
+
+    /**
+     * @brief 值槽位相对节点起始地址的偏移
+     */
+    static size_t values_offset(int level)
+    {
+        size_t end = offsetof(UnrolledNode, forward) + sizeof(UnrolledNode *) * (level + 1);
+        return (end + alignof(V) - 1) / alignof(V) * alignof(V);
+    }
+
+    /**
+     * @brief 层级为 level 的节点需要分配的字节数
+     */
+    static size_t storage_size(int level)
+    {
+        size_t size = values_offset(level) + sizeof(V) * Capacity;
+        return std::max(size, sizeof(UnrolledNode));
+    }
+
+    //  第 index 个值槽位的原始地址，用于原位构造
+    void *slot(int index)
+    {
+        return reinterpret_cast<char *>(this) + values_offset(node_level) + sizeof(V) * index;
+    }
+
+    //  第 index 个值，index 必须小于 count
+    V &value(int index)
+    {
+        return *std::launder(reinterpret_cast<V *>(slot(index)));
+    }
+
+    /**
+     * @brief 在 pos 处插入键值对，之后的元素整体后移一位
+     *
+     * @note 调用者保证节点未满且插入后键仍然有序。
+     */
+    void insert_at(int pos, K key, V &&val)
+    {
+        for (int i = count; i > pos; i--)
+        {
+            new (slot(i)) V(std::move(value(i - 1)));
+            value(i - 1).~V();
+        }
+        std::memmove(keys + pos + 1, keys + pos, sizeof(K) * (count - pos));
+        keys[pos] = key;
+        new (slot(pos)) V(std::move(val));
+        count++;
+    }
+
+    /**
+     * @brief 删除 pos 处的键值对，之后的元素整体前移一位
+     *
+     * @note 删除最后一个元素时 keys[0] 保持原值，摘除空节点时仍按它定位前驱。
+     */
+    void erase_at(int pos)
+    {
+        value(pos).~V();
+        for (int i = pos + 1; i < count; i++)
+        {
+            new (slot(i - 1)) V(std::move(value(i)));
+            value(i).~V();
+        }
+        std::memmove(keys + pos, keys + pos + 1, sizeof(K) * (count - pos - 1));
+        count--;
+    }
+
+    /**
+     * @brief 把 [from, count) 内的元素依次移动到 target 的末尾
+     *
+     * @note 调用者保证 target 容量足够，且这些键都大于 target 中已有的键。
+     */
+    void move_to(int from, UnrolledNode *target)
+    {
+        for (int i = from; i < count; i++)
+        {
+            target->keys[target->count] = keys[i];
+            new (target->slot(target->count)) V(std::move(value(i)));
+            value(i).~V();
+            target->count++;
+        }
+        count = from;
+    }
+};
+
+/**
+ * @brief 展开跳表
+ *
+ * 提供与 SkipList 相同的插入、查找、修改、删除、size、clear 接口，可以直接交给 benchmark 中的测试函数。
+ *
+ * @tparam K 键的类型，必须是整数
+ * @tparam V 值的类型
+ * @tparam LockPolicy 锁策略(见 lock_policy.h)。写操作持有 lock()；kSharedRead 为 true 时读操作持有 lock_shared()，
+ *                    否则读操作同样持有 lock()
+ * @tparam Capacity 每个节点最多保存的键数，默认让键数组正好占满一条 64 字节缓存行(int 为 16，int64_t 为 8)
+ *
+ * @note 元素会随节点分裂、合并在节点之间移动，节点内容也会被原位修改，因此读操作不能像 SkipList 那样无锁进行，
+ *       search_element_value 返回的指针只在下一次写操作之前有效。
+ */
+template <typename K, typename V, typename LockPolicy = SharedMutexLock, int Capacity = static_cast<int>(64 / sizeof(K))>
+class UnrolledSkipList
+{
+    static_assert(std::is_integral<K>::value, "UnrolledSkipList requires an integral key type");
+    static_assert(Capacity >= 8 && Capacity <= 32 && Capacity % 8 == 0,
+                  "Capacity must be a multiple of 8 in [8, 32]");
+
+public:
+    using NodeType = UnrolledNode<K, V, Capacity>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param max_level 跳表的最大层级数
+     */
+    explicit UnrolledSkipList(int max_level);
+
+    /**
+     * @brief 析构函数，释放所有节点
+     */
+    ~UnrolledSkipList();
+
+    UnrolledSkipList(const UnrolledSkipList &) = delete;
+    UnrolledSkipList &operator=(const UnrolledSkipList &) = delete;
+
+    /**
+     * @brief 插入键值对
+     *
+     * 目标节点已满时先对半分裂，新节点以随机层级链入跳表。
+     *
+     * @return 如果成功插入元素，则返回 0；如果元素已存在，则返回 1
+     */
+    int insert_element(K key, V value);
+
+    /**
+     * @brief 查找指定键是否存在
+     */
+    bool search_element(K key);
+
+    /**
+     * @brief 查找元素值
+     *
+     * @return V* 指向值的指针，不存在时返回 nullptr
+     *
+     * @note 返回的指针只在下一次写操作之前有效，分裂、合并或同一节点内的插入删除都会移动值。
+     */
+    V *search_element_value(K key);
+
+    /**
+     * @brief 修改指定键的值
+     *
+     * @return 如果键存在且值被修改，则返回 true
+     */
+    bool update_element(K key, V value);
+
+    /**
+     * @brief 删除指定键的元素
+     *
+     * 节点删空后被摘除；剩余元素少于容量的 1/4 且与后继合并后不超过容量的 3/4 时，把后继并入本节点。
+     */
+    void delete_element(K key);
+
+    /**
+     * @brief 按键递增顺序访问所有元素
+     *
+     * @tparam Callback 可调用对象，形如 void(const K &key, const V &value)
+     * @return size_t 访问的元素个数
+     *
+     * @note 遍历期间持有读锁，回调内不能对同一跳表执行写操作。
+     */
+    template<typename Callback>
+    size_t for_each(Callback callback);
+
+    /**
+     * @brief 打印每一层的节点，节点以 [最小键..最大键](元素个数) 表示
+     */
+    void display_list();
+
+    /**
+     * @brief 返回跳表中元素的数量
+     */
+    int size();
+
+    /**
+     * @brief 返回胖节点的数量，可以与 size() 一起估计节点的平均填充率
+     */
+    int node_count();
+
+    /**
+     * @brief 清空跳表
+     */
+    void clear();
+
+private:
+    //  读操作的加锁方式由锁策略决定
+    class ReadLock
+    {
+    public:
+        explicit ReadLock(LockPolicy &lock) : _lock(lock)
+        {
+            if constexpr (LockPolicy::kSharedRead)
+            {
+                _lock.lock_shared();
+            }
+            else
+            {
+                _lock.lock();
+            }
+        }
+
+        ~ReadLock()
+        {
+            if constexpr (LockPolicy::kSharedRead)
+            {
+                _lock.unlock_shared();
+            }
+            else
+            {
+                _lock.unlock();
+            }
+        }
+
+        ReadLock(const ReadLock &) = delete;
+        ReadLock &operator=(const ReadLock &) = delete;
+
+    private:
+        LockPolicy &_lock;
+    };
+
+    // 分配并构造一个胖节点
+    NodeType *create_node(int level);
+
+    // 析构节点中的值并释放节点
+    void destroy_node(NodeType *node);
+
+    // 沿各层找到最后一个最小键不大于 key 的节点；update 不为空时记录每一层停下的位置
+    NodeType *find_floor(K key, NodeType **update);
+
+    // 在键可能所在的节点中查找 key，找到时返回节点并通过 pos 给出位置，否则返回 nullptr
+    NodeType *find_key(K key, int &pos);
+
+    // 将已填好键的新节点链入各层
+    void link_node(NodeType *node, NodeType **update);
+
+    // 将节点从各层摘除，按 keys[0] 定位前驱
+    void unlink_node(NodeType *node);
+
+    // 释放所有元素节点
+    void free_nodes();
+
+    int _max_level;             // 跳表的最大层级数
+    int _skip_list_level;       // 跳表当前的层级数
+    NodeType *_header;          // 头节点，不保存元素
+    int _element_count;         // 元素数量
+    int _node_count;            // 胖节点数量
+    LockPolicy _lock;           // 读写锁策略
+    LevelGenerator _level_generator;    // 新节点的随机层级
+};
+
+template<typename K, typename V, typename LockPolicy, int Capacity>
+UnrolledSkipList<K, V, LockPolicy, Capacity>::UnrolledSkipList(int max_level)
+    : _max_level(max_level), _skip_list_level(0), _element_count(0), _node_count(0),
+      _level_generator(max_level)
+{
+    _header = create_node(_max_level);
+    _node_count = 0;    //  头节点不计入
+}
+
+template<typename K, typename V, typename LockPolicy, int Capacity>
+UnrolledSkipList<K, V, LockPolicy, Capacity>::~UnrolledSkipList()
+{
+    LOG_INFO << "Destroying unrolled skiplist";
+    free_nodes();
+    destroy_node(_header);
+}
+
+// 插入键值对，目标节点已满时先分裂
+template<typename K, typename V, typename LockPolicy, int Capacity>
+int UnrolledSkipList<K, V, LockPolicy, Capacity>::insert_element(K key, V value)
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    NodeType *update[_max_level + 1];
+    NodeType *target = find_floor(key, update);
+
+    if (target == _header)
+    {
+        //  key 小于所有元素：放入第一个节点的开头；跳表为空时新建节点
+        target = _header->forward[0];
+        if (target == nullptr)
+        {
+            NodeType *node = create_node(_level_generator.generate());
+            node->insert_at(0, key, std::move(value));
+            link_node(node, update);
+            _element_count++;
+            return 0;
+        }
+    }
+
+    int pos = unrolled_detail::lower_bound_keys<K, Capacity>(target->keys, target->count, key);
+    if (pos < target->count && target->keys[pos] == key)
+    {
+        return 1;   //  元素已在跳表中
+    }
+
+    if (target->count == Capacity)
+    {
+        //  对半分裂：后一半移入新节点，新节点的最小键大于前一半的所有键
+        NodeType *sibling = create_node(_level_generator.generate());
+        target->move_to(Capacity / 2, sibling);
+        link_node(sibling, update);
+        if (pos > target->count)
+        {
+            pos -= target->count;
+            target = sibling;
+        }
+    }
+
+    target->insert_at(pos, key, std::move(value));
+    _element_count++;
+    return 0;
+}
+
+// 查找指定键是否存在
+template<typename K, typename V, typename LockPolicy, int Capacity>
+bool UnrolledSkipList<K, V, LockPolicy, Capacity>::search_element(K key)
+{
+    ReadLock lock(_lock);
+    int pos;
+    return find_key(key, pos) != nullptr;
+}
+
+// 查找元素值
+template<typename K, typename V, typename LockPolicy, int Capacity>
+V *UnrolledSkipList<K, V, LockPolicy, Capacity>::search_element_value(K key)
+{
+    ReadLock lock(_lock);
+    int pos;
+    NodeType *node = find_key(key, pos);
+    return node != nullptr ? &node->value(pos) : nullptr;
+}
+
+// 修改指定键的值
+template<typename K, typename V, typename LockPolicy, int Capacity>
+bool UnrolledSkipList<K, V, LockPolicy, Capacity>::update_element(K key, V value)
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    int pos;
+    NodeType *node = find_key(key, pos);
+    if (node == nullptr)
+    {
+        return false;
+    }
+    node->value(pos) = std::move(value);
+    return true;
+}
+
+// 删除指定键的元素，必要时摘除或合并节点
+template<typename K, typename V, typename LockPolicy, int Capacity>
+void UnrolledSkipList<K, V, LockPolicy, Capacity>::delete_element(K key)
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    int pos;
+    NodeType *node = find_key(key, pos);
+    if (node == nullptr)
+    {
+        return;
+    }
+
+    node->erase_at(pos);
+    _element_count--;
+
+    if (node->count == 0)
+    {
+        unlink_node(node);
+        destroy_node(node);
+        return;
+    }
+
+    //  节点过空时把后继并入本节点，合并后仍留出 1/4 的空位给后续插入
+    NodeType *next = node->forward[0];
+    if (node->count < Capacity / 4 && next != nullptr && node->count + next->count <= Capacity * 3 / 4)
+    {
+        unlink_node(next);      //  先按 next 的最小键摘除，再搬走它的元素
+        next->move_to(0, node);
+        destroy_node(next);
+    }
+}
+
+// 按键递增顺序访问所有元素
+template<typename K, typename V, typename LockPolicy, int Capacity>
+template<typename Callback>
+size_t UnrolledSkipList<K, V, LockPolicy, Capacity>::for_each(Callback callback)
+{
+    ReadLock lock(_lock);
+    size_t visited = 0;
+    for (NodeType *node = _header->forward[0]; node != nullptr; node = node->forward[0])
+    {
+        for (int i = 0; i < node->count; i++)
+        {
+            callback(static_cast<const K &>(node->keys[i]), static_cast<const V &>(node->value(i)));
+        }
+        visited += node->count;
+    }
+    return visited;
+}
+
+// 打印每一层的节点
+template<typename K, typename V, typename LockPolicy, int Capacity>
+void UnrolledSkipList<K, V, LockPolicy, Capacity>::display_list()
+{
+    LOG_INFO << "Beginning display of UnrolledSkipList.";
+    ReadLock lock(_lock);
+    std::cout << "***** Unrolled Skip List *****" << std::endl;
+    for (int level = _skip_list_level; level >= 0; --level)
+    {
+        std::ostringstream oss;
+        oss << "Level " << level << ": ";
+        for (NodeType *node = _header->forward[level]; node != nullptr; node = node->forward[level])
+        {
+            oss << "|[" << node->keys[0] << ".." << node->keys[node->count - 1] << "](" << node->count << ") ";
+        }
+        oss << "|";
+        std::cout << oss.str() << std::endl;
+    }
+}
+
+// 返回元素数量
+template<typename K, typename V, typename LockPolicy, int Capacity>
+int UnrolledSkipList<K, V, LockPolicy, Capacity>::size()
+{
+    ReadLock lock(_lock);
+    return _element_count;
+}
+
+// 返回胖节点数量
+template<typename K, typename V, typename LockPolicy, int Capacity>
+int UnrolledSkipList<K, V, LockPolicy, Capacity>::node_count()
+{
+    ReadLock lock(_lock);
+    return _node_count;
+}
+
+// 清空跳表
+template<typename K, typename V, typename LockPolicy, int Capacity>
+void UnrolledSkipList<K, V, LockPolicy, Capacity>::clear()
+{
+    std::lock_guard<LockPolicy> lock(_lock);
+    free_nodes();
+    for (int i = 0; i <= _max_level; i++)
+    {
+        _header->forward[i] = nullptr;
+    }
+    _skip_list_level = 0;
+    _element_count = 0;
+    _node_count = 0;
+}
+
+// 分配并构造一个胖节点
+template<typename K, typename V, typename LockPolicy, int Capacity>
+typename UnrolledSkipList<K, V, LockPolicy, Capacity>::NodeType *UnrolledSkipList<K, V, LockPolicy, Capacity>::create_node(int level)
+{
+    void *memory = ::operator new(NodeType::storage_size(level), std::align_val_t(alignof(NodeType)));
+    _node_count++;
+    return new (memory) NodeType(level);
+}
+
+// 析构节点中的值并释放节点
+template<typename K, typename V, typename LockPolicy, int Capacity>
+void UnrolledSkipList<K, V, LockPolicy, Capacity>::destroy_node(NodeType *node)
+{
+    for (int i = 0; i < node->count; i++)
+    {
+        node->value(i).~V();
+    }
+    node->~NodeType();
+    ::operator delete(node, std::align_val_t(alignof(NodeType)));
+    _node_count--;
+}
+
+// 沿各层找到最后一个最小键不大于 key 的节点
+template<typename K, typename V, typename LockPolicy, int Capacity>
+typename UnrolledSkipList<K, V, LockPolicy, Capacity>::NodeType *UnrolledSkipList<K, V, LockPolicy, Capacity>::find_floor(K key, NodeType **update)
+{
+    NodeType *current = _header;
+    for (int i = _skip_list_level; i >= 0; i--)
+    {
+        NodeType *next = current->forward[i];
+        while (next != nullptr && !(key < next->keys[0]))
+        {
+            current = next;
+            next = current->forward[i];
+        }
+        if (update != nullptr)
+        {
+            update[i] = current;
+        }
+    }
+    return current;
+}
+
+// 在键可能所在的节点中查找 key
+template<typename K, typename V, typename LockPolicy, int Capacity>
+typename UnrolledSkipList<K, V, LockPolicy, Capacity>::NodeType *UnrolledSkipList<K, V, LockPolicy, Capacity>::find_key(K key, int &pos)
+{
+    NodeType *node = find_floor(key, nullptr);
+    if (node == _header)
+    {
+        return nullptr;     //  key 小于所有元素
+    }
+    pos = unrolled_detail::lower_bound_keys<K, Capacity>(node->keys, node->count, key);
+    return pos < node->count && node->keys[pos] == key ? node : nullptr;
+}
+
+// 将已填好键的新节点链入各层
+template<typename K, typename V, typename LockPolicy, int Capacity>
+void UnrolledSkipList<K, V, LockPolicy, Capacity>::link_node(NodeType *node, NodeType **update)
+{
+    if (node->node_level > _skip_list_level)
+    {
+        for (int i = _skip_list_level + 1; i <= node->node_level; i++)
+        {
+            update[i] = _header;
+        }
+        _skip_list_level = node->node_level;
+    }
+
+    for (int i = 0; i <= node->node_level; i++)
+    {
+        //  update[i] 是按插入键找到的位置；分裂出的节点最小键可能更大，最多再向右走过被分裂的节点
+        NodeType *prev = update[i];
+        while (prev->forward[i] != nullptr && prev->forward[i]->keys[0] < node->keys[0])
+        {
+            prev = prev->forward[i];
+        }
+        node->forward[i] = prev->forward[i];
+        prev->forward[i] = node;
+    }
+}
+
+// 将节点从各层摘除
+template<typename K, typename V, typename LockPolicy, int Capacity>
+void UnrolledSkipList<K, V, LockPolicy, Capacity>::unlink_node(NodeType *node)
+{
+    NodeType *current = _header;
+    for (int i = _skip_list_level; i >= 0; i--)
+    {
+        NodeType *next = current->forward[i];
+        while (next != nullptr && next != node && next->keys[0] < node->keys[0])
+        {
+            current = next;
+            next = current->forward[i];
+        }
+        if (next == node)
+        {
+            current->forward[i] = node->forward[i];
+        }
+    }
+
+    //  删除后如果最高层没有节点，降低跳表层级
+    while (_skip_list_level > 0 && _header->forward[_skip_list_level] == nullptr)
+    {
+        _skip_list_level--;
+    }
+}
+
+// 释放所有元素节点
+template<typename K, typename V, typename LockPolicy, int Capacity>
+void UnrolledSkipList<K, V, LockPolicy, Capacity>::free_nodes()
+{
+    NodeType *node = _header->forward[0];
+    while (node != nullptr)
+    {
+        NodeType *next = node->forward[0];
+        destroy_node(node);
+        node = next;
+    }
+}
+
+#endif // KVENGINE_UNROLLED_SKIPLIST_H
@@ -0,0 +1,731 @@
+#ifndef KVENGINE_WAL_H
+#define KVENGINE_WAL_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "logMod.h"
+#include "snapshot.h"
+
+/**
+ * @file wal.h
+ * @brief 预写日志(WAL)。
+ *
+ * 跳表的每个写操作在写锁内追加一条日志记录到内存缓冲区，释放写锁后再按同步策略落盘。
+ * 日志按段(segment)存放，文件名为 <path>.<序号>，每次 open() 或 rotate() 都开启一个新段。
+ *
+ * 记录格式：[u32 正文长度][u64 正文的 FNV-1a 哈希][正文]
+ * 正文格式：[u8 操作类型][键字段][值字段]，字段编码与快照相同；删除只有键字段，清空没有字段，
+ * 区间删除是 [起始键字段][结束键字段]。
+ *
+ * 检查点流程：rotate() 开启新段 -> 保存快照 -> remove_segments_before(新段序号)。
+ * 恢复流程：加载快照 -> 按序重放剩余的段。日志只记录实际生效的操作，
+ * 从"模糊"快照(保存期间仍有写入)开始重放也会收敛到崩溃前的状态。
+ *
+ * 写出或 fsync 失败后日志进入失败状态：写了一半的记录被截断回上一次完整写出的位置，
+ * 之后的 append() 被拒绝，commit()/flush()/rotate() 都返回失败，直到 close() 后重新 open()。
+ */
+
+/**
+ * @brief 日志记录的操作类型
+ */
+enum class WalOp : uint8_t
+{
+    Insert = 1,     // 插入(键不存在时)
+    Update = 2,     // 修改已存在键的值
+    Delete = 3,     // 删除
+    Clear = 4,      // 清空
+    DeleteRange = 5 // 删除闭区间 [键, 结束键] 内的所有元素
+};
+
+/**
+ * @brief 日志落盘策略
+ */
+enum class WalSyncPolicy
+{
+    EveryWrite,     // 写操作返回前 fsync，并发写者合并为一次 fsync(组提交)
+    Interval,       // 后台线程每隔固定时间写出并 fsync，写操作不等待，崩溃时最多丢失一个间隔的数据
+    OsManaged       // 写操作返回前写入操作系统缓存但不 fsync，进程崩溃不丢数据，断电可能丢失
+};
+
+/**
+ * @brief 只追加写入的日志文件
+ */
+class WalFile
+{
+public:
+    WalFile() = default;
+    WalFile(const WalFile &) = delete;
+    WalFile &operator=(const WalFile &) = delete;
+
+    ~WalFile()
+    {
+        close();
+    }
+
+    bool open(const std::string &path)
+    {
+        close();
+#ifdef _WIN32
+        //  截断需要 GENERIC_WRITE，写入位置始终保持在文件末尾
+        _handle = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER end;
+        if (_handle == INVALID_HANDLE_VALUE || !SetFilePointerEx(_handle, LARGE_INTEGER{}, &end, FILE_END))
+        {
+            close();
+            return false;
+        }
+        _size = static_cast<uint64_t>(end.QuadPart);
+        return true;
+#else
+        _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        off_t end = _fd >= 0 ? ::lseek(_fd, 0, SEEK_END) : -1;
+        if (end < 0)
+        {
+            close();
+            return false;
+        }
+        _size = static_cast<uint64_t>(end);
+        return true;
+#endif
+    }
+
+    //  失败时可能已写出一部分，_size 只计入实际写出的字节
+    bool write(const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+#ifdef _WIN32
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+            DWORD written = 0;
+            if (!WriteFile(_handle, data, chunk, &written, nullptr))
+            {
+                return false;
+            }
+#else
+            ssize_t written = ::write(_fd, data, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+#endif
+            data += written;
+            size -= static_cast<size_t>(written);
+            _size += static_cast<uint64_t>(written);
+        }
+        return true;
+    }
+
+    //  把文件截断到 size 字节，用于丢弃写了一半的记录
+    bool truncate(uint64_t size)
+    {
+#ifdef _WIN32
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(size);
+        if (!SetFilePointerEx(_handle, offset, nullptr, FILE_BEGIN) || !SetEndOfFile(_handle))
+        {
+            return false;
+        }
+#else
+        if (::ftruncate(_fd, static_cast<off_t>(size)) != 0)
+        {
+            return false;   //  O_APPEND 下之后的写入仍追加在实际的文件末尾
+        }
+#endif
+        _size = size;
+        return true;
+    }
+
+    //  当前文件大小(字节)
+    uint64_t size() const
+    {
+        return _size;
+    }
+
+    bool sync()
+    {
+#ifdef _WIN32
+        return FlushFileBuffers(_handle) != 0;
+#elif defined(__linux__)
+        return fdatasync(_fd) == 0;
+#else
+        return fsync(_fd) == 0;
+#endif
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (_handle != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(_handle);
+            _handle = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (_fd >= 0)
+        {
+            ::close(_fd);
+            _fd = -1;
+        }
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE _handle = INVALID_HANDLE_VALUE;
+#else
+    int _fd = -1;
+#endif
+    uint64_t _size = 0;     // 已写出的字节数
+};
+
+/**
+ * @brief 跳表预写日志
+ *
+ * @tparam K 键的类型
+ * @tparam V 值的类型
+ *
+ * @note
+ * - append() 只编码到内存缓冲区并分配日志序号(LSN)，应在跳表写锁内调用，保证日志顺序与生效顺序一致。
+ * - commit() 按同步策略等待落盘，应在释放写锁之后调用，等待期间其他写者可以继续追加，
+ *   由第一个等待者(leader)把所有已追加的记录一次写出并 fsync。
+ * - 写出或 fsync 失败是粘滞的：日志序号不再前进，缓冲区中尚未写出的记录被丢弃，
+ *   之后的 append() 返回 0，commit() 返回 false，可以用 failed() 查询。
+ */
+template<typename K, typename V>
+class WriteAheadLog
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param path 日志路径前缀，段文件为 <path>.<序号>
+     * @param policy 落盘策略
+     * @param interval_ms Interval 策略下的落盘间隔(毫秒)
+     */
+    explicit WriteAheadLog(const std::string &path, WalSyncPolicy policy = WalSyncPolicy::Interval,
+                           unsigned int interval_ms = 100)
+        : _path(path), _policy(policy), _interval_ms(interval_ms)
+    {
+    }
+
+    ~WriteAheadLog()
+    {
+        close();
+    }
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    /**
+     * @brief 开启一个新段开始记录
+     *
+     * 已有段保持不变，应在 replay() 之后调用。崩溃时残缺的段尾不会被继续追加。
+     *
+     * @return bool 成功返回 true
+     */
+    bool open()
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        auto segments = list_segments();
+        uint64_t next = segments.empty() ? 1 : segments.back().first + 1;
+        if (!_file.open(segment_path(next)))
+        {
+            LOG_ERROR << "Error: Cannot open WAL segment " << segment_path(next);
+            return false;
+        }
+        _segment = next;
+        _failed = false;
+        if (_policy == WalSyncPolicy::Interval && !_sync_thread.joinable())
+        {
+            _stop = false;
+            _sync_thread = std::thread(&WriteAheadLog::sync_loop, this);
+        }
+        LOG_INFO << "WAL opened at segment " << segment_path(next);
+        return true;
+    }
+
+    /**
+     * @brief 写出所有缓冲的记录并关闭日志
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _stop = true;
+        }
+        _stop_cv.notify_all();
+        if (_sync_thread.joinable())
+        {
+            _sync_thread.join();
+        }
+        if (_segment != 0)
+        {
+            flush(true);
+            std::lock_guard<std::mutex> lock(_mtx);
+            _file.close();
+            _segment = 0;
+        }
+    }
+
+    /**
+     * @brief 追加一条记录到内存缓冲区
+     *
+     * @param op 操作类型
+     * @param key 键，Clear 时为 nullptr
+     * @param value 值，Delete/Clear/DeleteRange 时为 nullptr
+     * @param end_key 区间删除的结束键(包含)，其他操作为 nullptr
+     * @return uint64_t 记录的日志序号，用于 commit()；日志已失败时拒绝追加，返回 0
+     */
+    uint64_t append(WalOp op, const K *key, const V *value, const K *end_key = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        if (_failed)
+        {
+            return 0;
+        }
+        size_t start = _buffer.size();
+        _buffer.append(sizeof(uint32_t) + sizeof(uint64_t), '\0');  //  记录头占位
+        _buffer.push_back(static_cast<char>(op));
+        if (key != nullptr)
+        {
+            append_snapshot_field(*key, _buffer);
+        }
+        if (value != nullptr)
+        {
+            append_snapshot_field(*value, _buffer);
+        }
+        if (end_key != nullptr)
+        {
+            append_snapshot_field(*end_key, _buffer);
+        }
+
+        const char *body = _buffer.data() + start + sizeof(uint32_t) + sizeof(uint64_t);
+        uint32_t body_length = static_cast<uint32_t>(_buffer.size() - start - sizeof(uint32_t) - sizeof(uint64_t));
+        uint64_t checksum = fnv1a64(body, body_length);
+        std::memcpy(&_buffer[start], &body_length, sizeof(body_length));
+        std::memcpy(&_buffer[start + sizeof(uint32_t)], &checksum, sizeof(checksum));
+        return ++_next_lsn;
+    }
+
+    /**
+     * @brief 按落盘策略等待日志序号 lsn 之前的记录持久化
+     *
+     * @return bool 日志已失败(包括 append() 被拒绝、lsn 为 0)时返回 false；
+     *         Interval 策略不等待，只反映此刻日志是否已失败
+     */
+    bool commit(uint64_t lsn)
+    {
+        if (lsn == 0)
+        {
+            return false;
+        }
+        switch (_policy)
+        {
+            case WalSyncPolicy::EveryWrite:
+                return sync_to(lsn, true);
+            case WalSyncPolicy::OsManaged:
+                return sync_to(lsn, false);
+            case WalSyncPolicy::Interval:
+                break;  //  由后台线程落盘
+        }
+        return !failed();
+    }
+
+    /**
+     * @brief 立即写出所有缓冲的记录
+     *
+     * @param sync 为 true 时同时 fsync
+     * @return bool 写出(及 fsync)失败或日志已失败时返回 false
+     */
+    bool flush(bool sync)
+    {
+        uint64_t lsn;
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            lsn = _next_lsn;
+        }
+        return sync_to(lsn, sync);
+    }
+
+    /**
+     * @brief 日志是否处于失败状态
+     */
+    bool failed()
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _failed;
+    }
+
+    /**
+     * @brief 结束当前段并开启下一个段，用于检查点
+     *
+     * 调用前追加的记录全部写入旧段并 fsync；之后追加的记录进入新段。
+     *
+     * @return uint64_t 新段的序号；日志已失败、旧段写出失败或新段无法打开时返回 0
+     */
+    uint64_t rotate()
+    {
+        std::unique_lock<std::mutex> lock(_mtx);
+        _cv.wait(lock, [this] { return !_flushing; });
+        if (_segment == 0 || _failed)
+        {
+            return 0;
+        }
+        _flushing = true;   //  持有写出权，期间没有其他线程访问 _file
+        uint64_t target = _next_lsn;
+        _flush_buffer.swap(_buffer);
+        lock.unlock();
+
+        bool written = write_out(true);
+
+        lock.lock();
+        if (!written)
+        {
+            fail();
+            return 0;
+        }
+        _written_lsn = _synced_lsn = target;
+        uint64_t next = _segment + 1;
+        if (_file.open(segment_path(next)))
+        {
+            _segment = next;
+        }
+        else
+        {
+            LOG_ERROR << "Error: Cannot open WAL segment " << segment_path(next);
+            next = 0;
+        }
+        _flushing = false;
+        _cv.notify_all();
+        return next;
+    }
+
+    /**
+     * @brief 删除序号小于 segment 的所有段(这些段的内容已包含在快照中)
+     */
+    void remove_segments_before(uint64_t segment)
+    {
+        for (auto &entry : list_segments())
+        {
+            if (entry.first < segment)
+            {
+                std::remove(entry.second.c_str());
+            }
+        }
+    }
+
+    /**
+     * @brief 按顺序重放所有已存在的段(不包括当前正在写入的段)
+     *
+     * 每个段遇到残缺或校验失败的记录时停止，继续重放下一个段(崩溃时只有段尾可能残缺)。
+     *
+     * @tparam Apply 可调用对象，形如 void(WalOp op, const K &key, const V &value, const K &end_key)，
+     *               end_key 只对 DeleteRange 有意义
+     * @return size_t 重放的记录条数
+     */
+    template<typename Apply>
+    size_t replay(Apply apply)
+    {
+        size_t replayed = 0;
+        for (auto &entry : list_segments())
+        {
+            if (entry.first == _segment)
+            {
+                continue;
+            }
+            MappedFile file;
+            if (!file.open(entry.second))
+            {
+                continue;   //  空段
+            }
+            const char *cursor = file.data();
+            const char *end = cursor + file.size();
+            while (cursor != end)
+            {
+                uint32_t body_length;
+                uint64_t checksum;
+                if (static_cast<size_t>(end - cursor) < sizeof(body_length) + sizeof(checksum))
+                {
+                    LOG_WARN << "WAL segment " << entry.second << " has a truncated record header, stop replaying it.";
+                    break;
+                }
+                std::memcpy(&body_length, cursor, sizeof(body_length));
+                std::memcpy(&checksum, cursor + sizeof(body_length), sizeof(checksum));
+                const char *body = cursor + sizeof(body_length) + sizeof(checksum);
+                if (static_cast<size_t>(end - body) < body_length || body_length == 0
+                    || fnv1a64(body, body_length) != checksum)
+                {
+                    LOG_WARN << "WAL segment " << entry.second << " has a torn or corrupt record, stop replaying it.";
+                    break;
+                }
+
+                const char *field = body + 1;
+                const char *body_end = body + body_length;
+                WalOp op = static_cast<WalOp>(*body);
+                K key{};
+                V value{};
+                K end_key{};
+                bool ok = true;
+                if (op != WalOp::Clear)
+                {
+                    ok = read_snapshot_field(field, body_end, key);
+                }
+                if (ok && (op == WalOp::Insert || op == WalOp::Update))
+                {
+                    ok = read_snapshot_field(field, body_end, value);
+                }
+                if (ok && op == WalOp::DeleteRange)
+                {
+                    ok = read_snapshot_field(field, body_end, end_key);
+                }
+                if (!ok)
+                {
+                    LOG_WARN << "WAL segment " << entry.second << " has a malformed record, stop replaying it.";
+                    break;
+                }
+                apply(op, key, value, end_key);
+                replayed++;
+                cursor = body_end;
+            }
+        }
+        LOG_INFO << "Replayed " << replayed << " WAL records.";
+        return replayed;
+    }
+
+    /**
+     * @brief 落盘策略
+     */
+    WalSyncPolicy policy() const
+    {
+        return _policy;
+    }
+
+private:
+    //  按序号升序列出所有段文件
+    std::vector<std::pair<uint64_t, std::string>> list_segments() const
+    {
+        std::vector<std::pair<uint64_t, std::string>> segments;
+        std::filesystem::path base(_path);
+        std::filesystem::path dir = base.parent_path().empty() ? std::filesystem::path(".") : base.parent_path();
+        std::string prefix = base.filename().string() + ".";
+        std::error_code ec;
+        for (auto &entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            std::string name = entry.path().filename().string();
+            if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0)
+            {
+                continue;
+            }
+            std::string suffix = name.substr(prefix.size());
+            if (suffix.find_first_not_of("0123456789") != std::string::npos)
+            {
+                continue;
+            }
+            segments.emplace_back(std::stoull(suffix), entry.path().string());
+        }
+        std::sort(segments.begin(), segments.end());
+        return segments;
+    }
+
+    std::string segment_path(uint64_t segment) const
+    {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".%06llu", static_cast<unsigned long long>(segment));
+        return _path + suffix;
+    }
+
+    //  组提交：第一个发现记录未落盘的线程成为 leader，把缓冲区整体换出后在锁外写出，
+    //  其余线程等待 leader 完成；leader 写出期间追加的记录由下一个 leader 一并处理。
+    //  写出失败时日志序号不前进，所有等待者返回 false
+    bool sync_to(uint64_t lsn, bool need_sync)
+    {
+        std::unique_lock<std::mutex> lock(_mtx);
+        while ((need_sync ? _synced_lsn : _written_lsn) < lsn)
+        {
+            if (_failed)
+            {
+                return false;
+            }
+            if (_flushing)
+            {
+                _cv.wait(lock);
+                continue;
+            }
+            _flushing = true;
+            uint64_t target = _next_lsn;
+            _flush_buffer.swap(_buffer);
+            lock.unlock();
+
+            bool written = write_out(need_sync);
+
+            lock.lock();
+            if (!written)
+            {
+                fail();
+                return false;
+            }
+            _written_lsn = target;
+            if (need_sync)
+            {
+                _synced_lsn = target;
+            }
+            _flushing = false;
+            _cv.notify_all();
+        }
+        return true;
+    }
+
+    //  写出 _flush_buffer，只由持有写出权的线程调用。写出失败时截断回写出前的位置，段尾不留下残缺的记录
+    bool write_out(bool need_sync)
+    {
+        bool ok = true;
+        uint64_t good_size = _file.size();
+        if (!_flush_buffer.empty() && !_file.write(_flush_buffer.data(), _flush_buffer.size()))
+        {
+            LOG_ERROR << "Error: Failed to write WAL segment " << segment_path(_segment);
+            std::cerr << "Error: Failed to write WAL segment " << segment_path(_segment) << std::endl;
+            if (!_file.truncate(good_size))
+            {
+                LOG_ERROR << "Error: Cannot truncate WAL segment " << segment_path(_segment) << " to " << good_size << " bytes.";
+            }
+            ok = false;
+        }
+        if (ok && need_sync && !_file.sync())
+        {
+            //  fsync 失败后无法确认哪些页已落盘，记录本身完整，不截断
+            LOG_ERROR << "Error: Failed to sync WAL segment " << segment_path(_segment);
+            std::cerr << "Error: Failed to sync WAL segment " << segment_path(_segment) << std::endl;
+            ok = false;
+        }
+        _flush_buffer.clear();
+        return ok;
+    }
+
+    //  进入失败状态并释放写出权，持有 _mtx 时调用；尚未写出的记录不会再被写出，直接丢弃
+    void fail()
+    {
+        _failed = true;
+        _buffer.clear();
+        _flushing = false;
+        _cv.notify_all();
+    }
+
+    //  Interval 策略的后台落盘线程
+    void sync_loop()
+    {
+        std::unique_lock<std::mutex> lock(_mtx);
+        while (!_stop)
+        {
+            _stop_cv.wait_for(lock, std::chrono::milliseconds(_interval_ms), [this] { return _stop; });
+            if (_failed)
+            {
+                continue;   //  失败后不再写出，等待 close()
+            }
+            uint64_t lsn = _next_lsn;
+            lock.unlock();
+            sync_to(lsn, true);
+            lock.lock();
+        }
+    }
+
+    const std::string _path;            // 日志路径前缀
+    const WalSyncPolicy _policy;        // 落盘策略
+    const unsigned int _interval_ms;    // Interval 策略的落盘间隔
+
+    std::mutex _mtx;                    // 保护以下所有状态
+    std::condition_variable _cv;        // leader 写出完成通知
+    std::condition_variable _stop_cv;   // 后台线程停止通知
+    WalFile _file;                      // 当前段
+    uint64_t _segment = 0;              // 当前段序号，0 表示未打开
+    std::string _buffer;                // 待写出的记录
+    std::string _flush_buffer;          // leader 正在写出的记录
+    uint64_t _next_lsn = 0;             // 最后分配的日志序号
+    uint64_t _written_lsn = 0;          // 已写入操作系统的日志序号
+    uint64_t _synced_lsn = 0;           // 已 fsync 的日志序号
+    bool _flushing = false;             // 是否有 leader 正在写出
+    bool _failed = false;               // 写出或 fsync 是否失败过，失败后拒绝追加
+    bool _stop = false;                 // 是否停止后台线程
+    std::thread _sync_thread;           // Interval 策略的后台线程
+};
+
+/**
+ * @brief 写操作的日志记录没有按落盘策略持久化
+ *
+ * 抛出时修改已经在内存中生效，但日志拒绝了这条记录或没能把它写出、落盘，崩溃恢复会丢失这次修改。
+ * 日志失败是永久的，之后的写操作同样抛出，直到挂接新的日志。
+ */
+class WalCommitError : public std::runtime_error
+{
+public:
+    explicit WalCommitError(uint64_t lsn)
+        : std::runtime_error(lsn == 0 ? "write-ahead log rejected the record"
+                                      : "write-ahead log failed to persist record " + std::to_string(lsn)),
+          _lsn(lsn)
+    {
+    }
+
+    /**
+     * @brief 未能持久化的日志序号，日志拒绝追加时为 0
+     */
+    uint64_t lsn() const
+    {
+        return _lsn;
+    }
+
+private:
+    uint64_t _lsn;
+};
+
+/**
+ * @brief 写操作在写锁内取得的日志凭据，释放写锁后通过 commit() 等待落盘
+ */
+template<typename K, typename V>
+struct WalTicket
+{
+    WriteAheadLog<K, V> *wal = nullptr;     // 记录所在的日志，未挂接日志时为空
+    uint64_t lsn = 0;                       // 日志序号，日志拒绝追加时为 0
+
+    //  未挂接日志时返回 true；否则返回记录是否按落盘策略持久化
+    bool commit() const
+    {
+        return wal == nullptr || wal->commit(lsn);
+    }
+
+    //  与 commit() 相同，但记录没有持久化时抛出 WalCommitError，写操作以此把日志失败交给调用者
+    void commit_or_throw() const
+    {
+        if (!commit())
+        {
+            throw WalCommitError(lsn);
+        }
+    }
+};
+
+#endif // KVENGINE_WAL_H